@@ -5,6 +5,10 @@ namespace SimpleRtspPlayer.GUI
 {
     public interface IVideoSource
     {
+        /// <summary>
+        /// Every frame has a single owner, the handler, which has to dispose it. Frames are held by the decoder
+        /// until then, so only one handler should be attached, frames are disposed by the source without handlers
+        /// </summary>
         event EventHandler<IDecodedVideoFrame> FrameReceived;
     }
 }
\ No newline at end of file
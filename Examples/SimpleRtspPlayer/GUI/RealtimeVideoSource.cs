@@ -1,7 +1,9 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Threading;
 using RtspClientSharp.RawFrames;
 using RtspClientSharp.RawFrames.Video;
+using SimpleRtspPlayer.RawFramesDecoding;
 using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
 using SimpleRtspPlayer.RawFramesDecoding.FFmpeg;
 using SimpleRtspPlayer.RawFramesReceiving;
@@ -15,8 +17,15 @@ namespace SimpleRtspPlayer.GUI
         private readonly Dictionary<FFmpegVideoCodecId, FFmpegVideoDecoder> _videoDecodersMap =
             new Dictionary<FFmpegVideoCodecId, FFmpegVideoDecoder>();
 
+        private long _framesInUseDropsCount;
+
         public event EventHandler<IDecodedVideoFrame> FrameReceived;
 
+        /// <summary>
+        /// Decoded frames dropped because frames passed before were not disposed yet
+        /// </summary>
+        public long FramesInUseDropsCount => Interlocked.Read(ref _framesInUseDropsCount);
+
         public void SetRawFramesSource(IRawFramesSource rawFramesSource)
         {
             if (_rawFramesSource != null)
@@ -53,10 +62,20 @@ namespace SimpleRtspPlayer.GUI
 
             FFmpegVideoDecoder decoder = GetDecoderForFrame(rawVideoFrame);
 
-            IDecodedVideoFrame decodedFrame = decoder.TryDecode(rawVideoFrame);
+            VideoDecodeResult result = decoder.TryDecode(rawVideoFrame, out IDecodedVideoFrame decodedFrame);
+
+            if (result == VideoDecodeResult.AllFramesInUse)
+                Interlocked.Increment(ref _framesInUseDropsCount);
+
+            if (decodedFrame == null)
+                return;
+
+            EventHandler<IDecodedVideoFrame> handler = FrameReceived;
 
-            if (decodedFrame != null)
-                FrameReceived?.Invoke(this, decodedFrame);
+            if (handler != null)
+                handler(this, decodedFrame);
+            else
+                decodedFrame.Dispose();
         }
 
         private FFmpegVideoDecoder GetDecoderForFrame(RawVideoFrame videoFrame)
@@ -76,6 +76,7 @@ namespace SimpleRtspPlayer.GUI.ViewModels
 
             connectionParameters.RtpTransport = RtpTransportProtocol.UDP;
             connectionParameters.CancelTimeout = TimeSpan.FromSeconds(1);
+            connectionParameters.ReuseRawFrames = true;
 
             _mainWindowModel.Start(connectionParameters);
             _mainWindowModel.StatusChanged += MainWindowModelOnStatusChanged;
@@ -9,6 +9,7 @@ using System.Windows.Media.Imaging;
 using System.Windows.Threading;
 using SimpleRtspPlayer.RawFramesDecoding;
 using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
+using SimpleRtspPlayer.RawFramesDecoding.FFmpeg;
 using PixelFormat = SimpleRtspPlayer.RawFramesDecoding.PixelFormat;
 
 namespace SimpleRtspPlayer.GUI.Views
@@ -28,7 +29,15 @@ namespace SimpleRtspPlayer.GUI.Views
         private int _height;
         private Int32Rect _dirtyRect;
         private TransformParameters _transformParameters;
-        private readonly Action<IDecodedVideoFrame> _invalidateAction;
+
+        // Frames are converted on the decoding thread and the newest one is copied to the bitmap once per
+        // rendered frame, so a slow dispatcher drops frames instead of queueing them
+        private readonly object _presentationLock = new object();
+        private FFmpegVideoPresentationRing _presentationRing;
+        private int _presentationStride;
+        // Frame is converted outside the lock, a ring replaced meanwhile is disposed by the decoding thread
+        private FFmpegVideoPresentationRing _writingPresentationRing;
+        private FFmpegVideoPresentationRing _retiredPresentationRing;
 
         private Task _handleSizeChangedTask = Task.CompletedTask;
         private CancellationTokenSource _resizeCancellationTokenSource = new CancellationTokenSource();
@@ -58,7 +67,9 @@ namespace SimpleRtspPlayer.GUI.Views
         public VideoView()
         {
             InitializeComponent();
-            _invalidateAction = Invalidate;
+
+            Loaded += (sender, args) => CompositionTarget.Rendering += OnRendering;
+            Unloaded += (sender, args) => CompositionTarget.Rendering -= OnRendering;
         }
 
         protected override System.Windows.Size MeasureOverride(System.Windows.Size constraint)
@@ -100,7 +111,7 @@ namespace SimpleRtspPlayer.GUI.Views
             _height = height;
             _dirtyRect = new Int32Rect(0, 0, width, height);
 
-            _transformParameters = new TransformParameters(RectangleF.Empty,
+            var transformParameters = new TransformParameters(RectangleF.Empty,
                     new System.Drawing.Size(_width, _height),
                     ScalingPolicy.Stretch, PixelFormat.Bgra32, ScalingQuality.FastBilinear);
 
@@ -127,6 +138,25 @@ namespace SimpleRtspPlayer.GUI.Views
             }
 
             VideoImage.Source = _writeableBitmap;
+
+            var presentationRing = FFmpegVideoPresentationRing.Create(_writeableBitmap.BackBufferStride * height);
+            FFmpegVideoPresentationRing previousPresentationRing;
+
+            lock (_presentationLock)
+            {
+                previousPresentationRing = _presentationRing;
+                _presentationRing = presentationRing;
+                _presentationStride = _writeableBitmap.BackBufferStride;
+                _transformParameters = transformParameters;
+
+                if (previousPresentationRing != null && previousPresentationRing == _writingPresentationRing)
+                {
+                    _retiredPresentationRing = previousPresentationRing;
+                    previousPresentationRing = null;
+                }
+            }
+
+            previousPresentationRing?.Dispose();
         }
 
         private static void OnVideoSourceChanged(DependencyObject d, DependencyPropertyChangedEventArgs e)
@@ -142,20 +172,67 @@ namespace SimpleRtspPlayer.GUI.Views
 
         private void OnFrameReceived(object sender, IDecodedVideoFrame decodedFrame)
         {
-            Application.Current.Dispatcher.Invoke(_invalidateAction, DispatcherPriority.Send, decodedFrame);
+            using (decodedFrame)
+            {
+                FFmpegVideoPresentationRing presentationRing;
+                int presentationStride;
+                TransformParameters transformParameters;
+
+                lock (_presentationLock)
+                {
+                    if (_presentationRing == null)
+                        return;
+
+                    presentationRing = _presentationRing;
+                    presentationStride = _presentationStride;
+                    transformParameters = _transformParameters;
+                    _writingPresentationRing = presentationRing;
+                }
+
+                bool isWritten = false;
+                FFmpegVideoPresentationRing retiredPresentationRing = null;
+
+                try
+                {
+                    IntPtr buffer = presentationRing.BeginWrite();
+                    decodedFrame.TransformTo(buffer, presentationStride, transformParameters);
+                    isWritten = true;
+                }
+                finally
+                {
+                    lock (_presentationLock)
+                    {
+                        _writingPresentationRing = null;
+
+                        // Frame converted for the replaced ring has the previous size, so it is dropped
+                        if (_retiredPresentationRing == presentationRing)
+                        {
+                            retiredPresentationRing = _retiredPresentationRing;
+                            _retiredPresentationRing = null;
+                        }
+                        else if (isWritten)
+                            presentationRing.EndWrite(DateTime.UtcNow);
+                    }
+
+                    retiredPresentationRing?.Dispose();
+                }
+            }
         }
 
-        private void Invalidate(IDecodedVideoFrame decodedVideoFrame)
+        private unsafe void OnRendering(object sender, EventArgs e)
         {
-            if (_width == 0 || _height == 0)
+            // Ring is replaced on this thread only, so it can't change under the copy
+            FFmpegVideoPresentationRing presentationRing = _presentationRing;
+
+            if (presentationRing == null || !presentationRing.TryAcquire(out IntPtr buffer, out _))
                 return;
 
             _writeableBitmap.Lock();
 
             try
             {
-                decodedVideoFrame.TransformTo(_writeableBitmap.BackBuffer, _writeableBitmap.BackBufferStride, _transformParameters);
-
+                Buffer.MemoryCopy((void*)buffer, (void*)_writeableBitmap.BackBuffer, presentationRing.BufferSize,
+                    presentationRing.BufferSize);
                 _writeableBitmap.AddDirtyRect(_dirtyRect);
             }
             finally
@@ -0,0 +1,36 @@
+﻿using System;
+
+namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public class AudioJitterBufferState
+    {
+        public TimeSpan BufferedDuration { get; }
+
+        /// <summary>
+        /// Latency the buffer currently keeps to cover the measured jitter
+        /// </summary>
+        public TimeSpan TargetLatency { get; }
+
+        public long UnderrunsCount { get; }
+
+        /// <summary>
+        /// Samples dropped to bring latency back to the target or because nobody pulled them
+        /// </summary>
+        public long DroppedSamplesCount { get; }
+
+        /// <summary>
+        /// Samples of frames that came after newer audio was already buffered
+        /// </summary>
+        public long LateSamplesCount { get; }
+
+        public AudioJitterBufferState(TimeSpan bufferedDuration, TimeSpan targetLatency, long underrunsCount,
+            long droppedSamplesCount, long lateSamplesCount)
+        {
+            BufferedDuration = bufferedDuration;
+            TargetLatency = targetLatency;
+            UnderrunsCount = underrunsCount;
+            DroppedSamplesCount = droppedSamplesCount;
+            LateSamplesCount = lateSamplesCount;
+        }
+    }
+}
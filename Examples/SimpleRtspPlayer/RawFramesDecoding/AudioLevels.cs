@@ -0,0 +1,27 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public class AudioLevels
+    {
+        public const int MaxChannels = 8;
+
+        /// <summary>
+        /// RMS of every channel in full scale units, 1 is the loudest level of any sample format
+        /// </summary>
+        public float[] Rms { get; } = new float[MaxChannels];
+
+        /// <summary>
+        /// Absolute peak of every channel in full scale units
+        /// </summary>
+        public float[] Peak { get; } = new float[MaxChannels];
+
+        /// <summary>
+        /// Count of channels of the frame, levels are measured for the first <see cref="MaxChannels"/> only
+        /// </summary>
+        public int Channels { get; internal set; }
+
+        /// <summary>
+        /// Audio is louder than the noise floor, stays set for the hangover time after it becomes quiet
+        /// </summary>
+        public bool IsActive { get; internal set; }
+    }
+}
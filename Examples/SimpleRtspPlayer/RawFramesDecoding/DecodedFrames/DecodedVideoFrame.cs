@@ -1,19 +1,68 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Drawing;
+using System.Threading;
 
 namespace SimpleRtspPlayer.RawFramesDecoding.DecodedFrames
 {
     class DecodedVideoFrame : IDecodedVideoFrame
     {
-        private readonly Action<IntPtr, int, TransformParameters> _transformAction;
+        private readonly Action<IntPtr, int, TransformParameters, IList<Rectangle>> _transformAction;
+        private readonly Action<IntPtr, int, TensorParameters> _tensorTransformAction;
+        private readonly Action _releaseAction;
+        private int _disposed;
 
-        public DecodedVideoFrame(Action<IntPtr, int, TransformParameters> transformAction)
+        public VideoFrameErrorFlags ErrorFlags { get; }
+
+        public DecodedVideoFrame(Action<IntPtr, int, TransformParameters, IList<Rectangle>> transformAction,
+            Action<IntPtr, int, TensorParameters> tensorTransformAction, Action releaseAction,
+            VideoFrameErrorFlags errorFlags)
         {
+            ErrorFlags = errorFlags;
             _transformAction = transformAction;
+            _tensorTransformAction = tensorTransformAction;
+            _releaseAction = releaseAction;
+        }
+
+        ~DecodedVideoFrame()
+        {
+            Dispose();
         }
 
         public void TransformTo(IntPtr buffer, int bufferStride, TransformParameters transformParameters)
         {
-            _transformAction(buffer, bufferStride, transformParameters);
+            if (_disposed != 0)
+                throw new ObjectDisposedException(nameof(DecodedVideoFrame));
+
+            _transformAction(buffer, bufferStride, transformParameters, null);
+        }
+
+        public void TransformTo(IntPtr buffer, int bufferStride, TransformParameters transformParameters,
+            IList<Rectangle> dirtyRectangles)
+        {
+            if (dirtyRectangles == null)
+                throw new ArgumentNullException(nameof(dirtyRectangles));
+            if (_disposed != 0)
+                throw new ObjectDisposedException(nameof(DecodedVideoFrame));
+
+            _transformAction(buffer, bufferStride, transformParameters, dirtyRectangles);
+        }
+
+        public void TransformToTensor(IntPtr tensorBuffer, int batchIndex, TensorParameters tensorParameters)
+        {
+            if (_disposed != 0)
+                throw new ObjectDisposedException(nameof(DecodedVideoFrame));
+
+            _tensorTransformAction(tensorBuffer, batchIndex, tensorParameters);
+        }
+
+        public void Dispose()
+        {
+            if (Interlocked.CompareExchange(ref _disposed, 1, 0) != 0)
+                return;
+
+            _releaseAction();
+            GC.SuppressFinalize(this);
         }
     }
-}
\ No newline at end of file
+}
@@ -1,9 +1,25 @@
 ﻿using System;
+using System.Collections.Generic;
+using System.Drawing;
 
 namespace SimpleRtspPlayer.RawFramesDecoding.DecodedFrames
 {
-    public interface IDecodedVideoFrame
+    public interface IDecodedVideoFrame : IDisposable
     {
+        /// <summary>
+        /// Errors the decoder concealed while producing this frame
+        /// </summary>
+        VideoFrameErrorFlags ErrorFlags { get; }
+
         void TransformTo(IntPtr buffer, int bufferStride, TransformParameters transformParameters);
+
+        /// <summary>
+        /// Converts only regions changed since the previous frame transformed into the same buffer
+        /// </summary>
+        /// <param name="dirtyRectangles">Receives rectangles of the buffer that were updated</param>
+        void TransformTo(IntPtr buffer, int bufferStride, TransformParameters transformParameters,
+            IList<Rectangle> dirtyRectangles);
+
+        void TransformToTensor(IntPtr tensorBuffer, int batchIndex, TensorParameters tensorParameters);
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.Diagnostics;
 using System.Linq;
 using System.Runtime.InteropServices;
@@ -9,13 +10,35 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
 {
     class FFmpegAudioDecoder
     {
+        private const int BatchBufferTooSmallResultCode = -5;
+        private const int InterleavedBufferTooSmallResultCode = -2;
+        private const int InterleavedFormatNotSupportedResultCode = -3;
+        private const int MixerInputOverflowResultCode = -3;
+
+        // Values of AVSampleFormat the native interleaving supports
+        private const int KeepSampleFormat = -1;
+        private const int S16SampleFormat = 1;
+        private const int FloatSampleFormat = 3;
+        private const int UnsupportedSampleFormat = -2;
+        private const int InitialBatchBytesPerFrame = 16 * 1024;
+        private const int DefaultMaxDriftCorrection = 2000;
+
         private readonly IntPtr _decoderHandle;
         private readonly FFmpegAudioCodecId _audioCodecId;
         private IntPtr _resamplerHandle;
+        private int _resamplerOutSampleRate;
+        private bool _driftCompensationEnabled;
+        private int _driftSampleDelta;
+        private int _driftCompensationDistance;
         private AudioFrameFormat _currentFrameFormat = new AudioFrameFormat(0, 0, 0);
         private DateTime _currentRawFrameTimestamp;
         private byte[] _extraData = new byte[0];
         private byte[] _decodedFrameBuffer = new byte[0];
+        private byte[] _batchBuffer = new byte[0];
+        private int _batchBytesPerFrame = InitialBatchBytesPerFrame;
+        private int[] _batchFrameOffsets = new int[0];
+        private int[] _batchFrameLengths = new int[0];
+        private int[] _batchOutOffsets = new int[1];
         private bool _disposed;
 
         public int BitsPerCodedSample { get; }
@@ -46,27 +69,7 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
         /// <exception cref="DecoderException"></exception>
         public unsafe bool TryDecode(RawAudioFrame rawAudioFrame)
         {
-            if (rawAudioFrame is RawAACFrame aacFrame)
-            {
-                Debug.Assert(aacFrame.ConfigSegment.Array != null, "aacFrame.ConfigSegment.Array != null");
-
-                if (!_extraData.SequenceEqual(aacFrame.ConfigSegment))
-                {
-                    if (_extraData.Length == aacFrame.ConfigSegment.Count)
-                        Buffer.BlockCopy(aacFrame.ConfigSegment.Array, aacFrame.ConfigSegment.Offset, _extraData, 0,
-                            aacFrame.ConfigSegment.Count);
-                    else
-                        _extraData = aacFrame.ConfigSegment.ToArray();
-
-                    fixed (byte* extradataPtr = &_extraData[0])
-                    {
-                        int resultCode = FFmpegAudioPInvoke.SetAudioDecoderExtraData(_decoderHandle, (IntPtr)extradataPtr, aacFrame.ConfigSegment.Count);
-
-                        if (resultCode != 0)
-                            throw new DecoderException($"An error occurred while setting audio extra data, {_audioCodecId} codec, code: {resultCode}");
-                    }
-                }
-            }
+            UpdateExtraData(rawAudioFrame);
 
             Debug.Assert(rawAudioFrame.FrameSegment.Array != null, "rawAudioFrame.FrameSegment.Array != null");
 
@@ -80,69 +83,206 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
                 if (resultCode != 0)
                     return false;
 
-                if (rawAudioFrame is RawG711Frame g711Frame)
-                {
-                    sampleRate = g711Frame.SampleRate;
-                    channels = g711Frame.Channels;
-                }
-
-                if (_currentFrameFormat.SampleRate != sampleRate || _currentFrameFormat.BitPerSample != bitsPerSample ||
-                    _currentFrameFormat.Channels != channels)
-                {
-                    _currentFrameFormat = new AudioFrameFormat(sampleRate, bitsPerSample, channels);
-
-                    if (_resamplerHandle != IntPtr.Zero)
-                        FFmpegAudioPInvoke.RemoveAudioResampler(_resamplerHandle);
-                }
+                UpdateFrameFormat(rawAudioFrame, sampleRate, bitsPerSample, channels);
             }
 
             return true;
         }
 
+        /// <summary>
+        /// Decodes access units of a single packet in one call. Samples of all units are stored interleaved
+        /// in one buffer, which is reused by the next call, so returned frames are valid until then
+        /// </summary>
+        /// <param name="rawAudioFrames">Frames sharing the same underlying array, like AUs of one RTP packet</param>
+        /// <param name="outBitsPerSample">16 for 16 bit samples, 32 for float ones, 0 keeps samples of the decoder</param>
+        /// <returns>Frame for every unit that produced samples</returns>
         /// <exception cref="DecoderException"></exception>
-        public IDecodedAudioFrame GetDecodedFrame(AudioConversionParameters optionalAudioConversionParameters = null)
+        public unsafe IReadOnlyList<IDecodedAudioFrame> DecodeBatch(IReadOnlyList<RawAudioFrame> rawAudioFrames,
+            int outBitsPerSample = 0)
         {
-            IntPtr outBufferPtr;
-            int dataSize;
+            if (rawAudioFrames == null)
+                throw new ArgumentNullException(nameof(rawAudioFrames));
+
+            int outSampleFormat = GetInterleavedSampleFormat(outBitsPerSample);
+
+            if (outSampleFormat == UnsupportedSampleFormat)
+                throw new ArgumentOutOfRangeException(nameof(outBitsPerSample));
+
+            int framesCount = rawAudioFrames.Count;
+            var decodedFrames = new List<IDecodedAudioFrame>(framesCount);
+
+            if (framesCount == 0)
+                return decodedFrames;
 
-            AudioFrameFormat format;
+            byte[] rawBuffer = rawAudioFrames[0].FrameSegment.Array;
+            Debug.Assert(rawBuffer != null, "rawBuffer != null");
+
+            if (_batchFrameOffsets.Length < framesCount)
+            {
+                _batchFrameOffsets = new int[framesCount];
+                _batchFrameLengths = new int[framesCount];
+                _batchOutOffsets = new int[framesCount + 1];
+            }
+
+            for (int i = 0; i < framesCount; i++)
+            {
+                ArraySegment<byte> frameSegment = rawAudioFrames[i].FrameSegment;
+
+                if (frameSegment.Array != rawBuffer)
+                    throw new ArgumentException("All frames of the batch should share the same buffer", nameof(rawAudioFrames));
+
+                _batchFrameOffsets[i] = frameSegment.Offset;
+                _batchFrameLengths[i] = frameSegment.Count;
+            }
+
+            UpdateExtraData(rawAudioFrames[0]);
+
+            int batchBufferSize = framesCount * _batchBytesPerFrame;
+
+            if (_batchBuffer.Length < batchBufferSize)
+                _batchBuffer = new byte[batchBufferSize];
 
             int resultCode;
+            int requiredSize, sampleRate, bitsPerSample, channels;
 
-            if (optionalAudioConversionParameters == null ||
-                (optionalAudioConversionParameters.OutSampleRate == 0 || optionalAudioConversionParameters.OutSampleRate == _currentFrameFormat.SampleRate) &&
-                (optionalAudioConversionParameters.OutBitsPerSample == 0 || optionalAudioConversionParameters.OutBitsPerSample == _currentFrameFormat.BitPerSample) &&
-                (optionalAudioConversionParameters.OutChannels == 0 || optionalAudioConversionParameters.OutChannels == _currentFrameFormat.Channels))
+            fixed (byte* rawBufferPtr = rawBuffer)
+            fixed (byte* batchBufferPtr = _batchBuffer)
+            fixed (int* frameOffsetsPtr = _batchFrameOffsets)
+            fixed (int* frameLengthsPtr = _batchFrameLengths)
+            fixed (int* outOffsetsPtr = _batchOutOffsets)
             {
-                resultCode = FFmpegAudioPInvoke.GetDecodedFrame(_decoderHandle, out outBufferPtr, out dataSize);
+                resultCode = FFmpegAudioPInvoke.DecodeFrames(_decoderHandle, (IntPtr)rawBufferPtr, (IntPtr)frameOffsetsPtr,
+                    (IntPtr)frameLengthsPtr, framesCount, outSampleFormat, (IntPtr)batchBufferPtr, _batchBuffer.Length, (IntPtr)outOffsetsPtr,
+                    out requiredSize, out sampleRate, out bitsPerSample, out channels);
+            }
 
-                if (resultCode != 0)
-                    throw new DecoderException($"An error occurred while getting decoded audio frame, {_audioCodecId} codec, code: {resultCode}");
+            // Frames that didn't fit are lost, but the next batch gets a buffer big enough
+            if (resultCode == BatchBufferTooSmallResultCode)
+                _batchBytesPerFrame = Math.Max(_batchBytesPerFrame, (requiredSize + framesCount - 1) / framesCount);
+            else if (resultCode != 0)
+                throw new DecoderException($"An error occurred while decoding audio frames, {_audioCodecId} codec, code: {resultCode}");
+
+            _currentRawFrameTimestamp = rawAudioFrames[framesCount - 1].Timestamp;
+            UpdateFrameFormat(rawAudioFrames[0], sampleRate, bitsPerSample, channels);
+
+            AudioFrameFormat format = outBitsPerSample == 0
+                ? _currentFrameFormat
+                : new AudioFrameFormat(_currentFrameFormat.SampleRate, outBitsPerSample, _currentFrameFormat.Channels);
+
+            for (int i = 0; i < framesCount; i++)
+            {
+                int dataSize = _batchOutOffsets[i + 1] - _batchOutOffsets[i];
+
+                if (dataSize == 0)
+                    continue;
 
-                format = _currentFrameFormat;
+                decodedFrames.Add(new DecodedAudioFrame(rawAudioFrames[i].Timestamp,
+                    new ArraySegment<byte>(_batchBuffer, _batchOutOffsets[i], dataSize), format));
             }
+
+            return decodedFrames;
+        }
+
+        private unsafe void UpdateExtraData(RawAudioFrame rawAudioFrame)
+        {
+            if (!(rawAudioFrame is RawAACFrame aacFrame))
+                return;
+
+            Debug.Assert(aacFrame.ConfigSegment.Array != null, "aacFrame.ConfigSegment.Array != null");
+
+            if (_extraData.SequenceEqual(aacFrame.ConfigSegment))
+                return;
+
+            if (_extraData.Length == aacFrame.ConfigSegment.Count)
+                Buffer.BlockCopy(aacFrame.ConfigSegment.Array, aacFrame.ConfigSegment.Offset, _extraData, 0,
+                    aacFrame.ConfigSegment.Count);
             else
+                _extraData = aacFrame.ConfigSegment.ToArray();
+
+            fixed (byte* extradataPtr = &_extraData[0])
             {
-                if (_resamplerHandle == IntPtr.Zero)
-                {
-                    resultCode = FFmpegAudioPInvoke.CreateAudioResampler(_decoderHandle,
-                        optionalAudioConversionParameters.OutSampleRate, optionalAudioConversionParameters.OutBitsPerSample,
-                        optionalAudioConversionParameters.OutChannels, out _resamplerHandle);
+                int resultCode = FFmpegAudioPInvoke.SetAudioDecoderExtraData(_decoderHandle, (IntPtr)extradataPtr, aacFrame.ConfigSegment.Count);
+
+                if (resultCode != 0)
+                    throw new DecoderException($"An error occurred while setting audio extra data, {_audioCodecId} codec, code: {resultCode}");
+            }
+        }
+
+        private void UpdateFrameFormat(RawAudioFrame rawAudioFrame, int sampleRate, int bitsPerSample, int channels)
+        {
+            if (rawAudioFrame is RawG711Frame g711Frame)
+            {
+                sampleRate = g711Frame.SampleRate;
+                channels = g711Frame.Channels;
+            }
 
-                    if (resultCode != 0)
-                        throw new DecoderException($"An error occurred while creating audio resampler, code: {resultCode}");
+            if (_currentFrameFormat.SampleRate != sampleRate || _currentFrameFormat.BitPerSample != bitsPerSample ||
+                _currentFrameFormat.Channels != channels)
+            {
+                _currentFrameFormat = new AudioFrameFormat(sampleRate, bitsPerSample, channels);
+
+                if (_resamplerHandle != IntPtr.Zero)
+                {
+                    FFmpegAudioPInvoke.RemoveAudioResampler(_resamplerHandle);
+                    _resamplerHandle = IntPtr.Zero;
                 }
+            }
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public IDecodedAudioFrame GetDecodedFrame(AudioConversionParameters optionalAudioConversionParameters = null)
+        {
+            IntPtr outBufferPtr;
+            int dataSize;
+
+            int resultCode;
+
+            int outBitsPerSample = optionalAudioConversionParameters?.OutBitsPerSample ?? 0;
+            int outSampleFormat = GetInterleavedSampleFormat(outBitsPerSample);
+
+            // Sample format conversion alone is done natively without swresample
+            if (!_driftCompensationEnabled && outSampleFormat != UnsupportedSampleFormat &&
+                (optionalAudioConversionParameters == null ||
+                (optionalAudioConversionParameters.OutSampleRate == 0 || optionalAudioConversionParameters.OutSampleRate == _currentFrameFormat.SampleRate) &&
+                (optionalAudioConversionParameters.OutChannels == 0 || optionalAudioConversionParameters.OutChannels == _currentFrameFormat.Channels)) &&
+                TryGetInterleavedFrame(outSampleFormat, out dataSize))
+            {
+                AudioFrameFormat interleavedFormat = outBitsPerSample == 0
+                    ? _currentFrameFormat
+                    : new AudioFrameFormat(_currentFrameFormat.SampleRate, outBitsPerSample, _currentFrameFormat.Channels);
+
+                return new DecodedAudioFrame(_currentRawFrameTimestamp, new ArraySegment<byte>(_decodedFrameBuffer, 0, dataSize),
+                    interleavedFormat);
+            }
 
-                resultCode = FFmpegAudioPInvoke.ResampleDecodedFrame(_decoderHandle, _resamplerHandle, out outBufferPtr, out dataSize);
+            AudioConversionParameters conversionParameters = optionalAudioConversionParameters ?? new AudioConversionParameters();
+
+            if (_resamplerHandle == IntPtr.Zero)
+            {
+                resultCode = FFmpegAudioPInvoke.CreateAudioResampler(_decoderHandle,
+                    conversionParameters.OutSampleRate, conversionParameters.OutBitsPerSample,
+                    conversionParameters.OutChannels, out _resamplerHandle);
 
                 if (resultCode != 0)
-                    throw new DecoderException($"An error occurred while converting audio frame, code: {resultCode}");
+                    throw new DecoderException($"An error occurred while creating audio resampler, code: {resultCode}");
+
+                _resamplerOutSampleRate = conversionParameters.OutSampleRate != 0
+                    ? conversionParameters.OutSampleRate
+                    : _currentFrameFormat.SampleRate;
 
-                format = new AudioFrameFormat(optionalAudioConversionParameters.OutSampleRate != 0 ? optionalAudioConversionParameters.OutSampleRate : _currentFrameFormat.SampleRate,
-                    optionalAudioConversionParameters.OutBitsPerSample != 0 ? optionalAudioConversionParameters.OutBitsPerSample : _currentFrameFormat.BitPerSample,
-                    optionalAudioConversionParameters.OutChannels != 0 ? optionalAudioConversionParameters.OutChannels : _currentFrameFormat.Channels);
+                if (_driftSampleDelta != 0)
+                    SetResamplerCompensation();
             }
 
+            resultCode = FFmpegAudioPInvoke.ResampleDecodedFrame(_decoderHandle, _resamplerHandle, out outBufferPtr, out dataSize);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while converting audio frame, code: {resultCode}");
+
+            var format = new AudioFrameFormat(conversionParameters.OutSampleRate != 0 ? conversionParameters.OutSampleRate : _currentFrameFormat.SampleRate,
+                conversionParameters.OutBitsPerSample != 0 ? conversionParameters.OutBitsPerSample : _currentFrameFormat.BitPerSample,
+                conversionParameters.OutChannels != 0 ? conversionParameters.OutChannels : _currentFrameFormat.Channels);
+
             if (_decodedFrameBuffer.Length < dataSize)
                 _decodedFrameBuffer = new byte[dataSize];
 
@@ -150,6 +290,168 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             return new DecodedAudioFrame(_currentRawFrameTimestamp, new ArraySegment<byte>(_decodedFrameBuffer, 0, dataSize), format);
         }
 
+        /// <summary>
+        /// Converts the last decoded frame to the format of the mixer and queues it to the input,
+        /// samples don't leave native memory. Should be called from a single thread per input
+        /// </summary>
+        /// <returns>False if samples were dropped because the input is full</returns>
+        /// <exception cref="DecoderException"></exception>
+        public bool PushDecodedFrame(FFmpegAudioMixerInput mixerInput)
+        {
+            if (mixerInput == null)
+                throw new ArgumentNullException(nameof(mixerInput));
+
+            int resultCode = FFmpegAudioPInvoke.PushAudioMixerInput(mixerInput.Handle, _decoderHandle);
+
+            if (resultCode == MixerInputOverflowResultCode)
+                return false;
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while pushing audio frame to mixer, {_audioCodecId} codec, code: {resultCode}");
+
+            return true;
+        }
+
+        /// <summary>
+        /// Measures levels of the last decoded frame without fetching its samples.
+        /// Should be called once per decoded frame, since activity detection follows the noise floor over time
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void GetLevels(AudioLevels levels)
+        {
+            if (levels == null)
+                throw new ArgumentNullException(nameof(levels));
+
+            int resultCode = FFmpegAudioPInvoke.GetDecodedFrameLevels(_decoderHandle, levels.Rms, levels.Peak,
+                AudioLevels.MaxChannels, out int channels, out int isActive);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while measuring audio levels, {_audioCodecId} codec, code: {resultCode}");
+
+            levels.Channels = channels;
+            levels.IsActive = isActive != 0;
+        }
+
+        /// <summary>
+        /// Audio is active while it is louder than minLevelDb and than the tracked noise floor by marginDb
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void SetActivityDetection(float minLevelDb, float marginDb, TimeSpan hangover)
+        {
+            if (marginDb < 0)
+                throw new ArgumentOutOfRangeException(nameof(marginDb));
+            if (hangover < TimeSpan.Zero)
+                throw new ArgumentOutOfRangeException(nameof(hangover));
+
+            int resultCode = FFmpegAudioPInvoke.SetAudioActivityDetection(_decoderHandle, minLevelDb, marginDb,
+                (int)hangover.TotalMilliseconds);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting audio activity detection, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Converted audio gets sampleDelta more samples, or fewer if it is negative, for every compensationDistance
+        /// output samples. Used when the drift between the sender and sound card clocks is known in advance
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void SetDriftCompensation(int sampleDelta, int compensationDistance)
+        {
+            if (compensationDistance <= 0)
+                throw new ArgumentOutOfRangeException(nameof(compensationDistance));
+            if (Math.Abs(sampleDelta) >= compensationDistance)
+                throw new ArgumentOutOfRangeException(nameof(sampleDelta));
+
+            _driftCompensationEnabled = true;
+            _driftSampleDelta = sampleDelta;
+            _driftCompensationDistance = compensationDistance;
+
+            if (_resamplerHandle != IntPtr.Zero)
+                SetResamplerCompensation();
+        }
+
+        /// <summary>
+        /// Speeds up or slows down converted audio so that the playout buffer it goes to stays at the target latency.
+        /// Should be called after every converted frame, e.g. with the state of <see cref="FFmpegAudioJitterBuffer"/>
+        /// </summary>
+        /// <param name="bufferedDuration">Audio currently waiting for the sound card</param>
+        /// <param name="targetLatency">Latency to keep, e.g. 100 ms</param>
+        /// <param name="maxCorrection">Limit of speed change in parts per million</param>
+        /// <exception cref="DecoderException"></exception>
+        public void AdjustDriftCompensation(TimeSpan bufferedDuration, TimeSpan targetLatency,
+            int maxCorrection = DefaultMaxDriftCorrection)
+        {
+            if (maxCorrection < 0)
+                throw new ArgumentOutOfRangeException(nameof(maxCorrection));
+
+            _driftCompensationEnabled = true;
+            _driftSampleDelta = 0;
+            _driftCompensationDistance = 0;
+
+            // Resampler is created with the next converted frame
+            if (_resamplerHandle == IntPtr.Zero)
+                return;
+
+            int bufferedSamples = (int)(bufferedDuration.Ticks * _resamplerOutSampleRate / TimeSpan.TicksPerSecond);
+            int targetSamples = (int)(targetLatency.Ticks * _resamplerOutSampleRate / TimeSpan.TicksPerSecond);
+
+            int resultCode = FFmpegAudioPInvoke.AdjustAudioResamplerDrift(_resamplerHandle, bufferedSamples, targetSamples,
+                maxCorrection, out _);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while adjusting audio drift compensation, code: {resultCode}");
+        }
+
+        private void SetResamplerCompensation()
+        {
+            int resultCode = FFmpegAudioPInvoke.SetAudioResamplerCompensation(_resamplerHandle, _driftSampleDelta,
+                _driftCompensationDistance);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting audio drift compensation, code: {resultCode}");
+        }
+
+        private unsafe bool TryGetInterleavedFrame(int outSampleFormat, out int dataSize)
+        {
+            int resultCode;
+
+            fixed (byte* bufferPtr = _decodedFrameBuffer)
+                resultCode = FFmpegAudioPInvoke.GetDecodedFrameInterleaved(_decoderHandle, outSampleFormat, (IntPtr)bufferPtr,
+                    _decodedFrameBuffer.Length, out dataSize);
+
+            if (resultCode == InterleavedBufferTooSmallResultCode)
+            {
+                _decodedFrameBuffer = new byte[dataSize];
+
+                fixed (byte* bufferPtr = _decodedFrameBuffer)
+                    resultCode = FFmpegAudioPInvoke.GetDecodedFrameInterleaved(_decoderHandle, outSampleFormat, (IntPtr)bufferPtr,
+                        _decodedFrameBuffer.Length, out dataSize);
+            }
+
+            if (resultCode == InterleavedFormatNotSupportedResultCode)
+                return false;
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while getting decoded audio frame, {_audioCodecId} codec, code: {resultCode}");
+
+            return true;
+        }
+
+        private static int GetInterleavedSampleFormat(int outBitsPerSample)
+        {
+            switch (outBitsPerSample)
+            {
+                case 0:
+                    return KeepSampleFormat;
+                case 16:
+                    return S16SampleFormat;
+                case 32:
+                    return FloatSampleFormat;
+                default:
+                    return UnsupportedSampleFormat;
+            }
+        }
+
         public void Dispose()
         {
             if (_disposed)
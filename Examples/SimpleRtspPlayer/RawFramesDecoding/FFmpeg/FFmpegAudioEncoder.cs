@@ -0,0 +1,125 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using RtspClientSharp;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Encodes 16 bit interleaved samples for backchannel (talkback). G.711 frames are 20 ms long, so with
+    /// capture and device buffering push-to-talk stays well under 150 ms; AAC adds 1024 samples of framing
+    /// and about as much of encoder delay on top of that
+    /// </summary>
+    class FFmpegAudioEncoder
+    {
+        private static readonly TimeSpan G711FrameDuration = TimeSpan.FromMilliseconds(20);
+        private const int DefaultAacBitRate = 32000;
+
+        private byte[] _frameBuffer = new byte[0];
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public BackchannelAudioFormat Format { get; }
+
+        /// <summary>
+        /// Count of samples per channel in every encoded frame
+        /// </summary>
+        public int FrameSize { get; }
+
+        private FFmpegAudioEncoder(IntPtr handle, BackchannelAudioFormat format, int frameSize)
+        {
+            Handle = handle;
+            Format = format;
+            FrameSize = frameSize;
+        }
+
+        ~FFmpegAudioEncoder()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegAudioEncoder Create(BackchannelAudioFormat format, int bitRate = DefaultAacBitRate)
+        {
+            if (format == null)
+                throw new ArgumentNullException(nameof(format));
+
+            FFmpegAudioCodecId codecId;
+
+            switch (format.Codec)
+            {
+                case BackchannelAudioCodec.G711A:
+                    codecId = FFmpegAudioCodecId.G711A;
+                    break;
+                case BackchannelAudioCodec.G711U:
+                    codecId = FFmpegAudioCodecId.G711U;
+                    break;
+                case BackchannelAudioCodec.AAC:
+                    codecId = FFmpegAudioCodecId.AAC;
+                    break;
+                default:
+                    throw new ArgumentOutOfRangeException(nameof(format));
+            }
+
+            int g711FrameSize = (int)(format.SampleRate * G711FrameDuration.TotalSeconds);
+
+            int resultCode = FFmpegAudioPInvoke.CreateAudioEncoder(codecId, format.SampleRate, format.Channels, bitRate,
+                g711FrameSize, out IntPtr handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating audio encoder, code: {resultCode}");
+
+            resultCode = FFmpegAudioPInvoke.GetAudioEncoderFrameSize(handle, out int frameSize);
+
+            if (resultCode != 0)
+            {
+                FFmpegAudioPInvoke.RemoveAudioEncoder(handle);
+                throw new DecoderException($"An error occurred while getting audio encoder frame size, code: {resultCode}");
+            }
+
+            return new FFmpegAudioEncoder(handle, format, frameSize);
+        }
+
+        /// <summary>
+        /// Takes samples until one frame is encoded or all of them are consumed, so it should be called
+        /// again with the rest of samples. Frame segment is valid until the next call and empty when
+        /// more samples are needed
+        /// </summary>
+        /// <returns>Count of consumed samples per channel</returns>
+        /// <exception cref="DecoderException"></exception>
+        public int Encode(IntPtr samples, int samplesCount, out ArraySegment<byte> frameSegment)
+        {
+            if (samplesCount < 0)
+                throw new ArgumentOutOfRangeException(nameof(samplesCount));
+
+            int resultCode = FFmpegAudioPInvoke.EncodeAudioSamples(Handle, samples, samplesCount, out int consumedCount,
+                out IntPtr outBuffer, out int outDataSize);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while encoding audio, code: {resultCode}");
+
+            if (outDataSize == 0)
+            {
+                frameSegment = new ArraySegment<byte>(_frameBuffer, 0, 0);
+                return consumedCount;
+            }
+
+            if (_frameBuffer.Length < outDataSize)
+                _frameBuffer = new byte[outDataSize];
+
+            Marshal.Copy(outBuffer, _frameBuffer, 0, outDataSize);
+
+            frameSegment = new ArraySegment<byte>(_frameBuffer, 0, outDataSize);
+            return consumedCount;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegAudioPInvoke.RemoveAudioEncoder(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
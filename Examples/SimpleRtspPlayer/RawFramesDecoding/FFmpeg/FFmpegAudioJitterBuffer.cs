@@ -0,0 +1,117 @@
+﻿using System;
+using System.Diagnostics;
+using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Decoded audio of a single stream between the receiving thread and the audio device callback.
+    /// Latency follows the measured arrival jitter between the minimum and maximum one
+    /// </summary>
+    class FFmpegAudioJitterBuffer
+    {
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public AudioFrameFormat Format { get; }
+
+        /// <summary>
+        /// Size of a sample of all channels in bytes
+        /// </summary>
+        public int SampleSize { get; }
+
+        private FFmpegAudioJitterBuffer(IntPtr handle, AudioFrameFormat format, int sampleSize)
+        {
+            Handle = handle;
+            Format = format;
+            SampleSize = sampleSize;
+        }
+
+        ~FFmpegAudioJitterBuffer()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegAudioJitterBuffer Create(AudioFrameFormat format, TimeSpan minLatency, TimeSpan maxLatency)
+        {
+            if (format.SampleRate <= 0 || format.BitPerSample <= 0 || format.Channels <= 0)
+                throw new ArgumentOutOfRangeException(nameof(format));
+            if (minLatency < TimeSpan.Zero)
+                throw new ArgumentOutOfRangeException(nameof(minLatency));
+            if (maxLatency <= TimeSpan.Zero || maxLatency < minLatency)
+                throw new ArgumentOutOfRangeException(nameof(maxLatency));
+
+            int sampleSize = format.BitPerSample / 8 * format.Channels;
+
+            int resultCode = FFmpegAudioPInvoke.CreateAudioJitterBuffer(format.SampleRate, sampleSize,
+                (int)minLatency.TotalMilliseconds, (int)maxLatency.TotalMilliseconds, out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating audio jitter buffer, code: {resultCode}");
+
+            return new FFmpegAudioJitterBuffer(handle, format, sampleSize);
+        }
+
+        /// <summary>
+        /// Should be called from the receiving thread only. Frames older than already buffered audio are dropped
+        /// </summary>
+        public unsafe void Push(IDecodedAudioFrame decodedFrame)
+        {
+            if (decodedFrame == null)
+                throw new ArgumentNullException(nameof(decodedFrame));
+            if (!decodedFrame.Format.Equals(Format))
+                throw new ArgumentException("Frame format differs from the format of the buffer", nameof(decodedFrame));
+
+            ArraySegment<byte> decodedBytes = decodedFrame.DecodedBytes;
+            int samplesCount = decodedBytes.Count / SampleSize;
+
+            if (samplesCount == 0)
+                return;
+
+            Debug.Assert(decodedBytes.Array != null, "decodedBytes.Array != null");
+
+            fixed (byte* samplesPtr = &decodedBytes.Array[decodedBytes.Offset])
+                FFmpegAudioPInvoke.PushAudioJitterBuffer(Handle, (IntPtr)samplesPtr, samplesCount,
+                    decodedFrame.Timestamp.Ticks);
+        }
+
+        /// <summary>
+        /// Should be called from the audio device callback only. The whole buffer is always filled,
+        /// with silence while the buffer fills up again after an underrun
+        /// </summary>
+        /// <returns>Count of samples of the stream at the beginning of the buffer</returns>
+        public int Pull(IntPtr buffer, int samplesCount)
+        {
+            if (samplesCount < 0)
+                throw new ArgumentOutOfRangeException(nameof(samplesCount));
+
+            FFmpegAudioPInvoke.PullAudioJitterBuffer(Handle, buffer, samplesCount, out int playedCount);
+            return playedCount;
+        }
+
+        public AudioJitterBufferState GetState()
+        {
+            FFmpegAudioPInvoke.GetAudioJitterBufferState(Handle, out int bufferedSamples, out int targetLatency,
+                out long underruns, out long droppedSamples, out long lateSamples);
+
+            return new AudioJitterBufferState(SamplesToTime(bufferedSamples), SamplesToTime(targetLatency), underruns,
+                droppedSamples, lateSamples);
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegAudioPInvoke.RemoveAudioJitterBuffer(Handle);
+            GC.SuppressFinalize(this);
+        }
+
+        private TimeSpan SamplesToTime(long samplesCount)
+        {
+            return TimeSpan.FromTicks(samplesCount * TimeSpan.TicksPerSecond / Format.SampleRate);
+        }
+    }
+}
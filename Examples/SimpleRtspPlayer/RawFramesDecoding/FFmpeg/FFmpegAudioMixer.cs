@@ -0,0 +1,99 @@
+﻿using System;
+using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Mixes audio of several streams into a single 16 bit output stream, so one audio device plays all of them.
+    /// Every input is converted to the output format when it is pushed
+    /// </summary>
+    class FFmpegAudioMixer
+    {
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public AudioFrameFormat Format { get; }
+
+        /// <summary>
+        /// Size of a sample of all channels in bytes
+        /// </summary>
+        public int SampleSize { get; }
+
+        internal bool IsDisposed => _disposed;
+
+        private FFmpegAudioMixer(IntPtr handle, AudioFrameFormat format)
+        {
+            Handle = handle;
+            Format = format;
+            SampleSize = format.BitPerSample / 8 * format.Channels;
+        }
+
+        ~FFmpegAudioMixer()
+        {
+            Dispose();
+        }
+
+        /// <param name="minLatency">Audio every input buffers before it is mixed</param>
+        /// <param name="maxLatency">Audio every input buffers at most, newer samples are dropped</param>
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegAudioMixer Create(int sampleRate, int channels, TimeSpan minLatency, TimeSpan maxLatency)
+        {
+            if (sampleRate <= 0)
+                throw new ArgumentOutOfRangeException(nameof(sampleRate));
+            if (channels <= 0)
+                throw new ArgumentOutOfRangeException(nameof(channels));
+            if (minLatency < TimeSpan.Zero)
+                throw new ArgumentOutOfRangeException(nameof(minLatency));
+            if (maxLatency <= TimeSpan.Zero || maxLatency < minLatency)
+                throw new ArgumentOutOfRangeException(nameof(maxLatency));
+
+            int resultCode = FFmpegAudioPInvoke.CreateAudioMixer(sampleRate, channels, (int)minLatency.TotalMilliseconds,
+                (int)maxLatency.TotalMilliseconds, out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating audio mixer, code: {resultCode}");
+
+            return new FFmpegAudioMixer(handle, new AudioFrameFormat(sampleRate, 16, channels));
+        }
+
+        /// <param name="gain">Linear gain of the input, from 0 to 8</param>
+        /// <exception cref="DecoderException"></exception>
+        public FFmpegAudioMixerInput AddInput(float gain = 1)
+        {
+            int resultCode = FFmpegAudioPInvoke.AddAudioMixerInput(Handle, gain, out var inputHandle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while adding audio mixer input, code: {resultCode}");
+
+            return new FFmpegAudioMixerInput(this, inputHandle, gain);
+        }
+
+        /// <summary>
+        /// Should be called from the audio device callback only. The whole buffer is always filled,
+        /// inputs that ran out of samples are silent until they buffer the minimum latency again
+        /// </summary>
+        /// <returns>Count of inputs mixed into the buffer</returns>
+        public int Pull(IntPtr buffer, int samplesCount)
+        {
+            if (samplesCount < 0)
+                throw new ArgumentOutOfRangeException(nameof(samplesCount));
+
+            int resultCode = FFmpegAudioPInvoke.PullAudioMixer(Handle, buffer, samplesCount, out int mixedInputs);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while mixing audio, code: {resultCode}");
+
+            return mixedInputs;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegAudioPInvoke.RemoveAudioMixer(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+﻿using System;
+using System.Diagnostics;
+using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Audio of a single stream for <see cref="FFmpegAudioMixer"/>. Native input is owned by the mixer,
+    /// so it is released either by <see cref="Dispose"/> or together with the mixer
+    /// </summary>
+    class FFmpegAudioMixerInput
+    {
+        private const int InputOverflowResultCode = -3;
+
+        private readonly FFmpegAudioMixer _mixer;
+        private float _gain;
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+
+        public float Gain
+        {
+            get => _gain;
+            set
+            {
+                FFmpegAudioPInvoke.SetAudioMixerInputGain(Handle, value);
+                _gain = value;
+            }
+        }
+
+        public TimeSpan BufferedDuration
+        {
+            get
+            {
+                FFmpegAudioPInvoke.GetAudioMixerInputState(Handle, out int bufferedSamples, out _, out _);
+                return TimeSpan.FromTicks(bufferedSamples * TimeSpan.TicksPerSecond / _mixer.Format.SampleRate);
+            }
+        }
+
+        public long UnderrunsCount
+        {
+            get
+            {
+                FFmpegAudioPInvoke.GetAudioMixerInputState(Handle, out _, out long underruns, out _);
+                return underruns;
+            }
+        }
+
+        public long DroppedSamplesCount
+        {
+            get
+            {
+                FFmpegAudioPInvoke.GetAudioMixerInputState(Handle, out _, out _, out long droppedSamples);
+                return droppedSamples;
+            }
+        }
+
+        internal FFmpegAudioMixerInput(FFmpegAudioMixer mixer, IntPtr handle, float gain)
+        {
+            _mixer = mixer;
+            _gain = gain;
+            Handle = handle;
+        }
+
+        /// <summary>
+        /// Should be called from a single thread. Frame has to be in the format of the mixer,
+        /// see <see cref="FFmpegAudioDecoder.PushDecodedFrame"/> for frames in other formats
+        /// </summary>
+        /// <returns>False if samples were dropped because the input is full</returns>
+        public unsafe bool Push(IDecodedAudioFrame decodedFrame)
+        {
+            if (decodedFrame == null)
+                throw new ArgumentNullException(nameof(decodedFrame));
+            if (!decodedFrame.Format.Equals(_mixer.Format))
+                throw new ArgumentException("Frame format differs from the format of the mixer", nameof(decodedFrame));
+
+            ArraySegment<byte> decodedBytes = decodedFrame.DecodedBytes;
+            int samplesCount = decodedBytes.Count / _mixer.SampleSize;
+
+            if (samplesCount == 0)
+                return true;
+
+            Debug.Assert(decodedBytes.Array != null, "decodedBytes.Array != null");
+
+            int resultCode;
+
+            fixed (byte* samplesPtr = &decodedBytes.Array[decodedBytes.Offset])
+                resultCode = FFmpegAudioPInvoke.PushAudioMixerInputSamples(Handle, (IntPtr)samplesPtr, samplesCount);
+
+            return resultCode != InputOverflowResultCode;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+
+            if (!_mixer.IsDisposed)
+                FFmpegAudioPInvoke.RemoveAudioMixerInput(Handle);
+        }
+    }
+}
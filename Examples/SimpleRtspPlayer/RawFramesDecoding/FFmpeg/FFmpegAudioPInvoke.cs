@@ -19,16 +19,95 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
         [DllImport(LibraryName, EntryPoint = "decode_audio_frame", CallingConvention = CallingConvention.Cdecl)]
         public static extern int DecodeFrame(IntPtr handle, IntPtr rawBuffer, int rawBufferLength, out int sampleRate, out int bitsPerSample, out int channels);
 
+        [DllImport(LibraryName, EntryPoint = "decode_audio_frames", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int DecodeFrames(IntPtr handle, IntPtr rawBuffer, IntPtr frameOffsets, IntPtr frameLengths,
+            int framesCount, int outSampleFormat, IntPtr outBuffer, int outBufferSize, IntPtr outOffsets, out int requiredSize,
+            out int sampleRate, out int bitsPerSample, out int channels);
+
         [DllImport(LibraryName, EntryPoint = "get_decoded_audio_frame", CallingConvention = CallingConvention.Cdecl)]
         public static extern int GetDecodedFrame(IntPtr handle, out IntPtr outBuffer, out int outDataSize);
 
+        [DllImport(LibraryName, EntryPoint = "get_decoded_audio_frame_interleaved", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetDecodedFrameInterleaved(IntPtr handle, int outSampleFormat, IntPtr outBuffer, int outBufferSize, out int outDataSize);
+
+        [DllImport(LibraryName, EntryPoint = "get_decoded_audio_frame_levels", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetDecodedFrameLevels(IntPtr handle, [Out] float[] rms, [Out] float[] peak, int channelsCapacity,
+            out int channels, out int isActive);
+
+        [DllImport(LibraryName, EntryPoint = "set_audio_activity_detection", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetAudioActivityDetection(IntPtr handle, float minLevelDb, float marginDb, int hangoverMs);
+
+        [DllImport(LibraryName, EntryPoint = "create_audio_encoder", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateAudioEncoder(FFmpegAudioCodecId audioCodecId, int sampleRate, int channels, int bitRate,
+            int frameSize, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "encode_audio_samples", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int EncodeAudioSamples(IntPtr handle, IntPtr samples, int samplesCount, out int consumedCount,
+            out IntPtr outBuffer, out int outDataSize);
+
+        [DllImport(LibraryName, EntryPoint = "get_audio_encoder_frame_size", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetAudioEncoderFrameSize(IntPtr handle, out int frameSize);
+
+        [DllImport(LibraryName, EntryPoint = "remove_audio_encoder", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveAudioEncoder(IntPtr handle);
+
         [DllImport(LibraryName, EntryPoint = "create_audio_resampler", CallingConvention = CallingConvention.Cdecl)]
         public static extern int CreateAudioResampler(IntPtr decoderHandle, int outSampleRate, int outBitsPerSample, int outChannels, out IntPtr handle);
 
         [DllImport(LibraryName, EntryPoint = "resample_decoded_audio_frame", CallingConvention = CallingConvention.Cdecl)]
         public static extern int ResampleDecodedFrame(IntPtr decoderHandle, IntPtr resamplerHandle, out IntPtr outBuffer, out int outDataSize);
 
+        [DllImport(LibraryName, EntryPoint = "set_audio_resampler_compensation", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetAudioResamplerCompensation(IntPtr handle, int sampleDelta, int compensationDistance);
+
+        [DllImport(LibraryName, EntryPoint = "adjust_audio_resampler_drift", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AdjustAudioResamplerDrift(IntPtr handle, int bufferedSamples, int targetSamples, int maxCorrection, out int sampleDelta);
+
         [DllImport(LibraryName, EntryPoint = "remove_audio_resampler", CallingConvention = CallingConvention.Cdecl)]
         public static extern void RemoveAudioResampler(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_audio_jitter_buffer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateAudioJitterBuffer(int sampleRate, int sampleSize, int minLatency, int maxLatency, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "push_audio_jitter_buffer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PushAudioJitterBuffer(IntPtr handle, IntPtr samples, int samplesCount, long timestamp);
+
+        [DllImport(LibraryName, EntryPoint = "pull_audio_jitter_buffer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PullAudioJitterBuffer(IntPtr handle, IntPtr outBuffer, int samplesCount, out int playedCount);
+
+        [DllImport(LibraryName, EntryPoint = "get_audio_jitter_buffer_state", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetAudioJitterBufferState(IntPtr handle, out int bufferedSamples, out int targetLatency,
+            out long underruns, out long droppedSamples, out long lateSamples);
+
+        [DllImport(LibraryName, EntryPoint = "remove_audio_jitter_buffer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveAudioJitterBuffer(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_audio_mixer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateAudioMixer(int sampleRate, int channels, int minLatencyMs, int maxLatencyMs, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "add_audio_mixer_input", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AddAudioMixerInput(IntPtr handle, float gain, out IntPtr inputHandle);
+
+        [DllImport(LibraryName, EntryPoint = "set_audio_mixer_input_gain", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetAudioMixerInputGain(IntPtr inputHandle, float gain);
+
+        [DllImport(LibraryName, EntryPoint = "push_audio_mixer_input", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PushAudioMixerInput(IntPtr inputHandle, IntPtr decoderHandle);
+
+        [DllImport(LibraryName, EntryPoint = "push_audio_mixer_input_samples", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PushAudioMixerInputSamples(IntPtr inputHandle, IntPtr samples, int samplesCount);
+
+        [DllImport(LibraryName, EntryPoint = "pull_audio_mixer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PullAudioMixer(IntPtr handle, IntPtr outBuffer, int samplesCount, out int mixedInputs);
+
+        [DllImport(LibraryName, EntryPoint = "get_audio_mixer_input_state", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetAudioMixerInputState(IntPtr inputHandle, out int bufferedSamples, out long underruns,
+            out long droppedSamples);
+
+        [DllImport(LibraryName, EntryPoint = "remove_audio_mixer_input", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveAudioMixerInput(IntPtr inputHandle);
+
+        [DllImport(LibraryName, EntryPoint = "remove_audio_mixer", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveAudioMixer(IntPtr handle);
     }
 }
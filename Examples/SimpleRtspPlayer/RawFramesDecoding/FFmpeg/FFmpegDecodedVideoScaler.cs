@@ -1,10 +1,18 @@
 ﻿using System;
+using System.Drawing;
 
 namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
 {
     class FFmpegDecodedVideoScaler
     {
         private const double MaxAspectRatioError = 0.1;
+        private const int ChangeDetectionTileSize = 64;
+        private const int ChangeDetectionThreshold = 1;
+        private const int ChangeDetectionUnsupportedResultCode = -2;
+
+        private readonly FFmpegScalingQuality _scaleQuality;
+        private IntPtr _changeDetectionBuffer;
+        private int _changeDetectionBufferStride;
         private bool _disposed;
 
         public IntPtr Handle { get; }
@@ -13,8 +21,9 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
         public PixelFormat ScaledPixelFormat { get; }
 
         private FFmpegDecodedVideoScaler(IntPtr handle, int scaledWidth, int scaledHeight,
-            PixelFormat scaledPixelFormat)
+            PixelFormat scaledPixelFormat, FFmpegScalingQuality scaleQuality)
         {
+            _scaleQuality = scaleQuality;
             Handle = handle;
             ScaledWidth = scaledWidth;
             ScaledHeight = scaledHeight;
@@ -39,8 +48,6 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             int sourceTop = 0;
             int sourceWidth = decodedVideoFrameParameters.Width;
             int sourceHeight = decodedVideoFrameParameters.Height;
-            int scaledWidth = decodedVideoFrameParameters.Width;
-            int scaledHeight = decodedVideoFrameParameters.Height;
 
             if (!transformParameters.RegionOfInterest.IsEmpty)
             {
@@ -54,14 +61,28 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
                     (int) (decodedVideoFrameParameters.Height * transformParameters.RegionOfInterest.Height);
             }
 
+            bool transposed = transformParameters.Rotation == RotationAngle.Rotate90 ||
+                              transformParameters.Rotation == RotationAngle.Rotate270;
+
+            // Source size as it is seen after rotation
+            int rotatedSourceWidth = transposed ? sourceHeight : sourceWidth;
+            int rotatedSourceHeight = transposed ? sourceWidth : sourceHeight;
+
+            int scaledWidth = rotatedSourceWidth;
+            int scaledHeight = rotatedSourceHeight;
+            int targetWidth = scaledWidth;
+            int targetHeight = scaledHeight;
+
             if (!transformParameters.TargetFrameSize.IsEmpty)
             {
                 scaledWidth = transformParameters.TargetFrameSize.Width;
                 scaledHeight = transformParameters.TargetFrameSize.Height;
+                targetWidth = scaledWidth;
+                targetHeight = scaledHeight;
 
                 ScalingPolicy scalingPolicy = transformParameters.ScalePolicy;
 
-                float srcAspectRatio = (float) sourceWidth / sourceHeight;
+                float srcAspectRatio = (float) rotatedSourceWidth / rotatedSourceHeight;
                 float destAspectRatio = (float) scaledWidth / scaledHeight;
 
                 if (scalingPolicy == ScalingPolicy.Auto)
@@ -73,12 +94,18 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
                         : ScalingPolicy.Stretch;
                 }
 
-                if (scalingPolicy == ScalingPolicy.RespectAspectRatio)
+                if (scalingPolicy == ScalingPolicy.RespectAspectRatio || scalingPolicy == ScalingPolicy.Letterbox)
                 {
                     if (destAspectRatio < srcAspectRatio)
-                        scaledHeight = sourceHeight * scaledWidth / sourceWidth;
+                        scaledHeight = rotatedSourceHeight * scaledWidth / rotatedSourceWidth;
                     else
-                        scaledWidth = sourceWidth * scaledHeight / sourceHeight;
+                        scaledWidth = rotatedSourceWidth * scaledHeight / rotatedSourceHeight;
+                }
+
+                if (scalingPolicy != ScalingPolicy.Letterbox)
+                {
+                    targetWidth = scaledWidth;
+                    targetHeight = scaledHeight;
                 }
             }
 
@@ -86,14 +113,51 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             FFmpegPixelFormat scaledFFmpegPixelFormat = GetFFmpegPixelFormat(scaledPixelFormat);
             FFmpegScalingQuality scaleQuality = GetFFmpegScaleQuality(transformParameters.ScaleQuality);
 
+            Color fillColor = transformParameters.FillColor;
+
             int resultCode = FFmpegVideoPInvoke.CreateVideoScaler(sourceLeft, sourceTop, sourceWidth, sourceHeight,
                 decodedVideoFrameParameters.PixelFormat,
-                scaledWidth, scaledHeight, scaledFFmpegPixelFormat, scaleQuality, out var handle);
+                scaledWidth, scaledHeight, scaledFFmpegPixelFormat, scaleQuality, targetWidth, targetHeight,
+                transformParameters.Rotation, transformParameters.Mirror ? 1 : 0,
+                fillColor.R << 16 | fillColor.G << 8 | fillColor.B, out var handle);
 
             if (resultCode != 0)
                 throw new DecoderException(@"An error occurred while creating scaler, code: {resultCode}");
 
-            return new FFmpegDecodedVideoScaler(handle, scaledWidth, scaledHeight, scaledPixelFormat);
+            return new FFmpegDecodedVideoScaler(handle, scaledWidth, scaledHeight, scaledPixelFormat, scaleQuality);
+        }
+
+        /// <summary>
+        /// Converts only tiles changed since the previous call with the same buffer
+        /// </summary>
+        /// <param name="dirtyRects">Receives left, top, width and height of every changed rectangle</param>
+        /// <returns>Count of changed rectangles</returns>
+        /// <exception cref="DecoderException"></exception>
+        public int ScaleAcquiredFrameChanges(IntPtr frameHandle, IntPtr buffer, int bufferStride, int[] dirtyRects)
+        {
+            int resultCode;
+
+            // History is kept for a single buffer, so it is reset whenever the buffer changes
+            if (buffer != _changeDetectionBuffer || bufferStride != _changeDetectionBufferStride)
+            {
+                resultCode = FFmpegVideoPInvoke.SetVideoScalerChangeDetection(Handle, ChangeDetectionTileSize,
+                    ChangeDetectionThreshold, _scaleQuality);
+
+                // Rotated pictures are always converted as a whole
+                if (resultCode != 0 && resultCode != ChangeDetectionUnsupportedResultCode)
+                    throw new DecoderException($"An error occurred while enabling change detection, code: {resultCode}");
+
+                _changeDetectionBuffer = buffer;
+                _changeDetectionBufferStride = bufferStride;
+            }
+
+            resultCode = FFmpegVideoPInvoke.ScaleAcquiredVideoFrameChanges(frameHandle, Handle, buffer, bufferStride,
+                dirtyRects, dirtyRects.Length / 4, out int dirtyRectsCount);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while converting changes of video frame, code: {resultCode}");
+
+            return dirtyRectsCount;
         }
 
         public void Dispose()
@@ -106,7 +170,7 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             GC.SuppressFinalize(this);
         }
 
-        private static FFmpegScalingQuality GetFFmpegScaleQuality(ScalingQuality scalingQuality)
+        public static FFmpegScalingQuality GetFFmpegScaleQuality(ScalingQuality scalingQuality)
         {
             if (scalingQuality == ScalingQuality.Nearest)
                 return FFmpegScalingQuality.Point;
@@ -120,7 +184,7 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             throw new ArgumentOutOfRangeException(nameof(scalingQuality));
         }
 
-        private static FFmpegPixelFormat GetFFmpegPixelFormat(PixelFormat pixelFormat)
+        public static FFmpegPixelFormat GetFFmpegPixelFormat(PixelFormat pixelFormat)
         {
             if (pixelFormat == PixelFormat.Bgra32)
                 return FFmpegPixelFormat.BGRA;
@@ -128,6 +192,12 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
                 return FFmpegPixelFormat.GRAY8;
             if (pixelFormat == PixelFormat.Bgr24)
                 return FFmpegPixelFormat.BGR24;
+            if (pixelFormat == PixelFormat.I420)
+                return FFmpegPixelFormat.YUV420P;
+            if (pixelFormat == PixelFormat.Nv12)
+                return FFmpegPixelFormat.NV12;
+            if (pixelFormat == PixelFormat.Yuy2)
+                return FFmpegPixelFormat.YUYV422;
 
             throw new ArgumentOutOfRangeException(nameof(pixelFormat));
         }
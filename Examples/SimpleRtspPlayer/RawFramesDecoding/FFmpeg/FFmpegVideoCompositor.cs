@@ -0,0 +1,103 @@
+﻿using System;
+using System.Drawing;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Single output surface with tiles, every decoder scales its frames directly into own tile
+    /// </summary>
+    class FFmpegVideoCompositor
+    {
+        private const int MaxTilesCount = 64;
+
+        private readonly int[] _dirtyRects = new int[MaxTilesCount * 4];
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public Size SurfaceSize { get; }
+        public PixelFormat PixelFormat { get; }
+        public IntPtr[] SurfacePlanes { get; } = new IntPtr[4];
+        public int[] SurfacePlaneStrides { get; } = new int[4];
+
+        private FFmpegVideoCompositor(IntPtr handle, Size surfaceSize, PixelFormat pixelFormat)
+        {
+            Handle = handle;
+            SurfaceSize = surfaceSize;
+            PixelFormat = pixelFormat;
+
+            FFmpegVideoPInvoke.GetVideoCompositorSurface(handle, SurfacePlanes, SurfacePlaneStrides);
+        }
+
+        ~FFmpegVideoCompositor()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoCompositor Create(Size surfaceSize, PixelFormat pixelFormat, Color fillColor,
+            Color borderColor, int borderWidth, bool keepAspectRatio, ScalingQuality scaleQuality)
+        {
+            if (surfaceSize.Width <= 0 || surfaceSize.Height <= 0)
+                throw new ArgumentOutOfRangeException(nameof(surfaceSize));
+            if (borderWidth < 0)
+                throw new ArgumentOutOfRangeException(nameof(borderWidth));
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoCompositor(surfaceSize.Width, surfaceSize.Height,
+                FFmpegDecodedVideoScaler.GetFFmpegPixelFormat(pixelFormat), GetColorValue(fillColor),
+                GetColorValue(borderColor), borderWidth, keepAspectRatio ? 1 : 0,
+                FFmpegDecodedVideoScaler.GetFFmpegScaleQuality(scaleQuality), out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating video compositor, code: {resultCode}");
+
+            return new FFmpegVideoCompositor(handle, surfaceSize, pixelFormat);
+        }
+
+        /// <summary>
+        /// Should not be called concurrently with composing of frames into the same tile
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void SetTile(int tileIndex, Rectangle tileRectangle)
+        {
+            if (tileIndex < 0 || tileIndex >= MaxTilesCount)
+                throw new ArgumentOutOfRangeException(nameof(tileIndex));
+
+            int resultCode = FFmpegVideoPInvoke.SetVideoCompositorTile(Handle, tileIndex, tileRectangle.X,
+                tileRectangle.Y, tileRectangle.Width, tileRectangle.Height);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting compositor tile, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Returns rectangles of tiles updated since the previous call
+        /// </summary>
+        public Rectangle[] GetDirtyRectangles()
+        {
+            FFmpegVideoPInvoke.GetVideoCompositorDirtyRects(Handle, _dirtyRects, MaxTilesCount, out int rectsCount);
+
+            var rectangles = new Rectangle[rectsCount];
+
+            for (int i = 0; i < rectsCount; i++)
+                rectangles[i] = new Rectangle(_dirtyRects[i * 4], _dirtyRects[i * 4 + 1], _dirtyRects[i * 4 + 2],
+                    _dirtyRects[i * 4 + 3]);
+
+            return rectangles;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoCompositor(Handle);
+            GC.SuppressFinalize(this);
+        }
+
+        private static int GetColorValue(Color color)
+        {
+            return color.R << 16 | color.G << 8 | color.B;
+        }
+    }
+}
@@ -1,6 +1,7 @@
 ﻿using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.Drawing;
 using System.Linq;
 using RtspClientSharp.RawFrames.Video;
 using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
@@ -9,15 +10,32 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
 {
     class FFmpegVideoDecoder
     {
+        private const int DecodeFailedResultCode = -3;
+        private const int DecodeNoFrameResultCode = -4;
+        private const int AcquireLimitResultCode = -2;
+        private const int MaxDirtyRectsCount = 64;
+
         private readonly IntPtr _decoderHandle;
         private readonly FFmpegVideoCodecId _videoCodecId;
 
         private DecodedVideoFrameParameters _currentFrameParameters =
             new DecodedVideoFrameParameters(0, 0, FFmpegPixelFormat.None);
 
+        private readonly object _transformLock = new object();
+
+        private readonly int[] _dirtyRects = new int[MaxDirtyRectsCount * 4];
+
         private readonly Dictionary<TransformParameters, FFmpegDecodedVideoScaler> _scalersMap =
             new Dictionary<TransformParameters, FFmpegDecodedVideoScaler>();
 
+        private readonly Dictionary<TensorParameters, FFmpegVideoTensorConverter> _tensorConvertersMap =
+            new Dictionary<TensorParameters, FFmpegVideoTensorConverter>();
+
+        private readonly List<FFmpegVideoMotionDetector> _motionDetectors = new List<FFmpegVideoMotionDetector>();
+
+        private readonly List<FFmpegVideoStatisticsAnalyzer> _statisticsAnalyzers =
+            new List<FFmpegVideoStatisticsAnalyzer>();
+
         private byte[] _extraData = new byte[0];
         private bool _disposed;
 
@@ -43,84 +61,376 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
             return new FFmpegVideoDecoder(videoCodecId, decoderPtr);
         }
 
-        public unsafe IDecodedVideoFrame TryDecode(RawVideoFrame rawVideoFrame)
+        /// <summary>
+        /// Decoded frame is acquired from the native decoder, its receiver owns it and has to dispose it
+        /// </summary>
+        public unsafe VideoDecodeResult TryDecode(RawVideoFrame rawVideoFrame, out IDecodedVideoFrame decodedFrame)
         {
+            decodedFrame = null;
+
             fixed (byte* rawBufferPtr = &rawVideoFrame.FrameSegment.Array[rawVideoFrame.FrameSegment.Offset])
             {
-                int resultCode;
-
-                if (rawVideoFrame is RawH264IFrame rawH264IFrame)
-                {
-                    if (rawH264IFrame.SpsPpsSegment.Array != null &&
-                        !_extraData.SequenceEqual(rawH264IFrame.SpsPpsSegment))
-                    {
-                        if (_extraData.Length != rawH264IFrame.SpsPpsSegment.Count)
-                            _extraData = new byte[rawH264IFrame.SpsPpsSegment.Count];
-
-                        Buffer.BlockCopy(rawH264IFrame.SpsPpsSegment.Array, rawH264IFrame.SpsPpsSegment.Offset,
-                            _extraData, 0, rawH264IFrame.SpsPpsSegment.Count);
-
-                        fixed (byte* initDataPtr = &_extraData[0])
-                        {
-                            resultCode = FFmpegVideoPInvoke.SetVideoDecoderExtraData(_decoderHandle,
-                                (IntPtr)initDataPtr, _extraData.Length);
+                UpdateExtraData(rawVideoFrame);
 
-                            if (resultCode != 0)
-                                throw new DecoderException(
-                                    $"An error occurred while setting video extra data, {_videoCodecId} codec, code: {resultCode}");
-                        }
-                    }
-                }
-
-                resultCode = FFmpegVideoPInvoke.DecodeFrame(_decoderHandle, (IntPtr)rawBufferPtr,
+                int resultCode = FFmpegVideoPInvoke.DecodeFrame(_decoderHandle, (IntPtr)rawBufferPtr,
                     rawVideoFrame.FrameSegment.Count,
                     out int width, out int height, out FFmpegPixelFormat pixelFormat);
 
                 if (resultCode != 0)
-                    return null;
+                    return VideoDecodeResult.NoFrame;
 
                 if (_currentFrameParameters.Width != width || _currentFrameParameters.Height != height ||
                     _currentFrameParameters.PixelFormat != pixelFormat)
                 {
-                    _currentFrameParameters = new DecodedVideoFrameParameters(width, height, pixelFormat);
-                    DropAllVideoScalers();
+                    lock (_transformLock)
+                    {
+                        _currentFrameParameters = new DecodedVideoFrameParameters(width, height, pixelFormat);
+                        DropAllVideoTransformers();
+                    }
                 }
 
-                return new DecodedVideoFrame(TransformTo);
+                FFmpegVideoPInvoke.GetDecodedVideoFrameErrorFlags(_decoderHandle, out VideoFrameErrorFlags errorFlags);
+
+                resultCode = FFmpegVideoPInvoke.AcquireDecodedVideoFrame(_decoderHandle, out IntPtr frameHandle);
+
+                if (resultCode == AcquireLimitResultCode)
+                    return VideoDecodeResult.AllFramesInUse;
+
+                if (resultCode != 0)
+                    return VideoDecodeResult.NoFrame;
+
+                DecodedVideoFrameParameters frameParameters = _currentFrameParameters;
+
+                decodedFrame = new DecodedVideoFrame(
+                    (buffer, bufferStride, parameters, dirtyRectangles) =>
+                        TransformTo(frameHandle, frameParameters, buffer, bufferStride, parameters, dirtyRectangles),
+                    (tensorBuffer, batchIndex, parameters) =>
+                        TransformToTensor(frameHandle, frameParameters, tensorBuffer, batchIndex, parameters),
+                    () => FFmpegVideoPInvoke.ReleaseAcquiredVideoFrame(frameHandle), errorFlags);
+                return VideoDecodeResult.Decoded;
+            }
+        }
+
+        /// <summary>
+        /// Decodes the frame and scales it into the buffer in a single call, scaler is managed by the native decoder.
+        /// Zero size keeps the size of the decoded frame
+        /// </summary>
+        /// <returns>Parameters of the decoded frame or null if there is no frame, buffer content should be
+        /// discarded then, because band conversion could have partly overwritten it</returns>
+        /// <exception cref="DecoderException"></exception>
+        public unsafe DecodedVideoFrameParameters TryDecodeTo(RawVideoFrame rawVideoFrame, IntPtr buffer,
+            int bufferSize, int bufferStride, Size size, PixelFormat pixelFormat, ScalingQuality scaleQuality)
+        {
+            fixed (byte* rawBufferPtr = &rawVideoFrame.FrameSegment.Array[rawVideoFrame.FrameSegment.Offset])
+            {
+                UpdateExtraData(rawVideoFrame);
+
+                int resultCode = FFmpegVideoPInvoke.DecodeAndScaleVideoFrame(_decoderHandle, (IntPtr)rawBufferPtr,
+                    rawVideoFrame.FrameSegment.Count, size.Width, size.Height,
+                    FFmpegDecodedVideoScaler.GetFFmpegPixelFormat(pixelFormat),
+                    FFmpegDecodedVideoScaler.GetFFmpegScaleQuality(scaleQuality), buffer, bufferSize, bufferStride,
+                    out int width, out int height, out FFmpegPixelFormat framePixelFormat);
+
+                if (resultCode == DecodeNoFrameResultCode || resultCode == DecodeFailedResultCode)
+                    return null;
+
+                if (resultCode != 0)
+                    throw new DecoderException($"An error occurred while decoding and scaling video frame, {_videoCodecId} codec, code: {resultCode}");
+
+                return new DecodedVideoFrameParameters(width, height, framePixelFormat);
             }
         }
 
+        /// <summary>
+        /// Scales the last decoded frame into the compositor tile. Should be called from the decoding thread
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void ComposeTo(FFmpegVideoCompositor compositor, int tileIndex)
+        {
+            if (compositor == null)
+                throw new ArgumentNullException(nameof(compositor));
+
+            int resultCode = FFmpegVideoPInvoke.ComposeDecodedVideoFrame(compositor.Handle, tileIndex, _decoderHandle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while composing video frame, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Drops decoder state and pending pictures, e.g. after a stream discontinuity
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void Flush()
+        {
+            int resultCode = FFmpegVideoPInvoke.FlushVideoDecoder(_decoderHandle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while flushing video decoder, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Allows to keep producing pictures through short losses instead of freezing until the next key frame
+        /// </summary>
+        /// <param name="concealErrors">Damaged blocks are guessed from neighbours and previous pictures</param>
+        /// <param name="outputCorruptFrames">Frames with concealed errors are output</param>
+        /// <param name="outputAllFrames">Frames referencing lost pictures are output without waiting for a key frame</param>
+        /// <exception cref="DecoderException"></exception>
+        public void SetErrorOptions(bool concealErrors, bool outputCorruptFrames, bool outputAllFrames)
+        {
+            int resultCode = FFmpegVideoPInvoke.SetVideoDecoderErrorOptions(_decoderHandle, concealErrors ? 1 : 0,
+                outputCorruptFrames ? 1 : 0, outputAllFrames ? 1 : 0);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting error options, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Makes <see cref="TryDecodeTo"/> convert finished row bands while the rest of the picture is still decoded.
+        /// Pictures the codec can't deliver in bands are converted after decoding as before, so are streams with
+        /// reordered frames. Buffer content is undefined when no frame is decoded
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void SetBandConversion(bool enabled)
+        {
+            int resultCode = FFmpegVideoPInvoke.SetVideoDecoderBandConversion(_decoderHandle, enabled ? 1 : 0);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting band conversion, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Publishes the last decoded frame to the shared memory ring. Should be called from the decoding thread
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void PublishTo(FFmpegVideoFrameRing frameRing, DateTime timestamp)
+        {
+            if (frameRing == null)
+                throw new ArgumentNullException(nameof(frameRing));
+
+            int resultCode = FFmpegVideoPInvoke.PublishDecodedVideoFrame(_decoderHandle, frameRing.Handle,
+                timestamp.Ticks);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while publishing video frame, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Exported motion vectors allow cheap motion analysis without touching pixels,
+        /// skipped loop filter reduces decoding cost when the picture is used for analysis only
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public void SetAnalysisOptions(bool exportMotionVectors, bool skipLoopFilter)
+        {
+            int resultCode = FFmpegVideoPInvoke.SetVideoDecoderAnalysisOptions(_decoderHandle,
+                exportMotionVectors ? 1 : 0, skipLoopFilter ? 1 : 0);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while setting analysis options, {_videoCodecId} codec, code: {resultCode}");
+        }
+
+        /// <summary>
+        /// Reduces motion vectors of the last decoded frame to mean displacement per grid cell.
+        /// Requires exported motion vectors, intra frames have zero energy
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public float GetMotionEnergy(Size gridSize, float[] energyGrid)
+        {
+            if (gridSize.Width <= 0 || gridSize.Height <= 0)
+                throw new ArgumentOutOfRangeException(nameof(gridSize));
+            if (energyGrid == null)
+                throw new ArgumentNullException(nameof(energyGrid));
+            if (energyGrid.Length < gridSize.Width * gridSize.Height)
+                throw new ArgumentException("Energy grid is too small", nameof(energyGrid));
+
+            int resultCode = FFmpegVideoPInvoke.GetDecodedVideoMotionEnergy(_decoderHandle, gridSize.Width,
+                gridSize.Height, energyGrid, out float totalEnergy);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while getting motion energy, {_videoCodecId} codec, code: {resultCode}");
+
+            return totalEnergy;
+        }
+
+        /// <summary>
+        /// Creates motion detector bound to this decoder, it is removed together with the decoder
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public FFmpegVideoMotionDetector CreateMotionDetector(Size gridSize)
+        {
+            FFmpegVideoMotionDetector motionDetector = FFmpegVideoMotionDetector.Create(_decoderHandle, gridSize);
+            _motionDetectors.Add(motionDetector);
+            return motionDetector;
+        }
+
+        /// <summary>
+        /// Creates statistics analyzer bound to this decoder, it is removed together with the decoder
+        /// </summary>
+        /// <exception cref="DecoderException"></exception>
+        public FFmpegVideoStatisticsAnalyzer CreateStatisticsAnalyzer(int subsampling, int interval)
+        {
+            FFmpegVideoStatisticsAnalyzer statisticsAnalyzer =
+                FFmpegVideoStatisticsAnalyzer.Create(_decoderHandle, subsampling, interval);
+            _statisticsAnalyzers.Add(statisticsAnalyzer);
+            return statisticsAnalyzer;
+        }
+
         public void Dispose()
         {
             if (_disposed)
                 return;
 
             _disposed = true;
+
+            foreach (var motionDetector in _motionDetectors)
+                motionDetector.Dispose();
+
+            _motionDetectors.Clear();
+
+            foreach (var statisticsAnalyzer in _statisticsAnalyzers)
+                statisticsAnalyzer.Dispose();
+
+            _statisticsAnalyzers.Clear();
             FFmpegVideoPInvoke.RemoveVideoDecoder(_decoderHandle);
-            DropAllVideoScalers();
+
+            lock (_transformLock)
+                DropAllVideoTransformers();
+
             GC.SuppressFinalize(this);
         }
 
-        private void DropAllVideoScalers()
+        private unsafe void UpdateExtraData(RawVideoFrame rawVideoFrame)
+        {
+            if (!(rawVideoFrame is RawH264IFrame rawH264IFrame))
+                return;
+
+            if (rawH264IFrame.SpsPpsSegment.Array == null || _extraData.SequenceEqual(rawH264IFrame.SpsPpsSegment))
+                return;
+
+            if (_extraData.Length != rawH264IFrame.SpsPpsSegment.Count)
+                _extraData = new byte[rawH264IFrame.SpsPpsSegment.Count];
+
+            Buffer.BlockCopy(rawH264IFrame.SpsPpsSegment.Array, rawH264IFrame.SpsPpsSegment.Offset,
+                _extraData, 0, rawH264IFrame.SpsPpsSegment.Count);
+
+            fixed (byte* initDataPtr = &_extraData[0])
+            {
+                int resultCode = FFmpegVideoPInvoke.SetVideoDecoderExtraData(_decoderHandle,
+                    (IntPtr)initDataPtr, _extraData.Length);
+
+                if (resultCode != 0)
+                    throw new DecoderException(
+                        $"An error occurred while setting video extra data, {_videoCodecId} codec, code: {resultCode}");
+            }
+        }
+
+        private void DropAllVideoTransformers()
         {
             foreach (var scaler in _scalersMap.Values)
                 scaler.Dispose();
 
             _scalersMap.Clear();
+
+            foreach (var tensorConverter in _tensorConvertersMap.Values)
+                tensorConverter.Dispose();
+
+            _tensorConvertersMap.Clear();
         }
 
-        private void TransformTo(IntPtr buffer, int bufferStride, TransformParameters parameters)
+        private void TransformTo(IntPtr frameHandle, DecodedVideoFrameParameters frameParameters, IntPtr buffer,
+            int bufferStride, TransformParameters parameters, IList<Rectangle> dirtyRectangles)
         {
-            if (!_scalersMap.TryGetValue(parameters, out FFmpegDecodedVideoScaler videoScaler))
+            int resultCode = 0;
+
+            lock (_transformLock)
             {
-                videoScaler = FFmpegDecodedVideoScaler.Create(_currentFrameParameters, parameters);
-                _scalersMap.Add(parameters, videoScaler);
-            }
+                if (!frameParameters.Equals(_currentFrameParameters))
+                {
+                    FFmpegDecodedVideoScaler staleFrameScaler = FFmpegDecodedVideoScaler.Create(frameParameters, parameters);
 
-            int resultCode = FFmpegVideoPInvoke.ScaleDecodedVideoFrame(_decoderHandle, videoScaler.Handle, buffer, bufferStride);
+                    try
+                    {
+                        resultCode = FFmpegVideoPInvoke.ScaleAcquiredVideoFrame(frameHandle, staleFrameScaler.Handle,
+                            buffer, bufferStride);
+                    }
+                    finally
+                    {
+                        staleFrameScaler.Dispose();
+                    }
+
+                    // There is no history for a one-off scaler, so the whole buffer is updated
+                    if (dirtyRectangles != null)
+                    {
+                        dirtyRectangles.Clear();
+                        dirtyRectangles.Add(new Rectangle(0, 0, parameters.TargetFrameSize.Width,
+                            parameters.TargetFrameSize.Height));
+                    }
+                }
+                else
+                {
+                    if (!_scalersMap.TryGetValue(parameters, out FFmpegDecodedVideoScaler videoScaler))
+                    {
+                        videoScaler = FFmpegDecodedVideoScaler.Create(_currentFrameParameters, parameters);
+                        _scalersMap.Add(parameters, videoScaler);
+                    }
+
+                    if (dirtyRectangles != null)
+                    {
+                        int dirtyRectsCount =
+                            videoScaler.ScaleAcquiredFrameChanges(frameHandle, buffer, bufferStride, _dirtyRects);
+
+                        dirtyRectangles.Clear();
+
+                        for (int i = 0; i < dirtyRectsCount; i++)
+                            dirtyRectangles.Add(new Rectangle(_dirtyRects[i * 4], _dirtyRects[i * 4 + 1],
+                                _dirtyRects[i * 4 + 2], _dirtyRects[i * 4 + 3]));
+                    }
+                    else
+                        resultCode = FFmpegVideoPInvoke.ScaleAcquiredVideoFrame(frameHandle, videoScaler.Handle, buffer,
+                            bufferStride);
+                }
+            }
 
             if (resultCode != 0)
                 throw new DecoderException($"An error occurred while converting decoding video frame, {_videoCodecId} codec, code: {resultCode}");
         }
+
+        private void TransformToTensor(IntPtr frameHandle, DecodedVideoFrameParameters frameParameters,
+            IntPtr tensorBuffer, int batchIndex, TensorParameters parameters)
+        {
+            int resultCode;
+
+            lock (_transformLock)
+            {
+                if (!frameParameters.Equals(_currentFrameParameters))
+                {
+                    FFmpegVideoTensorConverter staleFrameConverter =
+                        FFmpegVideoTensorConverter.Create(frameParameters, parameters);
+
+                    try
+                    {
+                        resultCode = FFmpegVideoPInvoke.ConvertAcquiredVideoFrameToTensor(frameHandle,
+                            staleFrameConverter.Handle, tensorBuffer, batchIndex);
+                    }
+                    finally
+                    {
+                        staleFrameConverter.Dispose();
+                    }
+                }
+                else
+                {
+                    if (!_tensorConvertersMap.TryGetValue(parameters, out FFmpegVideoTensorConverter tensorConverter))
+                    {
+                        tensorConverter = FFmpegVideoTensorConverter.Create(_currentFrameParameters, parameters);
+                        _tensorConvertersMap.Add(parameters, tensorConverter);
+                    }
+
+                    resultCode = FFmpegVideoPInvoke.ConvertAcquiredVideoFrameToTensor(frameHandle,
+                        tensorConverter.Handle, tensorBuffer, batchIndex);
+                }
+            }
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while converting video frame to tensor, {_videoCodecId} codec, code: {resultCode}");
+        }
     }
 }
\ No newline at end of file
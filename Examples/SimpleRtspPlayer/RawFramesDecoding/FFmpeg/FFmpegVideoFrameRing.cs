@@ -0,0 +1,64 @@
+﻿using System;
+using System.Drawing;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Named shared memory ring of decoded frames for consumers in other processes.
+    /// Readers map the ring by name and never block publishing
+    /// </summary>
+    class FFmpegVideoFrameRing
+    {
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public string Name { get; }
+
+        private FFmpegVideoFrameRing(IntPtr handle, string name)
+        {
+            Handle = handle;
+            Name = name;
+        }
+
+        ~FFmpegVideoFrameRing()
+        {
+            Dispose();
+        }
+
+        /// <param name="name">Name of the shared memory object, should start with a slash on Linux</param>
+        /// <param name="slotsCount">Count of frames kept in the ring, at least 2</param>
+        /// <param name="frameSize">Size every published frame is scaled to</param>
+        /// <param name="pixelFormat">Format every published frame is converted to</param>
+        /// <param name="scaleQuality">Scaling quality</param>
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoFrameRing Create(string name, int slotsCount, Size frameSize, PixelFormat pixelFormat,
+            ScalingQuality scaleQuality)
+        {
+            if (name == null)
+                throw new ArgumentNullException(nameof(name));
+            if (slotsCount < 2)
+                throw new ArgumentOutOfRangeException(nameof(slotsCount));
+            if (frameSize.Width <= 0 || frameSize.Height <= 0)
+                throw new ArgumentOutOfRangeException(nameof(frameSize));
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoFrameRing(name, slotsCount, frameSize.Width,
+                frameSize.Height, FFmpegDecodedVideoScaler.GetFFmpegPixelFormat(pixelFormat),
+                FFmpegDecodedVideoScaler.GetFFmpegScaleQuality(scaleQuality), out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating video frame ring, code: {resultCode}");
+
+            return new FFmpegVideoFrameRing(handle, name);
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoFrameRing(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+﻿using System;
+using System.Drawing;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Block-based motion detector working on luma plane of the last frame decoded by the bound decoder
+    /// </summary>
+    class FFmpegVideoMotionDetector
+    {
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public Size GridSize { get; }
+
+        private FFmpegVideoMotionDetector(IntPtr handle, Size gridSize)
+        {
+            Handle = handle;
+            GridSize = gridSize;
+        }
+
+        ~FFmpegVideoMotionDetector()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoMotionDetector Create(IntPtr decoderHandle, Size gridSize)
+        {
+            if (gridSize.Width <= 0 || gridSize.Height <= 0)
+                throw new ArgumentOutOfRangeException(nameof(gridSize));
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoMotionDetector(decoderHandle, gridSize.Width,
+                gridSize.Height, out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating motion detector, code: {resultCode}");
+
+            return new FFmpegVideoMotionDetector(handle, gridSize);
+        }
+
+        /// <param name="threshold">Minimum difference of block mean luma from background, 0-255</param>
+        /// <param name="learningRate">Background adaptation speed, (0, 1]</param>
+        public void SetSensitivity(int threshold, float learningRate)
+        {
+            if (threshold < 0 || threshold > 255)
+                throw new ArgumentOutOfRangeException(nameof(threshold));
+            if (learningRate <= 0 || learningRate > 1)
+                throw new ArgumentOutOfRangeException(nameof(learningRate));
+
+            FFmpegVideoPInvoke.SetVideoMotionDetectorParameters(Handle, threshold, learningRate);
+        }
+
+        /// <param name="mask">Byte per block, zero excludes the block from detection. Null enables all blocks</param>
+        public void SetMask(byte[] mask)
+        {
+            if (mask != null && mask.Length != GridSize.Width * GridSize.Height)
+                throw new ArgumentException("Mask size should be equal to blocks count", nameof(mask));
+
+            FFmpegVideoPInvoke.SetVideoMotionDetectorMask(Handle, mask);
+        }
+
+        /// <summary>
+        /// Returns the share of active blocks among not masked ones. Should be called from the decoding thread
+        /// </summary>
+        /// <param name="activityMap">Receives 1 for every active block, may be null</param>
+        /// <exception cref="DecoderException"></exception>
+        public float Detect(byte[] activityMap)
+        {
+            if (activityMap != null && activityMap.Length < GridSize.Width * GridSize.Height)
+                throw new ArgumentException("Activity map is too small", nameof(activityMap));
+
+            int resultCode = FFmpegVideoPInvoke.DetectVideoMotion(Handle, activityMap, out float score);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while detecting motion, code: {resultCode}");
+
+            return score;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoMotionDetector(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
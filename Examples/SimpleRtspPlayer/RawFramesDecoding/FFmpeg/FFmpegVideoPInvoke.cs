@@ -22,8 +22,11 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
     enum FFmpegPixelFormat
     {
         None = -1,
+        YUV420P = 0,
+        YUYV422 = 1,
         BGR24 = 3,
         GRAY8 = 8,
+        NV12 = 23,
         BGRA = 28
     }
 
@@ -45,17 +48,199 @@ namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
         public static extern int DecodeFrame(IntPtr handle, IntPtr rawBuffer, int rawBufferLength, out int frameWidth,
             out int frameHeight, out FFmpegPixelFormat framePixelFormat);
 
+        [DllImport(LibraryName, EntryPoint = "flush_video_decoder", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int FlushVideoDecoder(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_decoder_error_options",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoDecoderErrorOptions(IntPtr handle, int concealErrors, int outputCorruptFrames,
+            int outputAllFrames);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_decoder_band_conversion",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoDecoderBandConversion(IntPtr handle, int enabled);
+
+        [DllImport(LibraryName, EntryPoint = "get_decoded_video_frame_error_flags",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetDecodedVideoFrameErrorFlags(IntPtr handle, out VideoFrameErrorFlags errorFlags);
+
+        [DllImport(LibraryName, EntryPoint = "decode_and_scale_video_frame",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int DecodeAndScaleVideoFrame(IntPtr handle, IntPtr rawBuffer, int rawBufferLength,
+            int scaledWidth, int scaledHeight, FFmpegPixelFormat scaledPixelFormat, FFmpegScalingQuality qualityFlags,
+            IntPtr scaledBuffer, int scaledBufferSize, int scaledBufferStride, out int frameWidth,
+            out int frameHeight, out FFmpegPixelFormat framePixelFormat);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_decoder_analysis_options",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoDecoderAnalysisOptions(IntPtr handle, int exportMotionVectors,
+            int skipLoopFilter);
+
         [DllImport(LibraryName, EntryPoint = "scale_decoded_video_frame", CallingConvention = CallingConvention.Cdecl)]
         public static extern int ScaleDecodedVideoFrame(IntPtr handle, IntPtr scalerHandle, IntPtr scaledBuffer,
             int scaledBufferStride);
 
+        [DllImport(LibraryName, EntryPoint = "set_video_decoder_max_acquired_frames",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoDecoderMaxAcquiredFrames(IntPtr handle, int maxAcquiredFrames);
+
+        [DllImport(LibraryName, EntryPoint = "acquire_decoded_video_frame", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AcquireDecodedVideoFrame(IntPtr handle, out IntPtr frameHandle);
+
+        [DllImport(LibraryName, EntryPoint = "scale_acquired_video_frame", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ScaleAcquiredVideoFrame(IntPtr frameHandle, IntPtr scalerHandle, IntPtr scaledBuffer,
+            int scaledBufferStride);
+
+        [DllImport(LibraryName, EntryPoint = "release_acquired_video_frame", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ReleaseAcquiredVideoFrame(IntPtr frameHandle);
+
+        [DllImport(LibraryName, EntryPoint = "scale_decoded_video_frame_planes",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ScaleDecodedVideoFramePlanes(IntPtr handle, IntPtr scalerHandle, IntPtr[] scaledPlanes,
+            int[] scaledPlaneStrides);
+
+        [DllImport(LibraryName, EntryPoint = "scale_acquired_video_frame_planes",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ScaleAcquiredVideoFramePlanes(IntPtr frameHandle, IntPtr scalerHandle,
+            IntPtr[] scaledPlanes, int[] scaledPlaneStrides);
+
         [DllImport(LibraryName, EntryPoint = "create_video_scaler", CallingConvention = CallingConvention.Cdecl)]
         public static extern int CreateVideoScaler(int sourceLeft, int sourceTop, int sourceWidth, int sourceHeight,
             FFmpegPixelFormat sourcePixelFormat,
             int scaledWidth, int scaledHeight, FFmpegPixelFormat scaledPixelFormat, FFmpegScalingQuality qualityFlags,
-            out IntPtr handle);
+            int targetWidth, int targetHeight, RotationAngle rotation, int mirror, int fillColor, out IntPtr handle);
 
         [DllImport(LibraryName, EntryPoint = "remove_video_scaler", CallingConvention = CallingConvention.Cdecl)]
         public static extern void RemoveVideoScaler(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_scaler_change_detection",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoScalerChangeDetection(IntPtr scalerHandle, int tileSize, int threshold,
+            FFmpegScalingQuality qualityFlags);
+
+        [DllImport(LibraryName, EntryPoint = "scale_acquired_video_frame_changes",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ScaleAcquiredVideoFrameChanges(IntPtr frameHandle, IntPtr scalerHandle,
+            IntPtr scaledBuffer, int scaledBufferStride, int[] dirtyRects, int maxDirtyRectsCount,
+            out int dirtyRectsCount);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_tensor_converter",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoTensorConverter(int sourceWidth, int sourceHeight,
+            FFmpegPixelFormat sourcePixelFormat, int tensorWidth, int tensorHeight, TensorDataType tensorDataType,
+            TensorChannelOrder channelOrder, float[] mean, float[] stdDev, int padColor, int letterbox,
+            FFmpegScalingQuality qualityFlags, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "convert_acquired_video_frame_to_tensor",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ConvertAcquiredVideoFrameToTensor(IntPtr frameHandle, IntPtr converterHandle,
+            IntPtr tensorBuffer, int batchIndex);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_tensor_converter",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoTensorConverter(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_compositor", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoCompositor(int width, int height, FFmpegPixelFormat pixelFormat,
+            int fillColor, int borderColor, int borderWidth, int keepAspectRatio, FFmpegScalingQuality qualityFlags,
+            out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_compositor_tile", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoCompositorTile(IntPtr handle, int tileIndex, int left, int top, int width,
+            int height);
+
+        [DllImport(LibraryName, EntryPoint = "compose_decoded_video_frame", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ComposeDecodedVideoFrame(IntPtr compositorHandle, int tileIndex, IntPtr decoderHandle);
+
+        [DllImport(LibraryName, EntryPoint = "compose_acquired_video_frame",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ComposeAcquiredVideoFrame(IntPtr compositorHandle, int tileIndex, IntPtr frameHandle);
+
+        [DllImport(LibraryName, EntryPoint = "get_video_compositor_surface",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetVideoCompositorSurface(IntPtr handle, IntPtr[] planes, int[] strides);
+
+        [DllImport(LibraryName, EntryPoint = "get_video_compositor_dirty_rects",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetVideoCompositorDirtyRects(IntPtr handle, int[] rects, int maxRectsCount,
+            out int rectsCount);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_compositor", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoCompositor(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_frame_ring", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoFrameRing(string name, int slotsCount, int width, int height,
+            FFmpegPixelFormat pixelFormat, FFmpegScalingQuality qualityFlags, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "publish_decoded_video_frame",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int PublishDecodedVideoFrame(IntPtr handle, IntPtr ringHandle, long timestamp);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_frame_ring", CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoFrameRing(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_presentation_ring",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoPresentationRing(int bufferSize, out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "begin_write_video_presentation_ring",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int BeginWriteVideoPresentationRing(IntPtr handle, out IntPtr buffer);
+
+        [DllImport(LibraryName, EntryPoint = "end_write_video_presentation_ring",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int EndWriteVideoPresentationRing(IntPtr handle, long timestamp);
+
+        [DllImport(LibraryName, EntryPoint = "acquire_video_presentation_buffer",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AcquireVideoPresentationBuffer(IntPtr handle, out IntPtr buffer, out long timestamp);
+
+        [DllImport(LibraryName, EntryPoint = "get_video_presentation_ring_statistics",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetVideoPresentationRingStatistics(IntPtr handle, out long writtenFrames,
+            out long droppedFrames);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_presentation_ring",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoPresentationRing(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_motion_detector",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoMotionDetector(IntPtr decoderHandle, int gridWidth, int gridHeight,
+            out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_motion_detector_parameters",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoMotionDetectorParameters(IntPtr handle, int threshold, float learningRate);
+
+        [DllImport(LibraryName, EntryPoint = "set_video_motion_detector_mask",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int SetVideoMotionDetectorMask(IntPtr handle, byte[] mask);
+
+        [DllImport(LibraryName, EntryPoint = "detect_video_motion", CallingConvention = CallingConvention.Cdecl)]
+        public static extern int DetectVideoMotion(IntPtr handle, byte[] activityMap, out float score);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_motion_detector",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoMotionDetector(IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "get_decoded_video_motion_energy",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetDecodedVideoMotionEnergy(IntPtr handle, int gridWidth, int gridHeight,
+            float[] energyGrid, out float totalEnergy);
+
+        [DllImport(LibraryName, EntryPoint = "create_video_statistics_analyzer",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int CreateVideoStatisticsAnalyzer(IntPtr decoderHandle, int subsampling, int interval,
+            out IntPtr handle);
+
+        [DllImport(LibraryName, EntryPoint = "compute_video_frame_statistics",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern int ComputeVideoFrameStatistics(IntPtr handle, int[] histogram, out float mean,
+            out float variance, out float sharpness, out float sceneChange);
+
+        [DllImport(LibraryName, EntryPoint = "remove_video_statistics_analyzer",
+            CallingConvention = CallingConvention.Cdecl)]
+        public static extern void RemoveVideoStatisticsAnalyzer(IntPtr handle);
     }
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+﻿using System;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Three pre-allocated output buffers between a producer and a renderer. The producer always has a free buffer
+    /// to write to, the renderer takes the newest complete one and pictures it didn't take in time are dropped
+    /// </summary>
+    class FFmpegVideoPresentationRing
+    {
+        private const int NoNewBufferResultCode = -2;
+
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+        public int BufferSize { get; }
+
+        public long WrittenFramesCount
+        {
+            get
+            {
+                FFmpegVideoPInvoke.GetVideoPresentationRingStatistics(Handle, out long writtenFrames, out _);
+                return writtenFrames;
+            }
+        }
+
+        public long DroppedFramesCount
+        {
+            get
+            {
+                FFmpegVideoPInvoke.GetVideoPresentationRingStatistics(Handle, out _, out long droppedFrames);
+                return droppedFrames;
+            }
+        }
+
+        private FFmpegVideoPresentationRing(IntPtr handle, int bufferSize)
+        {
+            Handle = handle;
+            BufferSize = bufferSize;
+        }
+
+        ~FFmpegVideoPresentationRing()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoPresentationRing Create(int bufferSize)
+        {
+            if (bufferSize <= 0)
+                throw new ArgumentOutOfRangeException(nameof(bufferSize));
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoPresentationRing(bufferSize, out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating video presentation ring, code: {resultCode}");
+
+            return new FFmpegVideoPresentationRing(handle, bufferSize);
+        }
+
+        /// <summary>
+        /// Returns the buffer to write the next picture to, should be called from the producer thread only
+        /// </summary>
+        public IntPtr BeginWrite()
+        {
+            FFmpegVideoPInvoke.BeginWriteVideoPresentationRing(Handle, out IntPtr buffer);
+            return buffer;
+        }
+
+        /// <summary>
+        /// Makes the written picture the newest one, the previous picture is dropped if the renderer hasn't taken it
+        /// </summary>
+        public void EndWrite(DateTime timestamp)
+        {
+            FFmpegVideoPInvoke.EndWriteVideoPresentationRing(Handle, timestamp.Ticks);
+        }
+
+        /// <summary>
+        /// Takes the newest picture, which stays valid until the next successful call.
+        /// Should be called from the renderer thread only
+        /// </summary>
+        /// <returns>False if nothing was written since the previous call</returns>
+        /// <exception cref="DecoderException"></exception>
+        public bool TryAcquire(out IntPtr buffer, out DateTime timestamp)
+        {
+            int resultCode = FFmpegVideoPInvoke.AcquireVideoPresentationBuffer(Handle, out buffer, out long ticks);
+
+            if (resultCode == NoNewBufferResultCode)
+            {
+                timestamp = default(DateTime);
+                return false;
+            }
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while acquiring presentation buffer, code: {resultCode}");
+
+            timestamp = new DateTime(ticks);
+            return true;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoPresentationRing(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+﻿using System;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    /// <summary>
+    /// Luma statistics of the last frame decoded by the bound decoder
+    /// </summary>
+    class FFmpegVideoStatisticsAnalyzer
+    {
+        private const int FrameSkippedResultCode = -2;
+
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+
+        private FFmpegVideoStatisticsAnalyzer(IntPtr handle)
+        {
+            Handle = handle;
+        }
+
+        ~FFmpegVideoStatisticsAnalyzer()
+        {
+            Dispose();
+        }
+
+        /// <param name="decoderHandle">Handle of the bound decoder</param>
+        /// <param name="subsampling">Only every subsampling-th pixel of every subsampling-th row is analyzed</param>
+        /// <param name="interval">Only every interval-th frame is analyzed</param>
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoStatisticsAnalyzer Create(IntPtr decoderHandle, int subsampling, int interval)
+        {
+            if (subsampling <= 0)
+                throw new ArgumentOutOfRangeException(nameof(subsampling));
+            if (interval <= 0)
+                throw new ArgumentOutOfRangeException(nameof(interval));
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoStatisticsAnalyzer(decoderHandle, subsampling, interval,
+                out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating statistics analyzer, code: {resultCode}");
+
+            return new FFmpegVideoStatisticsAnalyzer(handle);
+        }
+
+        /// <summary>
+        /// Should be called from the decoding thread after every decoded frame
+        /// </summary>
+        /// <returns>False if the frame is skipped due to analysis interval</returns>
+        /// <exception cref="DecoderException"></exception>
+        public bool TryCompute(VideoFrameStatistics statistics)
+        {
+            if (statistics == null)
+                throw new ArgumentNullException(nameof(statistics));
+
+            int resultCode = FFmpegVideoPInvoke.ComputeVideoFrameStatistics(Handle, statistics.Histogram,
+                out float mean, out float variance, out float sharpness, out float sceneChange);
+
+            if (resultCode == FrameSkippedResultCode)
+                return false;
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while computing frame statistics, code: {resultCode}");
+
+            statistics.Mean = mean;
+            statistics.Variance = variance;
+            statistics.Sharpness = sharpness;
+            statistics.SceneChange = sceneChange;
+            return true;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoStatisticsAnalyzer(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+﻿using System;
+
+namespace SimpleRtspPlayer.RawFramesDecoding.FFmpeg
+{
+    class FFmpegVideoTensorConverter
+    {
+        private bool _disposed;
+
+        public IntPtr Handle { get; }
+
+        private FFmpegVideoTensorConverter(IntPtr handle)
+        {
+            Handle = handle;
+        }
+
+        ~FFmpegVideoTensorConverter()
+        {
+            Dispose();
+        }
+
+        /// <exception cref="DecoderException"></exception>
+        public static FFmpegVideoTensorConverter Create(DecodedVideoFrameParameters decodedVideoFrameParameters,
+            TensorParameters tensorParameters)
+        {
+            if (decodedVideoFrameParameters == null)
+                throw new ArgumentNullException(nameof(decodedVideoFrameParameters));
+            if (tensorParameters == null)
+                throw new ArgumentNullException(nameof(tensorParameters));
+
+            int padColor = tensorParameters.PadColor.R << 16 | tensorParameters.PadColor.G << 8 |
+                           tensorParameters.PadColor.B;
+
+            FFmpegScalingQuality scaleQuality =
+                FFmpegDecodedVideoScaler.GetFFmpegScaleQuality(tensorParameters.ScaleQuality);
+
+            int resultCode = FFmpegVideoPInvoke.CreateVideoTensorConverter(decodedVideoFrameParameters.Width,
+                decodedVideoFrameParameters.Height, decodedVideoFrameParameters.PixelFormat,
+                tensorParameters.TensorSize.Width, tensorParameters.TensorSize.Height,
+                tensorParameters.DataType, tensorParameters.ChannelOrder, tensorParameters.Mean,
+                tensorParameters.StdDev, padColor, tensorParameters.Letterbox ? 1 : 0, scaleQuality, out var handle);
+
+            if (resultCode != 0)
+                throw new DecoderException($"An error occurred while creating tensor converter, code: {resultCode}");
+
+            return new FFmpegVideoTensorConverter(handle);
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+
+            _disposed = true;
+            FFmpegVideoPInvoke.RemoveVideoTensorConverter(Handle);
+            GC.SuppressFinalize(this);
+        }
+    }
+}
@@ -0,0 +1,193 @@
+﻿using System;
+using System.Collections.Generic;
+using RtspClientSharp.RawFrames;
+using RtspClientSharp.RawFrames.Video;
+using SimpleRtspPlayer.RawFramesDecoding.DecodedFrames;
+using SimpleRtspPlayer.RawFramesDecoding.FFmpeg;
+
+namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    /// <summary>
+    /// Keeps compressed H264 frames since the last key frame, so a snapshot of the stream is decoded only when
+    /// someone asks for it instead of running a decoder for every frame of every camera
+    /// </summary>
+    class H264GopCache
+    {
+        public const int DefaultMaxGopSize = 16 * 1024 * 1024;
+
+        // Decoder may read a bit past the end of the frame, so every frame is followed by zeroed padding
+        private const int FramePaddingSize = 64;
+        private const int FrameAlignment = 4;
+
+        private readonly int _maxGopSize;
+        private readonly object _lock = new object();
+        private readonly List<CachedFrame> _frames = new List<CachedFrame>();
+        private byte[] _buffer = new byte[0];
+        private int _bufferSize;
+        private CachedFrame _spsPps;
+        private bool _waitingForKeyFrame = true;
+
+        private struct CachedFrame
+        {
+            public readonly DateTime Timestamp;
+            public readonly int Offset;
+            public readonly int Count;
+
+            public CachedFrame(DateTime timestamp, int offset, int count)
+            {
+                Timestamp = timestamp;
+                Offset = offset;
+                Count = count;
+            }
+        }
+
+        /// <param name="maxGopSize">GOPs exceeding this size are dropped until the next key frame</param>
+        public H264GopCache(int maxGopSize = DefaultMaxGopSize)
+        {
+            if (maxGopSize <= 0)
+                throw new ArgumentOutOfRangeException(nameof(maxGopSize));
+
+            _maxGopSize = maxGopSize;
+        }
+
+        public int FramesCount
+        {
+            get
+            {
+                lock (_lock)
+                    return _frames.Count;
+            }
+        }
+
+        /// <summary>
+        /// Copies the frame to the cache, key frame starts a new GOP. Frames of other codecs are ignored
+        /// </summary>
+        public void Add(RawFrame rawFrame)
+        {
+            lock (_lock)
+            {
+                if (rawFrame is RawH264IFrame rawIFrame)
+                {
+                    _frames.Clear();
+                    _bufferSize = 0;
+                    _waitingForKeyFrame = false;
+
+                    _spsPps = Append(rawIFrame.Timestamp, rawIFrame.SpsPpsSegment);
+                }
+                else if (!(rawFrame is RawH264PFrame) || _waitingForKeyFrame)
+                    return;
+
+                if (_bufferSize + rawFrame.FrameSegment.Count > _maxGopSize)
+                {
+                    Clear();
+                    return;
+                }
+
+                _frames.Add(Append(rawFrame.Timestamp, rawFrame.FrameSegment));
+            }
+        }
+
+        public void Clear()
+        {
+            lock (_lock)
+            {
+                _frames.Clear();
+                _bufferSize = 0;
+                _waitingForKeyFrame = true;
+            }
+        }
+
+        /// <summary>
+        /// Decodes the cached GOP and transforms its newest picture into the buffer
+        /// </summary>
+        /// <param name="decoder">Warm decoder to use, it is flushed before decoding. If null, a short-lived decoder is created</param>
+        /// <returns>False if there is no key frame yet or no picture was decoded</returns>
+        /// <exception cref="DecoderException"></exception>
+        public bool TryTakeSnapshot(IntPtr buffer, int bufferStride, TransformParameters transformParameters,
+            FFmpegVideoDecoder decoder = null)
+        {
+            byte[] gopBuffer;
+            CachedFrame[] frames;
+            CachedFrame spsPps;
+
+            // Decoding takes much longer than the copy, so frames keep coming while the snapshot is decoded
+            lock (_lock)
+            {
+                if (_frames.Count == 0)
+                    return false;
+
+                gopBuffer = new byte[_bufferSize];
+                Buffer.BlockCopy(_buffer, 0, gopBuffer, 0, _bufferSize);
+                frames = _frames.ToArray();
+                spsPps = _spsPps;
+            }
+
+            bool ownDecoder = decoder == null;
+
+            if (ownDecoder)
+                decoder = FFmpegVideoDecoder.CreateDecoder(FFmpegVideoCodecId.H264);
+            else
+                decoder.Flush();
+
+            try
+            {
+                IDecodedVideoFrame newestFrame = null;
+
+                try
+                {
+                    for (int i = 0; i < frames.Length; i++)
+                    {
+                        CachedFrame frame = frames[i];
+                        var frameSegment = new ArraySegment<byte>(gopBuffer, frame.Offset, frame.Count);
+
+                        RawVideoFrame rawFrame = i == 0
+                            ? (RawVideoFrame)new RawH264IFrame(frame.Timestamp, frameSegment,
+                                new ArraySegment<byte>(gopBuffer, spsPps.Offset, spsPps.Count))
+                            : new RawH264PFrame(frame.Timestamp, frameSegment);
+
+                        if (decoder.TryDecode(rawFrame, out IDecodedVideoFrame decodedFrame) !=
+                            VideoDecodeResult.Decoded)
+                            continue;
+
+                        newestFrame?.Dispose();
+                        newestFrame = decodedFrame;
+                    }
+
+                    if (newestFrame == null)
+                        return false;
+
+                    newestFrame.TransformTo(buffer, bufferStride, transformParameters);
+                    return true;
+                }
+                finally
+                {
+                    newestFrame?.Dispose();
+                }
+            }
+            finally
+            {
+                if (ownDecoder)
+                    decoder.Dispose();
+            }
+        }
+
+        private CachedFrame Append(DateTime timestamp, ArraySegment<byte> segment)
+        {
+            int offset = (_bufferSize + FrameAlignment - 1) / FrameAlignment * FrameAlignment;
+            int requiredSize = offset + segment.Count + FramePaddingSize;
+
+            if (requiredSize > _buffer.Length)
+            {
+                var buffer = new byte[Math.Max(requiredSize, _buffer.Length * 2)];
+                Buffer.BlockCopy(_buffer, 0, buffer, 0, _bufferSize);
+                _buffer = buffer;
+            }
+
+            Buffer.BlockCopy(segment.Array, segment.Offset, _buffer, offset, segment.Count);
+            Array.Clear(_buffer, offset + segment.Count, FramePaddingSize);
+
+            _bufferSize = offset + segment.Count + FramePaddingSize;
+            return new CachedFrame(timestamp, offset, segment.Count);
+        }
+    }
+}
@@ -5,5 +5,8 @@
         Grayscale,
         Bgr24,
         Bgra32,
+        I420,
+        Nv12,
+        Yuy2,
     }
 }
\ No newline at end of file
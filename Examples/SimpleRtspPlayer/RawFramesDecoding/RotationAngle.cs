@@ -0,0 +1,10 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public enum RotationAngle
+    {
+        Rotate0 = 0,
+        Rotate90 = 90,
+        Rotate180 = 180,
+        Rotate270 = 270
+    }
+}
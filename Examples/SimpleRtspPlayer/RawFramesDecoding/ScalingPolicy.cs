@@ -4,6 +4,7 @@
     {
         Auto,
         Stretch,
-        RespectAspectRatio
+        RespectAspectRatio,
+        Letterbox
     }
 }
\ No newline at end of file
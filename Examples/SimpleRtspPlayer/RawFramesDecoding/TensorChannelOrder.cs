@@ -0,0 +1,8 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public enum TensorChannelOrder
+    {
+        Rgb,
+        Bgr
+    }
+}
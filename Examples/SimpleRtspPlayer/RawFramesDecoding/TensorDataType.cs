@@ -0,0 +1,8 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public enum TensorDataType
+    {
+        Float32,
+        Float16
+    }
+}
@@ -0,0 +1,88 @@
+﻿using System;
+using System.Drawing;
+using System.Linq;
+
+namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    /// <summary>
+    /// Describes planar CHW tensor produced from decoded frame: (pixel / 255 - mean) / std per channel.
+    /// Frames of a batch are stored one after another, so N frames fill one NCHW buffer
+    /// </summary>
+    public class TensorParameters
+    {
+        private const int ChannelsCount = 3;
+
+        public Size TensorSize { get; }
+
+        public TensorDataType DataType { get; }
+
+        public TensorChannelOrder ChannelOrder { get; }
+
+        public float[] Mean { get; }
+
+        public float[] StdDev { get; }
+
+        public bool Letterbox { get; }
+
+        public Color PadColor { get; }
+
+        public ScalingQuality ScaleQuality { get; }
+
+        public int TensorSizeInBytes =>
+            ChannelsCount * TensorSize.Width * TensorSize.Height * (DataType == TensorDataType.Float16 ? 2 : 4);
+
+        public TensorParameters(Size tensorSize, TensorDataType dataType, TensorChannelOrder channelOrder,
+            float[] mean, float[] stdDev, bool letterbox, Color padColor, ScalingQuality scaleQuality)
+        {
+            if (tensorSize.Width <= 0 || tensorSize.Height <= 0)
+                throw new ArgumentOutOfRangeException(nameof(tensorSize));
+            if (mean == null)
+                throw new ArgumentNullException(nameof(mean));
+            if (mean.Length != ChannelsCount)
+                throw new ArgumentException($"Mean should be specified for {ChannelsCount} channels", nameof(mean));
+            if (stdDev == null)
+                throw new ArgumentNullException(nameof(stdDev));
+            if (stdDev.Length != ChannelsCount)
+                throw new ArgumentException($"Std should be specified for {ChannelsCount} channels", nameof(stdDev));
+
+            TensorSize = tensorSize;
+            DataType = dataType;
+            ChannelOrder = channelOrder;
+            Mean = mean;
+            StdDev = stdDev;
+            Letterbox = letterbox;
+            PadColor = padColor;
+            ScaleQuality = scaleQuality;
+        }
+
+        protected bool Equals(TensorParameters other)
+        {
+            return TensorSize.Equals(other.TensorSize) && DataType == other.DataType &&
+                   ChannelOrder == other.ChannelOrder && Mean.SequenceEqual(other.Mean) &&
+                   StdDev.SequenceEqual(other.StdDev) && Letterbox == other.Letterbox &&
+                   PadColor.ToArgb() == other.PadColor.ToArgb() && ScaleQuality == other.ScaleQuality;
+        }
+
+        public override bool Equals(object obj)
+        {
+            if (ReferenceEquals(null, obj)) return false;
+            if (ReferenceEquals(this, obj)) return true;
+            if (obj.GetType() != GetType()) return false;
+            return Equals((TensorParameters) obj);
+        }
+
+        public override int GetHashCode()
+        {
+            unchecked
+            {
+                var hashCode = TensorSize.GetHashCode();
+                hashCode = (hashCode * 397) ^ (int) DataType;
+                hashCode = (hashCode * 397) ^ (int) ChannelOrder;
+                hashCode = (hashCode * 397) ^ Letterbox.GetHashCode();
+                hashCode = (hashCode * 397) ^ PadColor.ToArgb();
+                hashCode = (hashCode * 397) ^ (int) ScaleQuality;
+                return hashCode;
+            }
+        }
+    }
+}
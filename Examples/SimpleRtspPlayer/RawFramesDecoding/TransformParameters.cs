@@ -14,21 +14,48 @@ namespace SimpleRtspPlayer.RawFramesDecoding
 
         public ScalingQuality ScaleQuality { get; }
 
+        /// <summary>
+        /// Clockwise rotation applied after region of interest is cut
+        /// </summary>
+        public RotationAngle Rotation { get; }
+
+        /// <summary>
+        /// Horizontal flip applied after rotation
+        /// </summary>
+        public bool Mirror { get; }
+
+        /// <summary>
+        /// Color of the borders when frame is letterboxed
+        /// </summary>
+        public Color FillColor { get; }
+
         public TransformParameters(RectangleF regionOfInterest, Size targetFrameSize, ScalingPolicy scalePolicy,
             PixelFormat targetFormat, ScalingQuality scaleQuality)
+            : this(regionOfInterest, targetFrameSize, scalePolicy, targetFormat, scaleQuality, RotationAngle.Rotate0,
+                false, Color.Black)
+        {
+        }
+
+        public TransformParameters(RectangleF regionOfInterest, Size targetFrameSize, ScalingPolicy scalePolicy,
+            PixelFormat targetFormat, ScalingQuality scaleQuality, RotationAngle rotation, bool mirror, Color fillColor)
         {
             RegionOfInterest = regionOfInterest;
             TargetFrameSize = targetFrameSize;
             TargetFormat = targetFormat;
             ScaleQuality = scaleQuality;
             ScalePolicy = scalePolicy;
+            Rotation = rotation;
+            Mirror = mirror;
+            FillColor = fillColor;
         }
 
         protected bool Equals(TransformParameters other)
         {
             return RegionOfInterest.Equals(other.RegionOfInterest) &&
-                   TargetFrameSize.Equals(other.TargetFrameSize) &&
-                   TargetFormat == other.TargetFormat && ScaleQuality == other.ScaleQuality;
+                   TargetFrameSize.Equals(other.TargetFrameSize) && ScalePolicy == other.ScalePolicy &&
+                   TargetFormat == other.TargetFormat && ScaleQuality == other.ScaleQuality &&
+                   Rotation == other.Rotation && Mirror == other.Mirror &&
+                   FillColor.ToArgb() == other.FillColor.ToArgb();
         }
 
         public override bool Equals(object obj)
@@ -47,6 +74,10 @@ namespace SimpleRtspPlayer.RawFramesDecoding
                 hashCode = (hashCode * 397) ^ TargetFrameSize.GetHashCode();
                 hashCode = (hashCode * 397) ^ (int) TargetFormat;
                 hashCode = (hashCode * 397) ^ (int) ScaleQuality;
+                hashCode = (hashCode * 397) ^ (int) ScalePolicy;
+                hashCode = (hashCode * 397) ^ (int) Rotation;
+                hashCode = (hashCode * 397) ^ Mirror.GetHashCode();
+                hashCode = (hashCode * 397) ^ FillColor.ToArgb();
                 return hashCode;
             }
         }
@@ -0,0 +1,12 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public enum VideoDecodeResult
+    {
+        Decoded,
+        NoFrame,
+        /// <summary>
+        /// Frame is decoded, but dropped because all acquired frames are still not disposed by their owners
+        /// </summary>
+        AllFramesInUse
+    }
+}
\ No newline at end of file
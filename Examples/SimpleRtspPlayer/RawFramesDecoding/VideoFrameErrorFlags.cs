@@ -0,0 +1,13 @@
+﻿using System;
+
+namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    [Flags]
+    public enum VideoFrameErrorFlags
+    {
+        None = 0,
+        Corrupt = 1,
+        InvalidBitstream = 2,
+        MissingReference = 4
+    }
+}
@@ -0,0 +1,26 @@
+﻿namespace SimpleRtspPlayer.RawFramesDecoding
+{
+    public class VideoFrameStatistics
+    {
+        public const int HistogramSize = 256;
+
+        /// <summary>
+        /// Luma histogram of sampled pixels
+        /// </summary>
+        public int[] Histogram { get; } = new int[HistogramSize];
+
+        public float Mean { get; internal set; }
+
+        public float Variance { get; internal set; }
+
+        /// <summary>
+        /// Variance of Laplacian, drops when the picture is defocused or covered
+        /// </summary>
+        public float Sharpness { get; internal set; }
+
+        /// <summary>
+        /// Histogram difference from the previous analyzed frame, 0 - same, 1 - completely different
+        /// </summary>
+        public float SceneChange { get; internal set; }
+    }
+}
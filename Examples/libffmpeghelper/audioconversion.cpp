@@ -0,0 +1,260 @@
+#include "stdafx.h"
+#include "audioconversion.h"
+
+#include <emmintrin.h>
+
+// NaN is silence, the rest is clipped to [-1, 1] before scaling, so the result never depends on
+// whether a sample is converted by the vector body or by the scalar tail
+static __m128 clip_samples(__m128 samples)
+{
+	const __m128 ordered = _mm_and_ps(samples, _mm_cmpord_ps(samples, samples));
+
+	return _mm_max_ps(_mm_min_ps(ordered, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+}
+
+// Same scale and clipping as swresample uses for float to 16 bit conversion
+static int16_t float_sample_to_s16(float sample)
+{
+	const int scaled = _mm_cvtss_si32(_mm_mul_ss(clip_samples(_mm_set_ss(sample)), _mm_set_ss(32768.0f)));
+
+	return static_cast<int16_t>(FFMIN(scaled, 32767));
+}
+
+static float s16_sample_to_float(int16_t sample)
+{
+	return sample * (1.0f / 32768.0f);
+}
+
+// Converts 4 + 4 floats to 8 shorts, 1.0 scaled to 32768 is saturated by packs
+static __m128i floats_to_s16(__m128 low, __m128 high)
+{
+	const __m128 scale = _mm_set1_ps(32768.0f);
+
+	return _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(clip_samples(low), scale)),
+		_mm_cvtps_epi32(_mm_mul_ps(clip_samples(high), scale)));
+}
+
+// Sign extends 8 shorts into two vectors of 4 floats
+static void s16_to_floats(__m128i samples, __m128 *low, __m128 *high)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+
+	*low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), scale);
+	*high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), scale);
+}
+
+static void convert_float_to_s16(const float *source, int16_t *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), floats_to_s16(_mm_loadu_ps(source + i), _mm_loadu_ps(source + i + 4)));
+
+	for (; i < count; i++)
+		destination[i] = float_sample_to_s16(source[i]);
+}
+
+static void convert_s16_to_float(const int16_t *source, float *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 low, high;
+
+		s16_to_floats(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i)), &low, &high);
+		_mm_storeu_ps(destination + i, low);
+		_mm_storeu_ps(destination + i + 4, high);
+	}
+
+	for (; i < count; i++)
+		destination[i] = s16_sample_to_float(source[i]);
+}
+
+static void interleave_stereo_float(const float *left, const float *right, float *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 l = _mm_loadu_ps(left + i);
+		const __m128 r = _mm_loadu_ps(right + i);
+
+		_mm_storeu_ps(destination + 2 * i, _mm_unpacklo_ps(l, r));
+		_mm_storeu_ps(destination + 2 * i + 4, _mm_unpackhi_ps(l, r));
+	}
+
+	for (; i < count; i++)
+	{
+		destination[2 * i] = left[i];
+		destination[2 * i + 1] = right[i];
+	}
+}
+
+static void interleave_stereo_float_to_s16(const float *left, const float *right, int16_t *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 l = _mm_loadu_ps(left + i);
+		const __m128 r = _mm_loadu_ps(right + i);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + 2 * i), floats_to_s16(_mm_unpacklo_ps(l, r), _mm_unpackhi_ps(l, r)));
+	}
+
+	for (; i < count; i++)
+	{
+		destination[2 * i] = float_sample_to_s16(left[i]);
+		destination[2 * i + 1] = float_sample_to_s16(right[i]);
+	}
+}
+
+static void interleave_stereo_s16(const int16_t *left, const int16_t *right, int16_t *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(left + i));
+		const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(right + i));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + 2 * i), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+	}
+
+	for (; i < count; i++)
+	{
+		destination[2 * i] = left[i];
+		destination[2 * i + 1] = right[i];
+	}
+}
+
+static void interleave_stereo_s16_to_float(const int16_t *left, const int16_t *right, float *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i l = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(left + i));
+		const __m128i r = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(right + i));
+		__m128 low, high;
+
+		s16_to_floats(_mm_unpacklo_epi16(l, r), &low, &high);
+		_mm_storeu_ps(destination + 2 * i, low);
+		_mm_storeu_ps(destination + 2 * i + 4, high);
+	}
+
+	for (; i < count; i++)
+	{
+		destination[2 * i] = s16_sample_to_float(left[i]);
+		destination[2 * i + 1] = s16_sample_to_float(right[i]);
+	}
+}
+
+template <typename TSource, typename TDestination, typename TConvert>
+static void interleave_channel(const TSource *source, TDestination *destination, int channels, int count, TConvert convert)
+{
+	for (int i = 0; i < count; i++, destination += channels)
+		*destination = convert(source[i]);
+}
+
+template <typename TSource, typename TDestination, typename TConvert>
+static void interleave_channels(const AVFrame *frame, TDestination *destination, TConvert convert)
+{
+	for (int channel = 0; channel < frame->channels; channel++)
+		interleave_channel(reinterpret_cast<const TSource *>(frame->extended_data[channel]), destination + channel,
+			frame->channels, frame->nb_samples, convert);
+}
+
+// Output sample format AV_SAMPLE_FMT_NONE keeps samples as they are, planar ones are just interleaved
+int get_interleaved_audio_size(const AVFrame *frame, AVSampleFormat outSampleFormat)
+{
+	if (outSampleFormat == AV_SAMPLE_FMT_NONE)
+		outSampleFormat = av_get_packed_sample_fmt(static_cast<AVSampleFormat>(frame->format));
+
+	return av_samples_get_buffer_size(nullptr, frame->channels, frame->nb_samples, outSampleFormat, 1);
+}
+
+// Interleaves planar channels and converts 16 bit and float samples to 16 bit or float ones, stereo and
+// contiguous samples go through SIMD kernels. Returns -1 for formats swresample should be used for
+int interleave_audio_samples(const AVFrame *frame, AVSampleFormat outSampleFormat, uint8_t *outBuffer)
+{
+	const auto sampleFormat = static_cast<AVSampleFormat>(frame->format);
+	const AVSampleFormat packedFormat = av_get_packed_sample_fmt(sampleFormat);
+	const bool planar = av_sample_fmt_is_planar(sampleFormat) && frame->channels > 1;
+
+	if (outSampleFormat == AV_SAMPLE_FMT_NONE)
+		outSampleFormat = packedFormat;
+
+	if (!planar && outSampleFormat == packedFormat)
+	{
+		memcpy(outBuffer, frame->extended_data[0], get_interleaved_audio_size(frame, outSampleFormat));
+		return 0;
+	}
+
+	if ((packedFormat != AV_SAMPLE_FMT_S16 && packedFormat != AV_SAMPLE_FMT_FLT) ||
+		(outSampleFormat != AV_SAMPLE_FMT_S16 && outSampleFormat != AV_SAMPLE_FMT_FLT))
+	{
+		if (!planar || outSampleFormat != packedFormat)
+			return -1;
+
+		// Other formats are only interleaved
+		const int sampleSize = av_get_bytes_per_sample(sampleFormat);
+		const int step = sampleSize * frame->channels;
+
+		for (int channel = 0; channel < frame->channels; channel++)
+		{
+			const uint8_t *source = frame->extended_data[channel];
+			uint8_t *destination = outBuffer + channel * sampleSize;
+
+			for (int i = 0; i < frame->nb_samples; i++, source += sampleSize, destination += step)
+				memcpy(destination, source, sampleSize);
+		}
+
+		return 0;
+	}
+
+	const auto s16Output = reinterpret_cast<int16_t *>(outBuffer);
+	const auto floatOutput = reinterpret_cast<float *>(outBuffer);
+
+	if (!planar)
+	{
+		const int count = frame->nb_samples * frame->channels;
+
+		if (packedFormat == AV_SAMPLE_FMT_FLT)
+			convert_float_to_s16(reinterpret_cast<const float *>(frame->extended_data[0]), s16Output, count);
+		else
+			convert_s16_to_float(reinterpret_cast<const int16_t *>(frame->extended_data[0]), floatOutput, count);
+
+		return 0;
+	}
+
+	if (frame->channels == 2)
+	{
+		const uint8_t *left = frame->extended_data[0];
+		const uint8_t *right = frame->extended_data[1];
+
+		if (packedFormat == AV_SAMPLE_FMT_FLT && outSampleFormat == AV_SAMPLE_FMT_FLT)
+			interleave_stereo_float(reinterpret_cast<const float *>(left), reinterpret_cast<const float *>(right), floatOutput, frame->nb_samples);
+		else if (packedFormat == AV_SAMPLE_FMT_FLT)
+			interleave_stereo_float_to_s16(reinterpret_cast<const float *>(left), reinterpret_cast<const float *>(right), s16Output, frame->nb_samples);
+		else if (outSampleFormat == AV_SAMPLE_FMT_S16)
+			interleave_stereo_s16(reinterpret_cast<const int16_t *>(left), reinterpret_cast<const int16_t *>(right), s16Output, frame->nb_samples);
+		else
+			interleave_stereo_s16_to_float(reinterpret_cast<const int16_t *>(left), reinterpret_cast<const int16_t *>(right), floatOutput, frame->nb_samples);
+
+		return 0;
+	}
+
+	if (packedFormat == AV_SAMPLE_FMT_FLT && outSampleFormat == AV_SAMPLE_FMT_FLT)
+		interleave_channels<float>(frame, floatOutput, [](float sample) { return sample; });
+	else if (packedFormat == AV_SAMPLE_FMT_FLT)
+		interleave_channels<float>(frame, s16Output, float_sample_to_s16);
+	else if (outSampleFormat == AV_SAMPLE_FMT_S16)
+		interleave_channels<int16_t>(frame, s16Output, [](int16_t sample) { return sample; });
+	else
+		interleave_channels<int16_t>(frame, floatOutput, s16_sample_to_float);
+
+	return 0;
+}
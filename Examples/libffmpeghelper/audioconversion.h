@@ -0,0 +1,4 @@
+#pragma once
+
+int get_interleaved_audio_size(const AVFrame *frame, AVSampleFormat outSampleFormat);
+int interleave_audio_samples(const AVFrame *frame, AVSampleFormat outSampleFormat, uint8_t *outBuffer);
@@ -1,12 +1,15 @@
 #include "stdafx.h"
+#include "audiodecoding.h"
+#include "audioconversion.h"
 
-struct AudioDecoderContext
-{
-	AVCodec *codec;
-	AVCodecContext *av_codec_context;
-	AVPacket av_raw_packet;
-	AVFrame *frame;
-};
+// Drift compensation is spread over this many seconds of output, so even a few ppm are whole samples
+#define DRIFT_COMPENSATION_SECONDS 10
+// Weight of a new fill level in its average, fill swings with every frame and only its trend is the drift
+#define DRIFT_FILL_SMOOTHING 32
+
+#define DEFAULT_ACTIVITY_MIN_LEVEL_DB -50.0f
+#define DEFAULT_ACTIVITY_MARGIN_DB 12.0f
+#define DEFAULT_ACTIVITY_HANGOVER_MS 300
 
 struct AudioResamplerContext
 {
@@ -17,6 +20,8 @@ struct AudioResamplerContext
 	int out_sample_rate;
 	int out_channels;
 	AVSampleFormat out_sample_format;
+	double fill_level;
+	int has_fill_level;
 };
 
 int create_audio_decoder(int codec_id, int bits_per_coded_sample, void **handle)
@@ -29,14 +34,20 @@ int create_audio_decoder(int codec_id, int bits_per_coded_sample, void **handle)
 	if (!context)
 		return -2;
 
-	context->codec = avcodec_find_decoder(static_cast<AVCodecID>(codec_id));
+	const bool speech = init_speech_decoder(&context->speech_decoder, static_cast<AVCodecID>(codec_id), bits_per_coded_sample) == 0;
 
-	if (!context->codec)
+	if (!speech)
 	{
-		remove_audio_decoder(context);
-		return -3;
+		context->codec = avcodec_find_decoder(static_cast<AVCodecID>(codec_id));
+
+		if (!context->codec)
+		{
+			remove_audio_decoder(context);
+			return -3;
+		}
 	}
 
+	// Speech codecs keep the context unopened, it only describes the format of their frames
 	context->av_codec_context = avcodec_alloc_context3(context->codec);
 	if (!context->av_codec_context)
 	{
@@ -51,20 +62,39 @@ int create_audio_decoder(int codec_id, int bits_per_coded_sample, void **handle)
 	}
 
 	context->av_codec_context->bits_per_coded_sample = bits_per_coded_sample;
-	if (avcodec_open2(context->av_codec_context, context->codec, nullptr) < 0)
+
+	if (speech)
+	{
+		context->av_codec_context->sample_rate = 8000;
+		context->av_codec_context->channels = 1;
+		context->av_codec_context->channel_layout = AV_CH_LAYOUT_MONO;
+		context->av_codec_context->sample_fmt = AV_SAMPLE_FMT_S16;
+	}
+	else if (avcodec_open2(context->av_codec_context, context->codec, nullptr) < 0)
 	{
 		remove_audio_decoder(context);
 		return -5;
 	}
 
 	context->frame = av_frame_alloc();
-	if (!context->frame)
+	context->received_frame = av_frame_alloc();
+	if (!context->frame || !context->received_frame)
 	{
 		remove_audio_decoder(context);
 		return -6;
 	}
 
+	if (speech)
+	{
+		context->frame->format = AV_SAMPLE_FMT_S16;
+		context->frame->sample_rate = 8000;
+		context->frame->channels = 1;
+		context->frame->channel_layout = AV_CH_LAYOUT_MONO;
+	}
+
 	av_init_packet(&context->av_raw_packet);
+	init_audio_activity_detector(&context->activity_detector, DEFAULT_ACTIVITY_MIN_LEVEL_DB, DEFAULT_ACTIVITY_MARGIN_DB,
+		DEFAULT_ACTIVITY_HANGOVER_MS);
 
 	*handle = context;
 	return 0;
@@ -79,6 +109,9 @@ int set_audio_decoder_extradata(void *handle, void *extradata, int extradataLeng
 
 	auto context = static_cast<AudioDecoderContext *>(handle);
 
+	if (context->speech_decoder.codec_id != AV_CODEC_ID_NONE)
+		return 0;
+
 	if (!context->av_codec_context->extradata || context->av_codec_context->extradata_size < extradataLength)
 	{
 		av_free(context->av_codec_context->extradata);
@@ -100,6 +133,58 @@ int set_audio_decoder_extradata(void *handle, void *extradata, int extradataLeng
 	return 0;
 }
 
+static int send_audio_packet(AudioDecoderContext *context, void *rawBuffer, int rawBufferLength)
+{
+	context->av_raw_packet.data = static_cast<uint8_t *>(rawBuffer);
+	context->av_raw_packet.size = rawBufferLength;
+
+	int result = avcodec_send_packet(context->av_codec_context, &context->av_raw_packet);
+
+	// Frames of the previous packet nobody has taken are dropped, so the decoder accepts the new one
+	if (result == AVERROR(EAGAIN))
+	{
+		while (avcodec_receive_frame(context->av_codec_context, context->frame) == 0)
+			;
+
+		result = avcodec_send_packet(context->av_codec_context, &context->av_raw_packet);
+	}
+
+	return result < 0 ? -3 : 0;
+}
+
+// Speech samples are kept in the buffer of the decoder and the frame just points to them
+static int prepare_speech_frame(AudioDecoderContext *context, int samples_count)
+{
+	av_fast_malloc(&context->speech_samples, &context->speech_samples_size, FFMAX(samples_count, 1) * sizeof(int16_t));
+
+	if (!context->speech_samples)
+		return -4;
+
+	context->frame->data[0] = context->speech_samples;
+	context->frame->extended_data = context->frame->data;
+	context->frame->linesize[0] = samples_count * static_cast<int>(sizeof(int16_t));
+	context->frame->nb_samples = samples_count;
+	return 0;
+}
+
+static int decode_speech_frame(AudioDecoderContext *context, const uint8_t *rawBuffer, int rawBufferLength)
+{
+	const int result = prepare_speech_frame(context, get_speech_samples_count(&context->speech_decoder, rawBufferLength));
+
+	if (result != 0)
+		return result;
+
+	decode_speech(&context->speech_decoder, rawBuffer, rawBufferLength, reinterpret_cast<int16_t *>(context->speech_samples));
+	return 0;
+}
+
+static void get_audio_format(AudioDecoderContext *context, int *sampleRate, int *bitsPerSample, int *channels)
+{
+	*sampleRate = context->av_codec_context->sample_rate;
+	*bitsPerSample = av_get_bytes_per_sample(context->av_codec_context->sample_fmt) * 8;
+	*channels = context->av_codec_context->channels;
+}
+
 int decode_audio_frame(void *handle, void *rawBuffer, int rawBufferLength, int *sampleRate, int *bitsPerSample, int *channels)
 {
 #if _DEBUG
@@ -112,26 +197,131 @@ int decode_audio_frame(void *handle, void *rawBuffer, int rawBufferLength, int *
 
 	auto context = static_cast<AudioDecoderContext *>(handle);
 
-	context->av_raw_packet.data = static_cast<uint8_t *>(rawBuffer);
-	context->av_raw_packet.size = rawBufferLength;
+	if (context->speech_decoder.codec_id != AV_CODEC_ID_NONE)
+	{
+		const int result = decode_speech_frame(context, static_cast<uint8_t *>(rawBuffer), rawBufferLength);
 
-	int got_frame;
+		if (result != 0)
+			return result;
 
-	const int len = avcodec_decode_audio4(context->av_codec_context, context->frame, &got_frame, &context->av_raw_packet);
+		get_audio_format(context, sampleRate, bitsPerSample, channels);
+		return 0;
+	}
 
-	if (len != rawBufferLength)
-		return -3;
+	const int result = send_audio_packet(context, rawBuffer, rawBufferLength);
 
-	if (got_frame)
-	{
-		*sampleRate = context->av_codec_context->sample_rate;
-		*bitsPerSample = av_get_bytes_per_sample(context->av_codec_context->sample_fmt) * 8;
-		*channels = context->av_codec_context->channels;
+	if (result != 0)
+		return result;
+
+	if (avcodec_receive_frame(context->av_codec_context, context->frame) != 0)
+		return -4;
 
+	get_audio_format(context, sampleRate, bitsPerSample, channels);
+	return 0;
+}
+
+static int append_decoded_frame(AudioDecoderContext *context, AVSampleFormat outSampleFormat, uint8_t *out, int outBufferSize,
+	int *outSize, int *required)
+{
+	const int frameSize = get_interleaved_audio_size(context->frame, outSampleFormat);
+
+	*required += frameSize;
+
+	if (*outSize + frameSize > outBufferSize)
 		return 0;
+
+	if (interleave_audio_samples(context->frame, outSampleFormat, out + *outSize) != 0)
+		return -6;
+
+	*outSize += frameSize;
+	return 0;
+}
+
+// Decodes several access units stored in one buffer, like AUs of a single RTP packet, and writes all
+// samples interleaved one after another. Samples of AU i start at outOffsets[i] and end at outOffsets[i + 1].
+// If the output buffer is too small, decoding goes on to keep the decoder state, frames that don't fit
+// are dropped, -5 is returned and requiredSize tells the size needed for the whole batch.
+// Samples are converted to outSampleFormat, which is AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_FLT or AV_SAMPLE_FMT_NONE to keep them as is.
+// The last decoded AU stays the decoded frame, like after decode_audio_frame
+int decode_audio_frames(void *handle, void *rawBuffer, const int *frameOffsets, const int *frameLengths, int framesCount,
+	int outSampleFormat, void *outBuffer, int outBufferSize, int *outOffsets, int *requiredSize, int *sampleRate, int *bitsPerSample,
+	int *channels)
+{
+#if _DEBUG
+	if (!handle || !rawBuffer || !frameOffsets || !frameLengths || framesCount <= 0 || !outBuffer || !outOffsets ||
+		!requiredSize || !sampleRate || !bitsPerSample || !channels)
+		return -1;
+#endif
+
+	const auto out_sample_format = static_cast<AVSampleFormat>(outSampleFormat);
+
+	auto context = static_cast<AudioDecoderContext *>(handle);
+	const auto out = static_cast<uint8_t *>(outBuffer);
+	int outSize = 0;
+	int required = 0;
+	// Output offset of the last AU if it was decoded straight into the output buffer
+	int directFrameOffset = -1;
+
+	const bool directSpeechOutput = context->speech_decoder.codec_id != AV_CODEC_ID_NONE &&
+		(out_sample_format == AV_SAMPLE_FMT_NONE || out_sample_format == AV_SAMPLE_FMT_S16);
+
+	for (int i = 0; i < framesCount; i++)
+	{
+		outOffsets[i] = outSize;
+
+		const uint8_t *raw = static_cast<uint8_t *>(rawBuffer) + frameOffsets[i];
+		int result;
+
+		if (context->speech_decoder.codec_id != AV_CODEC_ID_NONE)
+		{
+			const int frameSize = get_speech_samples_count(&context->speech_decoder, frameLengths[i]) * static_cast<int>(sizeof(int16_t));
+
+			directFrameOffset = -1;
+
+			// 16 bit samples don't need the frame, they are decoded straight into the output buffer
+			if (directSpeechOutput && outSize + frameSize <= outBufferSize)
+			{
+				decode_speech(&context->speech_decoder, raw, frameLengths[i], reinterpret_cast<int16_t *>(out + outSize));
+
+				directFrameOffset = outSize;
+				required += frameSize;
+				outSize += frameSize;
+			}
+			else if (decode_speech_frame(context, raw, frameLengths[i]) == 0 &&
+				(result = append_decoded_frame(context, out_sample_format, out, outBufferSize, &outSize, &required)) != 0)
+				return result;
+
+			continue;
+		}
+
+		// Broken AU just produces no samples, the rest of the batch is still decoded
+		if (send_audio_packet(context, const_cast<uint8_t *>(raw), frameLengths[i]) != 0)
+			continue;
+
+		while (avcodec_receive_frame(context->av_codec_context, context->received_frame) == 0)
+		{
+			av_frame_unref(context->frame);
+			av_frame_move_ref(context->frame, context->received_frame);
+
+			if ((result = append_decoded_frame(context, out_sample_format, out, outBufferSize, &outSize, &required)) != 0)
+				return result;
+		}
 	}
 
-	return -4;
+	outOffsets[framesCount] = outSize;
+	*requiredSize = required;
+
+	if (directFrameOffset >= 0)
+	{
+		const int frameSize = outSize - directFrameOffset;
+
+		if (prepare_speech_frame(context, frameSize / static_cast<int>(sizeof(int16_t))) == 0)
+			memcpy(context->speech_samples, out + directFrameOffset, frameSize);
+	}
+
+	get_audio_format(context, sampleRate, bitsPerSample, channels);
+
+	return required > outSize ? -5 : 0;
 }
 
 int get_decoded_audio_frame(void *handle, void **outBuffer, int *outDataSize)
@@ -142,9 +332,90 @@ int get_decoded_audio_frame(void *handle, void **outBuffer, int *outDataSize)
 #endif
 
 	auto context = static_cast<AudioDecoderContext *>(handle);
+	const AVFrame *frame = context->frame;
+
+	if (frame->nb_samples <= 0 || !frame->extended_data)
+		return -3;
+
+	const int dataSize = get_interleaved_audio_size(frame, AV_SAMPLE_FMT_NONE);
+
+	if (!av_sample_fmt_is_planar(static_cast<AVSampleFormat>(frame->format)) || frame->channels == 1)
+	{
+		*reinterpret_cast<uint8_t **>(outBuffer) = frame->extended_data[0];
+		*outDataSize = dataSize;
+		return 0;
+	}
+
+	// Data of planar frame is just the first channel, so channels are interleaved like the size implies
+	av_fast_malloc(&context->interleaved_data, &context->interleaved_data_size, dataSize);
+
+	if (!context->interleaved_data)
+		return -2;
+
+	interleave_audio_samples(frame, AV_SAMPLE_FMT_NONE, context->interleaved_data);
+
+	*reinterpret_cast<uint8_t **>(outBuffer) = context->interleaved_data;
+	*outDataSize = dataSize;
+	return 0;
+}
+
+// Interleaves and converts the last decoded frame into the caller buffer without swresample.
+// Returns -2 with the required size if the buffer is too small and -3 if the sample format needs swresample
+int get_decoded_audio_frame_interleaved(void *handle, int outSampleFormat, void *outBuffer, int outBufferSize, int *outDataSize)
+{
+#if _DEBUG
+	if (!handle || !outDataSize)
+		return -1;
+
+	if (outSampleFormat != AV_SAMPLE_FMT_NONE && outSampleFormat != AV_SAMPLE_FMT_S16 && outSampleFormat != AV_SAMPLE_FMT_FLT)
+		return -1;
+#endif
+
+	const auto context = static_cast<AudioDecoderContext *>(handle);
+	const auto out_sample_format = static_cast<AVSampleFormat>(outSampleFormat);
+
+	*outDataSize = get_interleaved_audio_size(context->frame, out_sample_format);
+
+	if (!outBuffer || *outDataSize > outBufferSize)
+		return -2;
+
+	if (interleave_audio_samples(context->frame, out_sample_format, static_cast<uint8_t *>(outBuffer)) != 0)
+		return -3;
+
+	return 0;
+}
+
+// Levels of the last decoded frame are measured natively, so muted or quiet streams don't need their samples
+// fetched at all. Should be called once per decoded frame since it also advances activity detection.
+// Levels of up to channelsCapacity channels are written, channels gets the count of channels of the frame
+int get_decoded_audio_frame_levels(void *handle, float *rms, float *peak, int channelsCapacity, int *channels, int *isActive)
+{
+#if _DEBUG
+	if (!handle || !rms || !peak || channelsCapacity <= 0 || !channels || !isActive)
+		return -1;
+#endif
+
+	const auto context = static_cast<AudioDecoderContext *>(handle);
+	const AVFrame *frame = context->frame;
+
+	if (measure_audio_levels(frame, rms, peak, channelsCapacity) < 0)
+		return -2;
 
-	*reinterpret_cast<uint8_t **>(outBuffer) = context->frame->data[0];
-	*outDataSize = av_samples_get_buffer_size(nullptr, context->av_codec_context->channels, context->frame->nb_samples, context->av_codec_context->sample_fmt, 1);;
+	*channels = frame->channels;
+	*isActive = detect_audio_activity(&context->activity_detector, frame, rms, FFMIN(frame->channels, channelsCapacity));
+	return 0;
+}
+
+int set_audio_activity_detection(void *handle, float minLevelDb, float marginDb, int hangoverMs)
+{
+#if _DEBUG
+	if (!handle || marginDb < 0 || hangoverMs < 0)
+		return -1;
+#endif
+
+	const auto context = static_cast<AudioDecoderContext *>(handle);
+
+	init_audio_activity_detector(&context->activity_detector, minLevelDb, marginDb, hangoverMs);
 	return 0;
 }
 
@@ -162,6 +433,9 @@ void remove_audio_decoder(void *handle)
 	}
 
 	av_frame_free(&context->frame);
+	av_frame_free(&context->received_frame);
+	av_free(context->interleaved_data);
+	av_free(context->speech_samples);
 	av_free(context);
 }
 
@@ -248,9 +522,12 @@ int resample_decoded_audio_frame(void *decoderHandle, void *resamplerHandle, voi
 	const auto decoder_context = static_cast<AudioDecoderContext *>(decoderHandle);
 	const auto resampler_context = static_cast<AudioResamplerContext *>(resamplerHandle);
 
-	const int out_nb_samples = static_cast<int>(av_rescale_rnd(swr_get_delay(resampler_context->swr_context, decoder_context->frame->sample_rate) +
-	                                                           decoder_context->frame->nb_samples, resampler_context->out_sample_rate,
-	                                                           decoder_context->frame->sample_rate, AV_ROUND_UP));
+	// Unlike rescaled delay, this accounts for samples added by drift compensation
+	const int out_nb_samples = swr_get_out_samples(resampler_context->swr_context, decoder_context->frame->nb_samples);
+
+	if (out_nb_samples < 0)
+		return -2;
+
 	if (out_nb_samples > resampler_context->out_nb_samples)
 	{
 		if (resampler_context->out_data)
@@ -277,6 +554,56 @@ int resample_decoded_audio_frame(void *decoderHandle, void *resamplerHandle, voi
 }
 
 
+// Output gets sampleDelta more samples, or fewer if it is negative, over every compensationDistance output samples
+int set_audio_resampler_compensation(void *handle, int sampleDelta, int compensationDistance)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	const auto resampler_context = static_cast<AudioResamplerContext *>(handle);
+
+	if (swr_set_compensation(resampler_context->swr_context, sampleDelta, compensationDistance) < 0)
+		return -2;
+
+	return 0;
+}
+
+// Keeps the playout buffer fed by the resampler at the target fill level, so the difference between the sender
+// and sound card clocks doesn't make latency grow or the buffer underrun. Should be called for every converted
+// frame with the fill level in output samples, maxCorrection limits the speed change in parts per million
+int adjust_audio_resampler_drift(void *handle, int bufferedSamples, int targetSamples, int maxCorrection, int *sampleDelta)
+{
+#if _DEBUG
+	if (!handle || !sampleDelta || maxCorrection < 0)
+		return -1;
+#endif
+
+	const auto resampler_context = static_cast<AudioResamplerContext *>(handle);
+
+	if (!resampler_context->has_fill_level)
+	{
+		resampler_context->fill_level = bufferedSamples;
+		resampler_context->has_fill_level = 1;
+	}
+	else
+		resampler_context->fill_level += (bufferedSamples - resampler_context->fill_level) / DRIFT_FILL_SMOOTHING;
+
+	const int compensation_distance = resampler_context->out_sample_rate * DRIFT_COMPENSATION_SECONDS;
+	const double max_delta = static_cast<double>(compensation_distance) * maxCorrection / 1000000;
+
+	// Whole excess or shortage is corrected over the compensation distance unless that is faster than allowed
+	const double delta = av_clipd(targetSamples - resampler_context->fill_level, -max_delta, max_delta);
+
+	*sampleDelta = static_cast<int>(lrint(delta));
+
+	if (swr_set_compensation(resampler_context->swr_context, *sampleDelta, compensation_distance) < 0)
+		return -2;
+
+	return 0;
+}
+
 void remove_audio_resampler(void *handle)
 {
 	if (!handle)
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "audiometering.h"
+#include "speechdecoding.h"
+
+struct AudioDecoderContext
+{
+	AVCodec *codec;
+	AVCodecContext *av_codec_context;
+	AVPacket av_raw_packet;
+	AVFrame *frame;
+	// Frames of a batch are received here, so a failed receive at its end keeps the last one in frame
+	AVFrame *received_frame;
+	// Planar samples of get_decoded_audio_frame are interleaved here
+	uint8_t *interleaved_data;
+	unsigned int interleaved_data_size;
+	AudioActivityDetector activity_detector;
+	// Codec id is AV_CODEC_ID_NONE unless avcodec is bypassed
+	SpeechDecoder speech_decoder;
+	uint8_t *speech_samples;
+	unsigned int speech_samples_size;
+};
@@ -0,0 +1,365 @@
+#include "stdafx.h"
+
+#define G711_QUANT_MASK 0x0F
+#define G711_SEG_SHIFT 4
+#define G711_ULAW_BIAS 0x84
+#define G711_ULAW_CLIP 8159
+
+// A-law keeps 13 and mu-law 14 most significant bits of a sample, so both are encoded by a single lookup
+#define G711_ALAW_TABLE_SIZE (1 << 13)
+#define G711_ULAW_TABLE_SIZE (1 << 14)
+
+struct G711EncodingTables
+{
+	uint8_t alaw[G711_ALAW_TABLE_SIZE];
+	uint8_t ulaw[G711_ULAW_TABLE_SIZE];
+};
+
+// Talkback is encoded frame by frame as soon as a frame of samples is collected, nothing is queued on top of
+// that: G.711 frames are as short as the caller asks (20 ms is usual), AAC ones are always 1024 samples
+struct AudioEncoderContext
+{
+	AVCodecID codec_id;
+	int channels;
+	int frame_size;
+	AVCodec *codec;
+	AVCodecContext *av_codec_context;
+	AVFrame *frame;
+	AVPacket av_packet;
+	SwrContext *swr_context;
+	// Interleaved 16 bit samples of the frame being collected
+	int16_t *pending_samples;
+	int pending_count;
+	uint8_t *encoded_data;
+};
+
+static const int16_t alaw_segment_ends[8] = { 0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF };
+static const int16_t ulaw_segment_ends[8] = { 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF };
+
+static int find_g711_segment(int value, const int16_t *segmentEnds)
+{
+	int segment = 0;
+
+	while (segment < 8 && value > segmentEnds[segment])
+		segment++;
+
+	return segment;
+}
+
+// linear2alaw and linear2ulaw of the public domain Sun Microsystems g711.c, with its segment tables and bias.
+// Inverse of the expansion in speechdecoding.cpp
+static uint8_t s16_to_alaw(int sample)
+{
+	sample >>= 3;
+
+	int mask = 0xD5;
+
+	if (sample < 0)
+	{
+		mask = 0x55;
+		sample = -sample - 1;
+	}
+
+	const int segment = find_g711_segment(sample, alaw_segment_ends);
+
+	if (segment >= 8)
+		return static_cast<uint8_t>(0x7F ^ mask);
+
+	int value = segment << G711_SEG_SHIFT;
+	value |= (sample >> (segment < 2 ? 1 : segment)) & G711_QUANT_MASK;
+
+	return static_cast<uint8_t>(value ^ mask);
+}
+
+static uint8_t s16_to_ulaw(int sample)
+{
+	sample >>= 2;
+
+	int mask = 0xFF;
+
+	if (sample < 0)
+	{
+		mask = 0x7F;
+		sample = -sample;
+	}
+
+	if (sample > G711_ULAW_CLIP)
+		sample = G711_ULAW_CLIP;
+
+	sample += G711_ULAW_BIAS >> 2;
+
+	const int segment = find_g711_segment(sample, ulaw_segment_ends);
+
+	if (segment >= 8)
+		return static_cast<uint8_t>(0x7F ^ mask);
+
+	const int value = (segment << G711_SEG_SHIFT) | ((sample >> (segment + 1)) & G711_QUANT_MASK);
+
+	return static_cast<uint8_t>(value ^ mask);
+}
+
+static G711EncodingTables create_g711_encoding_tables()
+{
+	G711EncodingTables tables;
+
+	for (int i = 0; i < G711_ALAW_TABLE_SIZE; i++)
+		tables.alaw[i] = s16_to_alaw(static_cast<int16_t>(i << 3));
+
+	for (int i = 0; i < G711_ULAW_TABLE_SIZE; i++)
+		tables.ulaw[i] = s16_to_ulaw(static_cast<int16_t>(i << 2));
+
+	return tables;
+}
+
+static const G711EncodingTables &get_g711_encoding_tables()
+{
+	static const G711EncodingTables tables = create_g711_encoding_tables();
+	return tables;
+}
+
+static void encode_g711(const int16_t *samples, int samplesCount, uint8_t *encoded, const uint8_t *table, int shift)
+{
+	int i = 0;
+
+	for (; i + 4 <= samplesCount; i += 4)
+	{
+		encoded[i] = table[static_cast<uint16_t>(samples[i]) >> shift];
+		encoded[i + 1] = table[static_cast<uint16_t>(samples[i + 1]) >> shift];
+		encoded[i + 2] = table[static_cast<uint16_t>(samples[i + 2]) >> shift];
+		encoded[i + 3] = table[static_cast<uint16_t>(samples[i + 3]) >> shift];
+	}
+
+	for (; i < samplesCount; i++)
+		encoded[i] = table[static_cast<uint16_t>(samples[i]) >> shift];
+}
+
+static int open_av_audio_encoder(AudioEncoderContext *context, int sampleRate, int bitRate)
+{
+	context->codec = avcodec_find_encoder(context->codec_id);
+
+	if (!context->codec)
+		return -3;
+
+	context->av_codec_context = avcodec_alloc_context3(context->codec);
+
+	if (!context->av_codec_context)
+		return -4;
+
+	AVSampleFormat sample_format = AV_SAMPLE_FMT_S16;
+
+	if (context->codec->sample_fmts)
+		sample_format = context->codec->sample_fmts[0];
+
+	context->av_codec_context->sample_fmt = sample_format;
+	context->av_codec_context->sample_rate = sampleRate;
+	context->av_codec_context->channels = context->channels;
+	context->av_codec_context->channel_layout = av_get_default_channel_layout(context->channels);
+	context->av_codec_context->bit_rate = bitRate;
+	context->av_codec_context->time_base = { 1, sampleRate };
+
+	if (avcodec_open2(context->av_codec_context, context->codec, nullptr) < 0)
+		return -5;
+
+	context->frame_size = context->av_codec_context->frame_size;
+
+	context->frame = av_frame_alloc();
+
+	if (!context->frame)
+		return -6;
+
+	context->frame->format = sample_format;
+	context->frame->sample_rate = sampleRate;
+	context->frame->channels = context->channels;
+	context->frame->channel_layout = context->av_codec_context->channel_layout;
+	context->frame->nb_samples = context->frame_size;
+	context->frame->pts = 0;
+
+	if (av_frame_get_buffer(context->frame, 0) < 0)
+		return -6;
+
+	if (sample_format != AV_SAMPLE_FMT_S16)
+	{
+		context->swr_context = swr_alloc_set_opts(nullptr, context->frame->channel_layout, sample_format, sampleRate,
+			context->frame->channel_layout, AV_SAMPLE_FMT_S16, sampleRate, 0, nullptr);
+
+		if (!context->swr_context || swr_init(context->swr_context) < 0)
+			return -7;
+	}
+
+	return 0;
+}
+
+int create_audio_encoder(int codec_id, int sampleRate, int channels, int bitRate, int frameSize, void **handle)
+{
+	if (!handle)
+		return -1;
+
+#if _DEBUG
+	if (sampleRate <= 0 || channels <= 0 || channels > AV_NUM_DATA_POINTERS)
+		return -1;
+#endif
+
+	auto context = static_cast<AudioEncoderContext *>(av_mallocz(sizeof(AudioEncoderContext)));
+
+	if (!context)
+		return -2;
+
+	context->codec_id = static_cast<AVCodecID>(codec_id);
+	context->channels = channels;
+
+	if (codec_id == AV_CODEC_ID_PCM_ALAW || codec_id == AV_CODEC_ID_PCM_MULAW)
+	{
+		if (frameSize <= 0)
+		{
+			remove_audio_encoder(context);
+			return -1;
+		}
+
+		context->frame_size = frameSize;
+		get_g711_encoding_tables();
+	}
+	else
+	{
+		const int result = open_av_audio_encoder(context, sampleRate, bitRate);
+
+		if (result != 0)
+		{
+			remove_audio_encoder(context);
+			return result;
+		}
+	}
+
+	av_init_packet(&context->av_packet);
+
+	context->pending_samples = static_cast<int16_t *>(av_malloc(context->frame_size * channels * sizeof(int16_t)));
+
+	// G.711 has a byte per sample, avcodec encoders return frames in their own packets
+	if (!context->av_codec_context)
+		context->encoded_data = static_cast<uint8_t *>(av_malloc(context->frame_size * channels));
+
+	if (!context->pending_samples || (!context->av_codec_context && !context->encoded_data))
+	{
+		remove_audio_encoder(context);
+		return -2;
+	}
+
+	*handle = context;
+	return 0;
+}
+
+static int encode_pending_frame(AudioEncoderContext *context, void **outBuffer, int *outDataSize)
+{
+	const int samples_count = context->frame_size * context->channels;
+
+	if (context->codec_id == AV_CODEC_ID_PCM_ALAW)
+	{
+		encode_g711(context->pending_samples, samples_count, context->encoded_data, get_g711_encoding_tables().alaw, 3);
+		*outBuffer = context->encoded_data;
+		*outDataSize = samples_count;
+		return 0;
+	}
+
+	if (context->codec_id == AV_CODEC_ID_PCM_MULAW)
+	{
+		encode_g711(context->pending_samples, samples_count, context->encoded_data, get_g711_encoding_tables().ulaw, 2);
+		*outBuffer = context->encoded_data;
+		*outDataSize = samples_count;
+		return 0;
+	}
+
+	if (av_frame_make_writable(context->frame) < 0)
+		return -2;
+
+	if (context->swr_context)
+	{
+		auto in_data = reinterpret_cast<const uint8_t *>(context->pending_samples);
+
+		if (swr_convert(context->swr_context, context->frame->data, context->frame_size, &in_data, context->frame_size) < 0)
+			return -3;
+	}
+	else
+		memcpy(context->frame->data[0], context->pending_samples, samples_count * sizeof(int16_t));
+
+	if (avcodec_send_frame(context->av_codec_context, context->frame) < 0)
+		return -4;
+
+	context->frame->pts += context->frame_size;
+
+	// Encoder delays the first frames, nothing is returned until its lookahead is filled
+	const int result = avcodec_receive_packet(context->av_codec_context, &context->av_packet);
+
+	if (result == AVERROR(EAGAIN))
+		return 0;
+
+	if (result < 0)
+		return -5;
+
+	*outBuffer = context->av_packet.data;
+	*outDataSize = context->av_packet.size;
+	return 0;
+}
+
+// Takes interleaved 16 bit samples until one frame is encoded or all of them are consumed. Encoded frame is
+// valid until the next call, outDataSize is 0 when there is nothing to send yet
+int encode_audio_samples(void *handle, const void *samples, int samplesCount, int *consumedCount, void **outBuffer,
+	int *outDataSize)
+{
+#if _DEBUG
+	if (!handle || (!samples && samplesCount != 0) || samplesCount < 0 || !consumedCount || !outBuffer || !outDataSize)
+		return -1;
+#endif
+
+	auto context = static_cast<AudioEncoderContext *>(handle);
+
+	*consumedCount = 0;
+	*outBuffer = nullptr;
+	*outDataSize = 0;
+
+	av_packet_unref(&context->av_packet);
+
+	const int count = FFMIN(samplesCount, context->frame_size - context->pending_count);
+
+	memcpy(context->pending_samples + context->pending_count * context->channels, samples,
+		count * context->channels * sizeof(int16_t));
+
+	context->pending_count += count;
+	*consumedCount = count;
+
+	if (context->pending_count < context->frame_size)
+		return 0;
+
+	context->pending_count = 0;
+	return encode_pending_frame(context, outBuffer, outDataSize);
+}
+
+int get_audio_encoder_frame_size(void *handle, int *frameSize)
+{
+#if _DEBUG
+	if (!handle || !frameSize)
+		return -1;
+#endif
+
+	*frameSize = static_cast<AudioEncoderContext *>(handle)->frame_size;
+	return 0;
+}
+
+void remove_audio_encoder(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<AudioEncoderContext *>(handle);
+
+	if (context->av_codec_context)
+	{
+		avcodec_close(context->av_codec_context);
+		av_free(context->av_codec_context);
+	}
+
+	av_packet_unref(&context->av_packet);
+	av_frame_free(&context->frame);
+	swr_free(&context->swr_context);
+	av_free(context->pending_samples);
+	av_free(context->encoded_data);
+	av_free(context);
+}
@@ -0,0 +1,303 @@
+#include "stdafx.h"
+
+#include <chrono>
+
+// Timestamps are in 100 ns units, like DateTime ticks of the managed side
+#define TIMESTAMP_UNITS_PER_SECOND 10000000
+// Weight of a new transit time difference in the jitter estimate, as in RFC 3550
+#define JITTER_SMOOTHING 16
+// Target latency covers this many mean jitters on top of a single frame
+#define JITTER_MULTIPLIER 4
+
+// Single producer, single consumer ring of samples: push is called by the receiving thread and pull by the
+// audio device callback, neither of them blocks. Producer owns write_position and the jitter estimate,
+// consumer owns read_position and decides when to wait for prebuffering or to drop samples over the target
+struct AudioJitterBufferContext
+{
+	uint8_t *samples;
+	int capacity;
+	int sample_size;
+	int sample_rate;
+	int min_latency;
+	int max_latency;
+	std::atomic<int64_t> write_position;
+	std::atomic<int64_t> read_position;
+	std::atomic<int> target_latency;
+	// Producer state
+	bool has_previous_frame;
+	int64_t previous_timestamp;
+	int64_t previous_arrival;
+	int64_t expected_timestamp;
+	double jitter;
+	std::atomic<int64_t> late_samples;
+	std::atomic<int64_t> overflow_samples;
+	// Consumer state
+	bool prebuffering;
+	std::atomic<int64_t> underruns;
+	std::atomic<int64_t> dropped_samples;
+};
+
+static int64_t get_arrival_time()
+{
+	return std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, TIMESTAMP_UNITS_PER_SECOND>>>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t samples_to_timestamp(AudioJitterBufferContext *context, int64_t samplesCount)
+{
+	return samplesCount * TIMESTAMP_UNITS_PER_SECOND / context->sample_rate;
+}
+
+static int64_t timestamp_to_samples(AudioJitterBufferContext *context, int64_t timestamp)
+{
+	return timestamp * context->sample_rate / TIMESTAMP_UNITS_PER_SECOND;
+}
+
+// Copies samples to the ring wrapping around its end, source null writes silence
+static void write_ring(AudioJitterBufferContext *context, int64_t position, const uint8_t *source, int samplesCount)
+{
+	while (samplesCount > 0)
+	{
+		const int index = static_cast<int>(position % context->capacity);
+		const int count = FFMIN(samplesCount, context->capacity - index);
+		uint8_t *destination = context->samples + static_cast<ptrdiff_t>(index) * context->sample_size;
+
+		if (source)
+		{
+			memcpy(destination, source, static_cast<size_t>(count) * context->sample_size);
+			source += static_cast<ptrdiff_t>(count) * context->sample_size;
+		}
+		else
+			memset(destination, 0, static_cast<size_t>(count) * context->sample_size);
+
+		position += count;
+		samplesCount -= count;
+	}
+}
+
+static void read_ring(AudioJitterBufferContext *context, int64_t position, uint8_t *destination, int samplesCount)
+{
+	while (samplesCount > 0)
+	{
+		const int index = static_cast<int>(position % context->capacity);
+		const int count = FFMIN(samplesCount, context->capacity - index);
+
+		memcpy(destination, context->samples + static_cast<ptrdiff_t>(index) * context->sample_size,
+			static_cast<size_t>(count) * context->sample_size);
+
+		destination += static_cast<ptrdiff_t>(count) * context->sample_size;
+		position += count;
+		samplesCount -= count;
+	}
+}
+
+// Latencies are in milliseconds, sampleSize is size of a sample of all channels in bytes
+int create_audio_jitter_buffer(int sampleRate, int sampleSize, int minLatency, int maxLatency, void **handle)
+{
+	if (!handle || sampleRate <= 0 || sampleSize <= 0 || minLatency < 0 || maxLatency <= 0 || minLatency > maxLatency)
+		return -1;
+
+	auto context = static_cast<AudioJitterBufferContext *>(av_mallocz(sizeof(AudioJitterBufferContext)));
+
+	if (!context)
+		return -2;
+
+	context->sample_rate = sampleRate;
+	context->sample_size = sampleSize;
+	context->min_latency = static_cast<int>(static_cast<int64_t>(minLatency) * sampleRate / 1000);
+	context->max_latency = static_cast<int>(static_cast<int64_t>(maxLatency) * sampleRate / 1000);
+	// Room for a burst of the same size on top of the maximum latency
+	context->capacity = FFMAX(2 * context->max_latency, 1);
+	context->write_position = 0;
+	context->read_position = 0;
+	context->target_latency = context->min_latency;
+	context->late_samples = 0;
+	context->overflow_samples = 0;
+	context->prebuffering = true;
+	context->underruns = 0;
+	context->dropped_samples = 0;
+
+	context->samples = static_cast<uint8_t *>(av_malloc(static_cast<size_t>(context->capacity) * sampleSize));
+
+	if (!context->samples)
+	{
+		remove_audio_jitter_buffer(context);
+		return -2;
+	}
+
+	*handle = context;
+	return 0;
+}
+
+// Called by the producer for every decoded frame. Gaps in timestamps are filled with silence,
+// so lost packets don't shift the following audio, frames older than already buffered audio are dropped.
+// Frames are appended back to back when timestamps repeat or lag by about a frame, e.g. all AUs of
+// a multi-AU RTP packet share the packet timestamp. Jumps over the maximum latency in either direction
+// (camera clock reset, timestamp wrap, stream restart) start a new timeline after buffered audio
+int push_audio_jitter_buffer(void *handle, void *samples, int samplesCount, int64_t timestamp)
+{
+#if _DEBUG
+	if (!handle || !samples || samplesCount <= 0)
+		return -1;
+#endif
+
+	auto context = static_cast<AudioJitterBufferContext *>(handle);
+	const int64_t arrival = get_arrival_time();
+	const int64_t frameDuration = samples_to_timestamp(context, samplesCount);
+
+	if (context->has_previous_frame)
+	{
+		const int64_t maxGap = samples_to_timestamp(context, context->max_latency);
+		const int64_t gap = timestamp - context->expected_timestamp;
+
+		if (gap > maxGap || gap < -maxGap)
+			context->has_previous_frame = false;
+	}
+
+	if (context->has_previous_frame)
+	{
+		// Difference of transit times of two frames, which is zero for evenly paced arrivals
+		const double difference = static_cast<double>((arrival - context->previous_arrival) - (timestamp - context->previous_timestamp));
+
+		context->jitter += (FFABS(difference) - context->jitter) / JITTER_SMOOTHING;
+
+		const int64_t target = timestamp_to_samples(context, static_cast<int64_t>(JITTER_MULTIPLIER * context->jitter)) + samplesCount;
+		context->target_latency.store(static_cast<int>(av_clip64(target, context->min_latency, context->max_latency)),
+			std::memory_order_relaxed);
+
+		// Less than half a frame is just timestamp rounding
+		const int64_t gap = timestamp - context->expected_timestamp;
+		const bool isRepeatedTimestamp = FFABS(timestamp - context->previous_timestamp) <= frameDuration / 2;
+
+		if (gap < -frameDuration - frameDuration / 2 && !isRepeatedTimestamp)
+		{
+			context->late_samples.fetch_add(samplesCount, std::memory_order_relaxed);
+			return -2;
+		}
+
+		if (gap > frameDuration / 2)
+		{
+			const int silence = static_cast<int>(FFMIN(timestamp_to_samples(context, gap), context->max_latency));
+			const int64_t position = context->write_position.load(std::memory_order_relaxed);
+
+			if (position + silence - context->read_position.load(std::memory_order_acquire) <= context->capacity)
+			{
+				write_ring(context, position, nullptr, silence);
+				context->write_position.store(position + silence, std::memory_order_release);
+			}
+		}
+
+		// Lagging frames are appended after the expected one instead, rounding errors don't accumulate otherwise
+		if (gap >= -frameDuration / 2)
+			context->expected_timestamp = timestamp;
+	}
+	else
+		context->expected_timestamp = timestamp;
+
+	context->has_previous_frame = true;
+	context->previous_timestamp = timestamp;
+	context->previous_arrival = arrival;
+	context->expected_timestamp += frameDuration;
+
+	const int64_t position = context->write_position.load(std::memory_order_relaxed);
+
+	// Consumer has stopped pulling, the newest samples are dropped rather than overwriting ones it may read
+	if (position + samplesCount - context->read_position.load(std::memory_order_acquire) > context->capacity)
+	{
+		context->overflow_samples.fetch_add(samplesCount, std::memory_order_relaxed);
+		return -3;
+	}
+
+	write_ring(context, position, static_cast<uint8_t *>(samples), samplesCount);
+	context->write_position.store(position + samplesCount, std::memory_order_release);
+	return 0;
+}
+
+// Called by the audio device callback, always fills the whole buffer, with silence while prebuffering
+// or after an underrun. playedCount receives the count of real samples at the beginning of the buffer
+int pull_audio_jitter_buffer(void *handle, void *outBuffer, int samplesCount, int *playedCount)
+{
+#if _DEBUG
+	if (!handle || !outBuffer || samplesCount < 0 || !playedCount)
+		return -1;
+#endif
+
+	auto context = static_cast<AudioJitterBufferContext *>(handle);
+	const auto out = static_cast<uint8_t *>(outBuffer);
+
+	int64_t position = context->read_position.load(std::memory_order_relaxed);
+	const int64_t buffered = context->write_position.load(std::memory_order_acquire) - position;
+	const int target = context->target_latency.load(std::memory_order_relaxed);
+
+	*playedCount = 0;
+
+	if (context->prebuffering)
+	{
+		if (buffered < target || buffered == 0)
+		{
+			memset(out, 0, static_cast<size_t>(samplesCount) * context->sample_size);
+			return 0;
+		}
+
+		context->prebuffering = false;
+	}
+
+	int64_t available = buffered;
+
+	// Latency grown by a burst is brought back to the target, small excess is left for the jitter to eat
+	if (available > 2 * static_cast<int64_t>(target) + samplesCount)
+	{
+		const int64_t dropped = available - target;
+
+		position += dropped;
+		available = target;
+		context->dropped_samples.fetch_add(dropped, std::memory_order_relaxed);
+	}
+
+	const int count = static_cast<int>(FFMIN(available, samplesCount));
+
+	read_ring(context, position, out, count);
+	context->read_position.store(position + count, std::memory_order_release);
+
+	if (count < samplesCount)
+	{
+		memset(out + static_cast<ptrdiff_t>(count) * context->sample_size, 0,
+			static_cast<size_t>(samplesCount - count) * context->sample_size);
+
+		context->underruns.fetch_add(1, std::memory_order_relaxed);
+		context->prebuffering = true;
+	}
+
+	*playedCount = count;
+	return 0;
+}
+
+int get_audio_jitter_buffer_state(void *handle, int *bufferedSamples, int *targetLatency, int64_t *underruns,
+	int64_t *droppedSamples, int64_t *lateSamples)
+{
+#if _DEBUG
+	if (!handle || !bufferedSamples || !targetLatency || !underruns || !droppedSamples || !lateSamples)
+		return -1;
+#endif
+
+	const auto context = static_cast<AudioJitterBufferContext *>(handle);
+
+	*bufferedSamples = static_cast<int>(context->write_position.load(std::memory_order_acquire) -
+		context->read_position.load(std::memory_order_acquire));
+	*targetLatency = context->target_latency.load(std::memory_order_relaxed);
+	*underruns = context->underruns.load(std::memory_order_relaxed);
+	*droppedSamples = context->dropped_samples.load(std::memory_order_relaxed) + context->overflow_samples.load(std::memory_order_relaxed);
+	*lateSamples = context->late_samples.load(std::memory_order_relaxed);
+	return 0;
+}
+
+void remove_audio_jitter_buffer(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<AudioJitterBufferContext *>(handle);
+
+	av_free(context->samples);
+	av_free(context);
+}
@@ -0,0 +1,336 @@
+#include "stdafx.h"
+#include "audiometering.h"
+
+#include <emmintrin.h>
+
+// Floor never falls below -90 dBFS, otherwise it couldn't rise back after digital silence
+#define MIN_NOISE_FLOOR 1e-9
+// Noise floor follows quieter audio at once and louder one by this many dB per second
+#define NOISE_FLOOR_RISE_DB 1.5
+
+static int64_t sum_epi64(__m128i vector)
+{
+	int64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), vector);
+	return lanes[0] + lanes[1];
+}
+
+// Pair of squared full scale samples still fits into 32 bits when taken as unsigned
+static __m128i add_squares_epi64(__m128i sum, __m128i squares)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+	return _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+}
+
+static void measure_s16(const int16_t *samples, int count, double *sumSquares, int *peak)
+{
+	__m128i sum = _mm_setzero_si128();
+	__m128i maximum = _mm_setzero_si128();
+	__m128i minimum = _mm_setzero_si128();
+
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+
+		sum = add_squares_epi64(sum, _mm_madd_epi16(x, x));
+		maximum = _mm_max_epi16(maximum, x);
+		minimum = _mm_min_epi16(minimum, x);
+	}
+
+	int16_t maximums[8], minimums[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(maximums), maximum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(minimums), minimum);
+
+	int64_t total = sum_epi64(sum);
+	int top = 0, bottom = 0;
+
+	for (int lane = 0; lane < 8; lane++)
+	{
+		top = FFMAX(top, maximums[lane]);
+		bottom = FFMIN(bottom, minimums[lane]);
+	}
+
+	for (; i < count; i++)
+	{
+		total += samples[i] * samples[i];
+		top = FFMAX(top, samples[i]);
+		bottom = FFMIN(bottom, samples[i]);
+	}
+
+	*sumSquares = static_cast<double>(total);
+	*peak = FFMAX(top, -bottom);
+}
+
+// Even lanes hold left samples and odd ones right samples, masks split them before squaring
+static void measure_stereo_s16(const int16_t *samples, int count, double *sumSquares, int *peaks)
+{
+	const __m128i left_mask = _mm_set1_epi32(0xFFFF);
+
+	__m128i left_sum = _mm_setzero_si128();
+	__m128i right_sum = _mm_setzero_si128();
+	__m128i maximum = _mm_setzero_si128();
+	__m128i minimum = _mm_setzero_si128();
+
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 2 * i));
+
+		left_sum = add_squares_epi64(left_sum, _mm_madd_epi16(x, _mm_and_si128(x, left_mask)));
+		right_sum = add_squares_epi64(right_sum, _mm_madd_epi16(x, _mm_andnot_si128(left_mask, x)));
+		maximum = _mm_max_epi16(maximum, x);
+		minimum = _mm_min_epi16(minimum, x);
+	}
+
+	int16_t maximums[8], minimums[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(maximums), maximum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(minimums), minimum);
+
+	int64_t totals[2] = { sum_epi64(left_sum), sum_epi64(right_sum) };
+	int tops[2] = { 0, 0 }, bottoms[2] = { 0, 0 };
+
+	for (int lane = 0; lane < 8; lane++)
+	{
+		tops[lane & 1] = FFMAX(tops[lane & 1], maximums[lane]);
+		bottoms[lane & 1] = FFMIN(bottoms[lane & 1], minimums[lane]);
+	}
+
+	for (; i < count; i++)
+	{
+		for (int channel = 0; channel < 2; channel++)
+		{
+			const int sample = samples[2 * i + channel];
+
+			totals[channel] += sample * sample;
+			tops[channel] = FFMAX(tops[channel], sample);
+			bottoms[channel] = FFMIN(bottoms[channel], sample);
+		}
+	}
+
+	for (int channel = 0; channel < 2; channel++)
+	{
+		sumSquares[channel] = static_cast<double>(totals[channel]);
+		peaks[channel] = FFMAX(tops[channel], -bottoms[channel]);
+	}
+}
+
+// Lanes are summed separately, so mono and interleaved stereo samples share the kernel
+static int measure_float_lanes(const float *samples, int count, __m128 *sum, __m128 *peak)
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	*sum = _mm_setzero_ps();
+	*peak = _mm_setzero_ps();
+
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(samples + i);
+
+		*sum = _mm_add_ps(*sum, _mm_mul_ps(x, x));
+		*peak = _mm_max_ps(*peak, _mm_and_ps(x, abs_mask));
+	}
+
+	return i;
+}
+
+static void measure_float(const float *samples, int count, double *sumSquares, float *peak)
+{
+	__m128 sum, maximum;
+	int i = measure_float_lanes(samples, count, &sum, &maximum);
+
+	float sums[4], maximums[4];
+	_mm_storeu_ps(sums, sum);
+	_mm_storeu_ps(maximums, maximum);
+
+	double total = static_cast<double>(sums[0]) + sums[1] + sums[2] + sums[3];
+	float top = FFMAX(FFMAX(maximums[0], maximums[1]), FFMAX(maximums[2], maximums[3]));
+
+	for (; i < count; i++)
+	{
+		total += samples[i] * samples[i];
+		top = FFMAX(top, fabsf(samples[i]));
+	}
+
+	*sumSquares = total;
+	*peak = top;
+}
+
+static void measure_stereo_float(const float *samples, int count, double *sumSquares, float *peaks)
+{
+	__m128 sum, maximum;
+	int i = measure_float_lanes(samples, count * 2, &sum, &maximum);
+
+	float sums[4], maximums[4];
+	_mm_storeu_ps(sums, sum);
+	_mm_storeu_ps(maximums, maximum);
+
+	for (int channel = 0; channel < 2; channel++)
+	{
+		sumSquares[channel] = static_cast<double>(sums[channel]) + sums[channel + 2];
+		peaks[channel] = FFMAX(maximums[channel], maximums[channel + 2]);
+	}
+
+	for (; i < count * 2; i++)
+	{
+		sumSquares[i & 1] += samples[i] * samples[i];
+		peaks[i & 1] = FFMAX(peaks[i & 1], fabsf(samples[i]));
+	}
+}
+
+static double get_full_scale_sample(const uint8_t *data, AVSampleFormat packedFormat, int index)
+{
+	switch (packedFormat)
+	{
+	case AV_SAMPLE_FMT_U8:
+		return (data[index] - 128) / 128.0;
+	case AV_SAMPLE_FMT_S16:
+		return reinterpret_cast<const int16_t *>(data)[index] / 32768.0;
+	case AV_SAMPLE_FMT_S32:
+		return reinterpret_cast<const int32_t *>(data)[index] / 2147483648.0;
+	case AV_SAMPLE_FMT_FLT:
+		return reinterpret_cast<const float *>(data)[index];
+	default:
+		return reinterpret_cast<const double *>(data)[index];
+	}
+}
+
+static void measure_generic(const uint8_t *data, AVSampleFormat packedFormat, int offset, int step, int count,
+	double *sumSquares, float *peak)
+{
+	double total = 0, top = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		const double sample = get_full_scale_sample(data, packedFormat, offset + i * step);
+
+		total += sample * sample;
+		top = FFMAX(top, fabs(sample));
+	}
+
+	*sumSquares = total;
+	*peak = static_cast<float>(top);
+}
+
+// Measures RMS and peak of every channel in full scale units, so 1 is the loudest sample of any format.
+// 16 bit and float samples of mono, stereo and planar frames go through SIMD kernels
+int measure_audio_levels(const AVFrame *frame, float *rms, float *peak, int channelsCapacity)
+{
+	const auto sampleFormat = static_cast<AVSampleFormat>(frame->format);
+	const AVSampleFormat packedFormat = av_get_packed_sample_fmt(sampleFormat);
+
+	if (packedFormat != AV_SAMPLE_FMT_U8 && packedFormat != AV_SAMPLE_FMT_S16 && packedFormat != AV_SAMPLE_FMT_S32 &&
+		packedFormat != AV_SAMPLE_FMT_FLT && packedFormat != AV_SAMPLE_FMT_DBL)
+		return -1;
+
+	const int channels = FFMIN(frame->channels, channelsCapacity);
+	const int count = frame->nb_samples;
+	const bool planar = av_sample_fmt_is_planar(sampleFormat) || frame->channels == 1;
+
+	if (count <= 0)
+	{
+		for (int channel = 0; channel < channels; channel++)
+			rms[channel] = peak[channel] = 0;
+
+		return 0;
+	}
+
+	if (!planar && frame->channels == 2 && channels != 0 &&
+		(packedFormat == AV_SAMPLE_FMT_S16 || packedFormat == AV_SAMPLE_FMT_FLT))
+	{
+		double sumSquares[2];
+		float peaks[2];
+
+		if (packedFormat == AV_SAMPLE_FMT_S16)
+		{
+			int s16Peaks[2];
+			measure_stereo_s16(reinterpret_cast<const int16_t *>(frame->extended_data[0]), count, sumSquares, s16Peaks);
+
+			for (int channel = 0; channel < 2; channel++)
+			{
+				sumSquares[channel] /= 32768.0 * 32768.0;
+				peaks[channel] = s16Peaks[channel] / 32768.0f;
+			}
+		}
+		else
+			measure_stereo_float(reinterpret_cast<const float *>(frame->extended_data[0]), count, sumSquares, peaks);
+
+		for (int channel = 0; channel < channels; channel++)
+		{
+			rms[channel] = static_cast<float>(sqrt(sumSquares[channel] / count));
+			peak[channel] = peaks[channel];
+		}
+
+		return 0;
+	}
+
+	for (int channel = 0; channel < channels; channel++)
+	{
+		const uint8_t *data = frame->extended_data[planar ? channel : 0];
+		double sumSquares;
+
+		if (planar && packedFormat == AV_SAMPLE_FMT_S16)
+		{
+			int s16Peak;
+			measure_s16(reinterpret_cast<const int16_t *>(data), count, &sumSquares, &s16Peak);
+
+			sumSquares /= 32768.0 * 32768.0;
+			peak[channel] = s16Peak / 32768.0f;
+		}
+		else if (planar && packedFormat == AV_SAMPLE_FMT_FLT)
+			measure_float(reinterpret_cast<const float *>(data), count, &sumSquares, &peak[channel]);
+		else if (planar)
+			measure_generic(data, packedFormat, 0, 1, count, &sumSquares, &peak[channel]);
+		else
+			measure_generic(data, packedFormat, channel, frame->channels, count, &sumSquares, &peak[channel]);
+
+		rms[channel] = static_cast<float>(sqrt(sumSquares / count));
+	}
+
+	return 0;
+}
+
+void init_audio_activity_detector(AudioActivityDetector *detector, float minLevelDb, float marginDb, int hangoverMs)
+{
+	detector->min_energy = pow(10.0, minLevelDb / 10.0);
+	detector->margin = pow(10.0, marginDb / 10.0);
+	detector->noise_floor = MIN_NOISE_FLOOR;
+	detector->hangover = hangoverMs / 1000.0;
+	detector->remaining_hangover = 0;
+}
+
+// Audio is active while its energy stays above both the minimum level and the tracked noise floor by the margin,
+// and for the hangover time after that, so pauses between words don't toggle the flag
+int detect_audio_activity(AudioActivityDetector *detector, const AVFrame *frame, const float *rms, int channels)
+{
+	if (channels <= 0 || frame->nb_samples <= 0 || frame->sample_rate <= 0)
+		return detector->remaining_hangover > 0;
+
+	double energy = 0;
+
+	for (int channel = 0; channel < channels; channel++)
+		energy += static_cast<double>(rms[channel]) * rms[channel];
+
+	energy /= channels;
+
+	const double duration = static_cast<double>(frame->nb_samples) / frame->sample_rate;
+	const bool active = energy > detector->min_energy && energy > detector->noise_floor * detector->margin;
+
+	if (active)
+		detector->remaining_hangover = detector->hangover;
+	else
+		detector->remaining_hangover = FFMAX(0.0, detector->remaining_hangover - duration);
+
+	if (energy < detector->noise_floor)
+		detector->noise_floor = FFMAX(energy, MIN_NOISE_FLOOR);
+	else
+		detector->noise_floor = FFMIN(energy, detector->noise_floor * pow(10.0, NOISE_FLOOR_RISE_DB * duration / 10.0));
+
+	return active || detector->remaining_hangover > 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+struct AudioActivityDetector
+{
+	// Levels are kept as mean squares of full scale samples
+	double min_energy;
+	double margin;
+	double noise_floor;
+	double hangover;
+	double remaining_hangover;
+};
+
+int measure_audio_levels(const AVFrame *frame, float *rms, float *peak, int channelsCapacity);
+void init_audio_activity_detector(AudioActivityDetector *detector, float minLevelDb, float marginDb, int hangoverMs);
+int detect_audio_activity(AudioActivityDetector *detector, const AVFrame *frame, const float *rms, int channels);
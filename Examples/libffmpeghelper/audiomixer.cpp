@@ -0,0 +1,405 @@
+#include "stdafx.h"
+#include "audiodecoding.h"
+
+#include <emmintrin.h>
+
+#define MAX_AUDIO_MIXER_INPUTS 16
+// Gains are fixed point numbers with this many fractional bits, so the highest gain is almost 8
+#define GAIN_SHIFT 12
+#define MAX_GAIN 32767
+
+struct AudioMixerContext;
+
+// Every input is a single producer, single consumer ring of 16 bit samples in the mixer format: the thread
+// of its stream pushes and the thread pulling the mix reads. Samples are converted before they are stored,
+// so the pulling thread only scales and sums
+struct AudioMixerInput
+{
+	AudioMixerContext *mixer;
+	int16_t *samples;
+	std::atomic<int64_t> write_position;
+	std::atomic<int64_t> read_position;
+	std::atomic<int> gain;
+	// Set by remove_audio_mixer_input, the input is freed by the next pull since it may be mixed right now
+	std::atomic<bool> removed;
+	std::atomic<int64_t> dropped_samples;
+	// Producer state
+	SwrContext *swr_context;
+	int in_sample_rate;
+	int in_sample_format;
+	int64_t in_channel_layout;
+	uint8_t *converted_data;
+	unsigned int converted_data_size;
+	// Consumer state
+	bool prebuffering;
+	std::atomic<int64_t> underruns;
+};
+
+struct AudioMixerContext
+{
+	int sample_rate;
+	int channels;
+	int64_t channel_layout;
+	// Capacity of every input ring and the fill an input needs before it is mixed, in samples
+	int capacity;
+	int prebuffer;
+	std::atomic<AudioMixerInput *> inputs[MAX_AUDIO_MIXER_INPUTS];
+	int32_t *mix_data;
+	unsigned int mix_data_size;
+};
+
+static int to_fixed_gain(float gain)
+{
+	return static_cast<int>(av_clipf(gain * (1 << GAIN_SHIFT) + 0.5f, 0, MAX_GAIN));
+}
+
+// Products of samples and gains are split into low and high halves by SSE2, interleaving them gives 32 bits
+static void mix_samples(const int16_t *source, int32_t *destination, int count, int gain)
+{
+	const __m128i gain_vector = _mm_set1_epi16(static_cast<int16_t>(gain));
+
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+		const __m128i low = _mm_mullo_epi16(x, gain_vector);
+		const __m128i high = _mm_mulhi_epi16(x, gain_vector);
+
+		const __m128i sum_low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(destination + i));
+		const __m128i sum_high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(destination + i + 4));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i),
+			_mm_add_epi32(sum_low, _mm_srai_epi32(_mm_unpacklo_epi16(low, high), GAIN_SHIFT)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 4),
+			_mm_add_epi32(sum_high, _mm_srai_epi32(_mm_unpackhi_epi16(low, high), GAIN_SHIFT)));
+	}
+
+	for (; i < count; i++)
+		destination[i] += (source[i] * gain) >> GAIN_SHIFT;
+}
+
+// Sum is saturated once, after all inputs are added
+static void pack_mix(const int32_t *source, int16_t *destination, int count)
+{
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i),
+			_mm_packs_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i + 4))));
+
+	for (; i < count; i++)
+		destination[i] = av_clip_int16(source[i]);
+}
+
+static void free_audio_mixer_input(AudioMixerInput *input)
+{
+	swr_free(&input->swr_context);
+	av_free(input->converted_data);
+	av_free(input->samples);
+	av_free(input);
+}
+
+// Samples that don't fit are dropped, the input is already as late as the mixer allows
+static int write_input(AudioMixerInput *input, const int16_t *samples, int samplesCount)
+{
+	const AudioMixerContext *mixer = input->mixer;
+	const int64_t write_position = input->write_position.load(std::memory_order_relaxed);
+	const int64_t read_position = input->read_position.load(std::memory_order_acquire);
+	const int count = FFMIN(samplesCount, static_cast<int>(mixer->capacity - (write_position - read_position)));
+
+	for (int written = 0; written < count;)
+	{
+		const int index = static_cast<int>((write_position + written) % mixer->capacity);
+		const int span = FFMIN(count - written, mixer->capacity - index);
+
+		memcpy(input->samples + static_cast<ptrdiff_t>(index) * mixer->channels, samples + static_cast<ptrdiff_t>(written) * mixer->channels,
+			static_cast<size_t>(span) * mixer->channels * sizeof(int16_t));
+
+		written += span;
+	}
+
+	input->write_position.store(write_position + count, std::memory_order_release);
+
+	if (count < samplesCount)
+	{
+		input->dropped_samples.fetch_add(samplesCount - count, std::memory_order_relaxed);
+		return -3;
+	}
+
+	return 0;
+}
+
+// Mixer latency is kept between minLatencyMs, which every input buffers before it is mixed, and maxLatencyMs.
+// Output is interleaved 16 bit audio of the given sample rate and channels
+int create_audio_mixer(int sampleRate, int channels, int minLatencyMs, int maxLatencyMs, void **handle)
+{
+	if (!handle || sampleRate <= 0 || channels <= 0 || minLatencyMs < 0 || maxLatencyMs <= 0 || maxLatencyMs < minLatencyMs)
+		return -1;
+
+	auto context = static_cast<AudioMixerContext *>(av_mallocz(sizeof(AudioMixerContext)));
+
+	if (!context)
+		return -2;
+
+	context->sample_rate = sampleRate;
+	context->channels = channels;
+	context->channel_layout = av_get_default_channel_layout(channels);
+	context->capacity = static_cast<int>(av_rescale(maxLatencyMs, sampleRate, 1000));
+	context->prebuffer = static_cast<int>(av_rescale(minLatencyMs, sampleRate, 1000));
+
+	if (context->capacity <= 0)
+	{
+		remove_audio_mixer(context);
+		return -1;
+	}
+
+	*handle = context;
+	return 0;
+}
+
+int add_audio_mixer_input(void *handle, float gain, void **inputHandle)
+{
+#if _DEBUG
+	if (!handle || !inputHandle)
+		return -1;
+#endif
+
+	const auto context = static_cast<AudioMixerContext *>(handle);
+	auto input = static_cast<AudioMixerInput *>(av_mallocz(sizeof(AudioMixerInput)));
+
+	if (!input)
+		return -2;
+
+	input->mixer = context;
+	input->samples = static_cast<int16_t *>(av_malloc_array(context->capacity, context->channels * sizeof(int16_t)));
+	input->gain = to_fixed_gain(gain);
+	input->prebuffering = true;
+	input->in_sample_format = AV_SAMPLE_FMT_NONE;
+
+	if (!input->samples)
+	{
+		free_audio_mixer_input(input);
+		return -2;
+	}
+
+	for (auto &slot : context->inputs)
+	{
+		AudioMixerInput *empty = nullptr;
+
+		if (slot.compare_exchange_strong(empty, input, std::memory_order_release))
+		{
+			*inputHandle = input;
+			return 0;
+		}
+	}
+
+	free_audio_mixer_input(input);
+	return -3;
+}
+
+int set_audio_mixer_input_gain(void *inputHandle, float gain)
+{
+#if _DEBUG
+	if (!inputHandle)
+		return -1;
+#endif
+
+	static_cast<AudioMixerInput *>(inputHandle)->gain.store(to_fixed_gain(gain), std::memory_order_relaxed);
+	return 0;
+}
+
+// Converts the last frame of the decoder to the mixer format and queues it, should be called from one thread per input
+int push_audio_mixer_input(void *inputHandle, void *decoderHandle)
+{
+#if _DEBUG
+	if (!inputHandle || !decoderHandle)
+		return -1;
+#endif
+
+	const auto input = static_cast<AudioMixerInput *>(inputHandle);
+	const AudioMixerContext *mixer = input->mixer;
+	const AVFrame *frame = static_cast<AudioDecoderContext *>(decoderHandle)->frame;
+
+	if (frame->nb_samples <= 0)
+		return 0;
+
+	const int64_t channel_layout = frame->channel_layout ? frame->channel_layout : av_get_default_channel_layout(frame->channels);
+
+	if (frame->format == AV_SAMPLE_FMT_S16 && frame->sample_rate == mixer->sample_rate && frame->channels == mixer->channels)
+		return write_input(input, reinterpret_cast<const int16_t *>(frame->extended_data[0]), frame->nb_samples);
+
+	if (!input->swr_context || input->in_sample_rate != frame->sample_rate || input->in_sample_format != frame->format ||
+		input->in_channel_layout != channel_layout)
+	{
+		swr_free(&input->swr_context);
+
+		input->swr_context = swr_alloc_set_opts(nullptr, mixer->channel_layout, AV_SAMPLE_FMT_S16, mixer->sample_rate,
+			channel_layout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate, 0, nullptr);
+
+		if (!input->swr_context || swr_init(input->swr_context) < 0)
+		{
+			swr_free(&input->swr_context);
+			return -2;
+		}
+
+		input->in_sample_rate = frame->sample_rate;
+		input->in_sample_format = frame->format;
+		input->in_channel_layout = channel_layout;
+	}
+
+	const int out_samples = swr_get_out_samples(input->swr_context, frame->nb_samples);
+
+	if (out_samples < 0)
+		return -2;
+
+	av_fast_malloc(&input->converted_data, &input->converted_data_size,
+		static_cast<size_t>(FFMAX(out_samples, 1)) * mixer->channels * sizeof(int16_t));
+
+	if (!input->converted_data)
+		return -2;
+
+	const int converted = swr_convert(input->swr_context, &input->converted_data, out_samples,
+		const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
+
+	if (converted < 0)
+		return -2;
+
+	return write_input(input, reinterpret_cast<const int16_t *>(input->converted_data), converted);
+}
+
+// Queues interleaved 16 bit samples which are already in the mixer format
+int push_audio_mixer_input_samples(void *inputHandle, const void *samples, int samplesCount)
+{
+#if _DEBUG
+	if (!inputHandle || !samples || samplesCount < 0)
+		return -1;
+#endif
+
+	return write_input(static_cast<AudioMixerInput *>(inputHandle), static_cast<const int16_t *>(samples), samplesCount);
+}
+
+// Should be called from the audio device callback only. The whole buffer is filled, inputs that have fewer
+// samples than requested are mixed with silence after them and wait to prebuffer again
+int pull_audio_mixer(void *handle, void *outBuffer, int samplesCount, int *mixedInputs)
+{
+#if _DEBUG
+	if (!handle || !outBuffer || samplesCount < 0 || !mixedInputs)
+		return -1;
+#endif
+
+	auto context = static_cast<AudioMixerContext *>(handle);
+	const int values_count = samplesCount * context->channels;
+
+	av_fast_malloc(&context->mix_data, &context->mix_data_size, static_cast<size_t>(FFMAX(values_count, 1)) * sizeof(int32_t));
+
+	if (!context->mix_data)
+		return -2;
+
+	memset(context->mix_data, 0, static_cast<size_t>(values_count) * sizeof(int32_t));
+
+	int mixed = 0;
+
+	for (auto &slot : context->inputs)
+	{
+		AudioMixerInput *input = slot.load(std::memory_order_acquire);
+
+		if (!input)
+			continue;
+
+		if (input->removed.load(std::memory_order_acquire))
+		{
+			slot.store(nullptr, std::memory_order_relaxed);
+			free_audio_mixer_input(input);
+			continue;
+		}
+
+		const int64_t read_position = input->read_position.load(std::memory_order_relaxed);
+		const int64_t buffered = input->write_position.load(std::memory_order_acquire) - read_position;
+
+		if (input->prebuffering)
+		{
+			if (buffered < FFMAX(context->prebuffer, 1))
+				continue;
+
+			input->prebuffering = false;
+		}
+
+		const int count = static_cast<int>(FFMIN(buffered, static_cast<int64_t>(samplesCount)));
+
+		if (count < samplesCount)
+		{
+			input->prebuffering = true;
+			input->underruns.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		const int gain = input->gain.load(std::memory_order_relaxed);
+
+		for (int taken = 0; taken < count;)
+		{
+			const int index = static_cast<int>((read_position + taken) % context->capacity);
+			const int span = FFMIN(count - taken, context->capacity - index);
+
+			mix_samples(input->samples + static_cast<ptrdiff_t>(index) * context->channels,
+				context->mix_data + static_cast<ptrdiff_t>(taken) * context->channels, span * context->channels, gain);
+
+			taken += span;
+		}
+
+		input->read_position.store(read_position + count, std::memory_order_release);
+
+		if (count > 0)
+			mixed++;
+	}
+
+	pack_mix(context->mix_data, static_cast<int16_t *>(outBuffer), values_count);
+
+	*mixedInputs = mixed;
+	return 0;
+}
+
+int get_audio_mixer_input_state(void *inputHandle, int *bufferedSamples, int64_t *underruns, int64_t *droppedSamples)
+{
+#if _DEBUG
+	if (!inputHandle || !bufferedSamples || !underruns || !droppedSamples)
+		return -1;
+#endif
+
+	const auto input = static_cast<AudioMixerInput *>(inputHandle);
+
+	*bufferedSamples = static_cast<int>(input->write_position.load(std::memory_order_acquire) -
+		input->read_position.load(std::memory_order_acquire));
+	*underruns = input->underruns.load(std::memory_order_relaxed);
+	*droppedSamples = input->dropped_samples.load(std::memory_order_relaxed);
+	return 0;
+}
+
+// The input must not be pushed to after this call
+void remove_audio_mixer_input(void *inputHandle)
+{
+	if (!inputHandle)
+		return;
+
+	static_cast<AudioMixerInput *>(inputHandle)->removed.store(true, std::memory_order_release);
+}
+
+// Frees the mixer with all its inputs, nothing may push or pull concurrently
+void remove_audio_mixer(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<AudioMixerContext *>(handle);
+
+	for (auto &slot : context->inputs)
+	{
+		AudioMixerInput *input = slot.load(std::memory_order_acquire);
+
+		if (input)
+			free_audio_mixer_input(input);
+	}
+
+	av_free(context->mix_data);
+	av_free(context);
+}
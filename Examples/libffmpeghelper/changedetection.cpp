@@ -0,0 +1,385 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+#include <emmintrin.h>
+
+#define TILE_SIZE_ALIGNMENT 16
+#define TILE_SCALING_MARGIN 2
+
+// Returns true when the sum of absolute differences of two regions exceeds maxSad, stops as soon as it does
+static bool is_region_changed(const uint8_t *current, int currentStride, const uint8_t *previous, int previousStride,
+	int widthInBytes, int height, uint64_t maxSad)
+{
+	uint64_t sad = 0;
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t *current_row = current + static_cast<ptrdiff_t>(y) * currentStride;
+		const uint8_t *previous_row = previous + static_cast<ptrdiff_t>(y) * previousStride;
+		__m128i row_sad = _mm_setzero_si128();
+
+		int x = 0;
+
+		for (; x + 16 <= widthInBytes; x += 16)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current_row + x));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(previous_row + x));
+			row_sad = _mm_add_epi64(row_sad, _mm_sad_epu8(a, b));
+		}
+
+		sad += static_cast<uint32_t>(_mm_cvtsi128_si32(row_sad)) + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(row_sad, 8)));
+
+		for (; x < widthInBytes; x++)
+			sad += abs(current_row[x] - previous_row[x]);
+
+		if (sad > maxSad)
+			return true;
+	}
+
+	return false;
+}
+
+static void get_tile_rect(ScalerContext *scalerContext, int column, int row, int *left, int *top, int *width, int *height)
+{
+	*left = column * scalerContext->change_tile_size;
+	*top = row * scalerContext->change_tile_size;
+	*width = FFMIN(scalerContext->change_tile_size, scalerContext->source_width - *left);
+	*height = FFMIN(scalerContext->change_tile_size, scalerContext->source_height - *top);
+}
+
+static int find_dirty_tiles(ScalerContext *scalerContext, uint8_t *srcData[4], const int srcLinesize[4])
+{
+	const AVPixelFormat pixelFormat = scalerContext->source_pixel_format;
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(pixelFormat);
+	const int plane_count = av_pix_fmt_count_planes(pixelFormat);
+	int dirty_count = 0;
+
+	for (int row = 0; row < scalerContext->change_rows; row++)
+	{
+		for (int column = 0; column < scalerContext->change_columns; column++)
+		{
+			int left, top, width, height;
+			get_tile_rect(scalerContext, column, row, &left, &top, &width, &height);
+
+			uint8_t *currentPlanes[4];
+			uint8_t *previousPlanes[4];
+
+			offset_image_planes(pixelFormat, srcData, srcLinesize, left, top, currentPlanes);
+			offset_image_planes(pixelFormat, scalerContext->previous_data, scalerContext->previous_linesize, left, top, previousPlanes);
+
+			bool changed = false;
+
+			for (int i = 0; i < plane_count && !changed; i++)
+			{
+				const int width_in_bytes = av_image_get_linesize(pixelFormat, width, i);
+				const int plane_height = i == 1 || i == 2 ? AV_CEIL_RSHIFT(height, fmtDesc->log2_chroma_h) : height;
+
+				changed = is_region_changed(currentPlanes[i], srcLinesize[i], previousPlanes[i], scalerContext->previous_linesize[i],
+					width_in_bytes, plane_height, static_cast<uint64_t>(width_in_bytes) * plane_height * scalerContext->change_threshold);
+			}
+
+			scalerContext->dirty_tiles[row * scalerContext->change_columns + column] = changed ? 1 : 0;
+
+			if (changed)
+				dirty_count++;
+		}
+	}
+
+	return dirty_count;
+}
+
+static int convert_dirty_tiles(ScalerContext *scalerContext, uint8_t *srcData[4], const int srcLinesize[4],
+	uint8_t *scaledPlanes[4], int scaledPlaneStrides[4])
+{
+	for (int row = 0; row < scalerContext->change_rows; row++)
+	{
+		for (int column = 0; column < scalerContext->change_columns; column++)
+		{
+			if (!scalerContext->dirty_tiles[row * scalerContext->change_columns + column])
+				continue;
+
+			int left, top, width, height;
+			get_tile_rect(scalerContext, column, row, &left, &top, &width, &height);
+
+			uint8_t *sourcePlanes[4];
+			uint8_t *targetPlanes[4];
+
+			offset_image_planes(scalerContext->source_pixel_format, srcData, srcLinesize, left, top, sourcePlanes);
+			offset_image_planes(scalerContext->scaled_pixel_format, scaledPlanes, scaledPlaneStrides,
+				scalerContext->content_left + left, scalerContext->content_top + top, targetPlanes);
+
+			if (!scalerContext->sws_context)
+			{
+				av_image_copy(targetPlanes, scaledPlaneStrides, const_cast<const uint8_t **>(sourcePlanes), srcLinesize,
+					scalerContext->scaled_pixel_format, width, height);
+				continue;
+			}
+
+			const int tile_kind = (width != scalerContext->change_tile_size ? 1 : 0) + (height != scalerContext->change_tile_size ? 2 : 0);
+
+			if (sws_scale(scalerContext->tile_sws_contexts[tile_kind], sourcePlanes, srcLinesize, 0, height,
+				targetPlanes, scaledPlaneStrides) <= 0)
+				return -4;
+		}
+	}
+
+	return 0;
+}
+
+static void update_previous_frame(ScalerContext *scalerContext, uint8_t *srcData[4], const int srcLinesize[4], bool dirtyOnly)
+{
+	if (!dirtyOnly)
+	{
+		av_image_copy(scalerContext->previous_data, scalerContext->previous_linesize, const_cast<const uint8_t **>(srcData), srcLinesize,
+			scalerContext->source_pixel_format, scalerContext->source_width, scalerContext->source_height);
+		return;
+	}
+
+	for (int row = 0; row < scalerContext->change_rows; row++)
+	{
+		for (int column = 0; column < scalerContext->change_columns; column++)
+		{
+			if (!scalerContext->dirty_tiles[row * scalerContext->change_columns + column])
+				continue;
+
+			int left, top, width, height;
+			get_tile_rect(scalerContext, column, row, &left, &top, &width, &height);
+
+			uint8_t *sourcePlanes[4];
+			uint8_t *previousPlanes[4];
+
+			offset_image_planes(scalerContext->source_pixel_format, srcData, srcLinesize, left, top, sourcePlanes);
+			offset_image_planes(scalerContext->source_pixel_format, scalerContext->previous_data, scalerContext->previous_linesize,
+				left, top, previousPlanes);
+
+			av_image_copy(previousPlanes, scalerContext->previous_linesize, const_cast<const uint8_t **>(sourcePlanes), srcLinesize,
+				scalerContext->source_pixel_format, width, height);
+		}
+	}
+}
+
+static void append_dirty_rect(int left, int top, int width, int height, int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount)
+{
+	if (*dirtyRectsCount < maxDirtyRectsCount)
+	{
+		int *rect = dirtyRects + *dirtyRectsCount * 4;
+		rect[0] = left;
+		rect[1] = top;
+		rect[2] = width;
+		rect[3] = height;
+	}
+
+	(*dirtyRectsCount)++;
+}
+
+// Horizontal runs of dirty tiles are reported as single rectangles in target coordinates,
+// scaled rectangles are extended by a small margin to cover the filter support
+static void get_dirty_rects(ScalerContext *scalerContext, int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount)
+{
+	const bool scaled = scalerContext->scaled_width != scalerContext->source_width ||
+		scalerContext->scaled_height != scalerContext->source_height;
+	const int margin = scaled ? TILE_SCALING_MARGIN : 0;
+	int count = 0;
+
+	for (int row = 0; row < scalerContext->change_rows; row++)
+	{
+		const uint8_t *dirty_row = scalerContext->dirty_tiles + row * scalerContext->change_columns;
+
+		for (int column = 0; column < scalerContext->change_columns; column++)
+		{
+			if (!dirty_row[column])
+				continue;
+
+			const int first_column = column;
+
+			while (column + 1 < scalerContext->change_columns && dirty_row[column + 1])
+				column++;
+
+			int left, top, width, height, last_left, last_width;
+			get_tile_rect(scalerContext, first_column, row, &left, &top, &width, &height);
+			get_tile_rect(scalerContext, column, row, &last_left, &top, &last_width, &height);
+
+			const int right = last_left + last_width;
+			const int bottom = top + height;
+
+			const int target_left = FFMAX(static_cast<int>(static_cast<int64_t>(left) * scalerContext->scaled_width / scalerContext->source_width) - margin, 0);
+			const int target_top = FFMAX(static_cast<int>(static_cast<int64_t>(top) * scalerContext->scaled_height / scalerContext->source_height) - margin, 0);
+			const int target_right = FFMIN(static_cast<int>((static_cast<int64_t>(right) * scalerContext->scaled_width +
+				scalerContext->source_width - 1) / scalerContext->source_width) + margin, scalerContext->scaled_width);
+			const int target_bottom = FFMIN(static_cast<int>((static_cast<int64_t>(bottom) * scalerContext->scaled_height +
+				scalerContext->source_height - 1) / scalerContext->source_height) + margin, scalerContext->scaled_height);
+
+			append_dirty_rect(scalerContext->content_left + target_left, scalerContext->content_top + target_top,
+				target_right - target_left, target_bottom - target_top, dirtyRects, maxDirtyRectsCount, &count);
+		}
+	}
+
+	// Too many rectangles, the whole content is reported instead
+	if (count > maxDirtyRectsCount)
+	{
+		count = 0;
+		append_dirty_rect(scalerContext->content_left, scalerContext->content_top, scalerContext->content_width,
+			scalerContext->content_height, dirtyRects, maxDirtyRectsCount, &count);
+	}
+
+	*dirtyRectsCount = count;
+}
+
+static int scale_video_frame_changes(const AVFrame *frame, ScalerContext *scalerContext, uint8_t *scaledPlanes[4],
+	int scaledPlaneStrides[4], int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount)
+{
+	*dirtyRectsCount = 0;
+
+	if (!scalerContext->change_tile_size || !scalerContext->has_previous_frame)
+	{
+		const int result = scale_video_frame(frame, scalerContext, scaledPlanes, scaledPlaneStrides);
+
+		if (result != 0)
+			return result;
+
+		if (scalerContext->change_tile_size)
+		{
+			uint8_t *srcData[4];
+			get_source_planes(frame, scalerContext, srcData);
+			update_previous_frame(scalerContext, srcData, frame->linesize, false);
+			scalerContext->has_previous_frame = 1;
+		}
+
+		append_dirty_rect(0, 0, scalerContext->target_width, scalerContext->target_height, dirtyRects, maxDirtyRectsCount, dirtyRectsCount);
+
+		return 0;
+	}
+
+	uint8_t *srcData[4];
+	get_source_planes(frame, scalerContext, srcData);
+
+	if (find_dirty_tiles(scalerContext, srcData, frame->linesize) == 0)
+		return 0;
+
+	int result;
+
+	// Without scaling every tile is converted on its own, otherwise the whole picture is scaled and only reported rectangles are limited
+	if (scalerContext->scaled_width == scalerContext->source_width && scalerContext->scaled_height == scalerContext->source_height)
+		result = convert_dirty_tiles(scalerContext, srcData, frame->linesize, scaledPlanes, scaledPlaneStrides);
+	else
+		result = scale_video_frame(frame, scalerContext, scaledPlanes, scaledPlaneStrides);
+
+	if (result != 0)
+		return result;
+
+	update_previous_frame(scalerContext, srcData, frame->linesize, true);
+	get_dirty_rects(scalerContext, dirtyRects, maxDirtyRectsCount, dirtyRectsCount);
+	return 0;
+}
+
+void remove_scaler_change_detection(ScalerContext *scalerContext)
+{
+	av_freep(&scalerContext->previous_data[0]);
+	av_freep(&scalerContext->dirty_tiles);
+
+	for (int i = 0; i < 4; i++)
+	{
+		sws_freeContext(scalerContext->tile_sws_contexts[i]);
+		scalerContext->tile_sws_contexts[i] = nullptr;
+	}
+
+	scalerContext->change_tile_size = 0;
+	scalerContext->has_previous_frame = 0;
+}
+
+int set_video_scaler_change_detection(void *scalerHandle, int tileSize, int threshold, int quality)
+{
+	if (!scalerHandle || tileSize < 0 || threshold < 0 || threshold > 255)
+		return -1;
+
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	remove_scaler_change_detection(scalerContext);
+
+	if (tileSize == 0)
+		return 0;
+
+	// Tiles are compared in source coordinates, so rotated and mirrored pictures are not supported
+	if (scalerContext->rotation != 0 || scalerContext->mirror)
+		return -2;
+
+	// Tile edges should not split subsampled chroma samples
+	if (tileSize % TILE_SIZE_ALIGNMENT != 0)
+		return -3;
+
+	scalerContext->change_tile_size = tileSize;
+	scalerContext->change_threshold = threshold;
+	scalerContext->change_columns = (scalerContext->source_width + tileSize - 1) / tileSize;
+	scalerContext->change_rows = (scalerContext->source_height + tileSize - 1) / tileSize;
+	scalerContext->dirty_tiles = static_cast<uint8_t *>(av_mallocz(scalerContext->change_columns * scalerContext->change_rows));
+
+	if (!scalerContext->dirty_tiles || av_image_alloc(scalerContext->previous_data, scalerContext->previous_linesize,
+		scalerContext->source_width, scalerContext->source_height, scalerContext->source_pixel_format, 16) < 0)
+	{
+		remove_scaler_change_detection(scalerContext);
+		return -4;
+	}
+
+	if (scalerContext->sws_context &&
+		scalerContext->scaled_width == scalerContext->source_width && scalerContext->scaled_height == scalerContext->source_height)
+	{
+		const int last_width = scalerContext->source_width - (scalerContext->change_columns - 1) * tileSize;
+		const int last_height = scalerContext->source_height - (scalerContext->change_rows - 1) * tileSize;
+		const int widths[4] = { tileSize, last_width, tileSize, last_width };
+		const int heights[4] = { tileSize, tileSize, last_height, last_height };
+
+		for (int i = 0; i < 4; i++)
+		{
+			scalerContext->tile_sws_contexts[i] = sws_getContext(widths[i], heights[i], scalerContext->source_pixel_format,
+				widths[i], heights[i], scalerContext->scaled_pixel_format, quality, nullptr, nullptr, nullptr);
+
+			if (!scalerContext->tile_sws_contexts[i])
+			{
+				remove_scaler_change_detection(scalerContext);
+				return -5;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int scale_decoded_video_frame_changes(void *handle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride,
+	int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount)
+{
+#if _DEBUG
+	if (!handle || !scalerHandle || !scaledBuffer || !dirtyRects || maxDirtyRectsCount < 1 || !dirtyRectsCount)
+		return -1;
+#endif
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	uint8_t *scaledPlanes[4];
+	int scaledPlaneStrides[4];
+
+	fill_scaled_planes(scalerContext, static_cast<uint8_t *>(scaledBuffer), scaledBufferStride, scaledPlanes, scaledPlaneStrides);
+
+	return scale_video_frame_changes(context->frame, scalerContext, scaledPlanes, scaledPlaneStrides,
+		dirtyRects, maxDirtyRectsCount, dirtyRectsCount);
+}
+
+int scale_acquired_video_frame_changes(void *frameHandle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride,
+	int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount)
+{
+#if _DEBUG
+	if (!frameHandle || !scalerHandle || !scaledBuffer || !dirtyRects || maxDirtyRectsCount < 1 || !dirtyRectsCount)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	uint8_t *scaledPlanes[4];
+	int scaledPlaneStrides[4];
+
+	fill_scaled_planes(scalerContext, static_cast<uint8_t *>(scaledBuffer), scaledBufferStride, scaledPlanes, scaledPlaneStrides);
+
+	return scale_video_frame_changes(frameContext->frame, scalerContext, scaledPlanes, scaledPlaneStrides,
+		dirtyRects, maxDirtyRectsCount, dirtyRectsCount);
+}
@@ -9,19 +9,113 @@
 DllExport(int) create_video_decoder(int codec_id, void **handle);
 DllExport(int) set_video_decoder_extradata(void *handle, void *extradata, int extradataLength);
 DllExport(int) decode_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int *frameWidth, int *frameHeight, int *framePixelFormat);
+DllExport(int) decode_and_scale_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int scaledWidth, int scaledHeight,
+	int scaledPixelFormat, int quality, void *scaledBuffer, int scaledBufferSize, int scaledBufferStride,
+	int *frameWidth, int *frameHeight, int *framePixelFormat);
+DllExport(int) flush_video_decoder(void *handle);
+DllExport(int) set_video_decoder_error_options(void *handle, int concealErrors, int outputCorruptFrames, int outputAllFrames);
+DllExport(int) set_video_decoder_band_conversion(void *handle, int enabled);
+DllExport(int) get_decoded_video_frame_error_flags(void *handle, int *errorFlags);
+DllExport(int) set_video_decoder_analysis_options(void *handle, int exportMotionVectors, int skipLoopFilter);
 DllExport(int) scale_decoded_video_frame(void *handle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride);
+DllExport(int) scale_decoded_video_frame_planes(void *handle, void *scalerHandle, void **scaledPlanes, int *scaledPlaneStrides);
+DllExport(int) set_video_decoder_max_acquired_frames(void *handle, int maxAcquiredFrames);
+DllExport(int) acquire_decoded_video_frame(void *handle, void **frameHandle);
+DllExport(int) scale_acquired_video_frame(void *frameHandle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride);
+DllExport(int) scale_acquired_video_frame_planes(void *frameHandle, void *scalerHandle, void **scaledPlanes, int *scaledPlaneStrides);
+DllExport(void) release_acquired_video_frame(void *frameHandle);
 DllExport(void) remove_video_decoder(void *handle);
 
 DllExport(int) create_video_scaler(int sourceLeft, int sourceTop, int sourceWidth, int sourceHeight, int sourcePixelFormat, 
-	int scaledWidth, int scaledHeight, int scaledPixelFormat, int quality, void **handle);
+	int scaledWidth, int scaledHeight, int scaledPixelFormat, int quality, int targetWidth, int targetHeight,
+	int rotation, int mirror, int fillColor, void **handle);
 DllExport(void) remove_video_scaler(void *handle);
+DllExport(int) set_video_scaler_change_detection(void *scalerHandle, int tileSize, int threshold, int quality);
+DllExport(int) scale_decoded_video_frame_changes(void *handle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride,
+	int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount);
+DllExport(int) scale_acquired_video_frame_changes(void *frameHandle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride,
+	int *dirtyRects, int maxDirtyRectsCount, int *dirtyRectsCount);
+
+DllExport(int) create_video_tensor_converter(int sourceWidth, int sourceHeight, int sourcePixelFormat, int tensorWidth, int tensorHeight,
+	int tensorDataType, int channelOrder, float *mean, float *stdDev, int padColor, int letterbox, int quality, void **handle);
+DllExport(int) convert_decoded_video_frame_to_tensor(void *handle, void *converterHandle, void *tensorBuffer, int batchIndex);
+DllExport(int) convert_acquired_video_frame_to_tensor(void *frameHandle, void *converterHandle, void *tensorBuffer, int batchIndex);
+DllExport(void) remove_video_tensor_converter(void *handle);
+
+DllExport(int) create_video_compositor(int width, int height, int pixelFormat, int fillColor, int borderColor, int borderWidth,
+	int keepAspectRatio, int quality, void **handle);
+DllExport(int) set_video_compositor_tile(void *handle, int tileIndex, int left, int top, int width, int height);
+DllExport(int) compose_decoded_video_frame(void *compositorHandle, int tileIndex, void *decoderHandle);
+DllExport(int) compose_acquired_video_frame(void *compositorHandle, int tileIndex, void *frameHandle);
+DllExport(int) get_video_compositor_surface(void *handle, void **planes, int *strides);
+DllExport(int) get_video_compositor_dirty_rects(void *handle, int *rects, int maxRectsCount, int *rectsCount);
+DllExport(void) remove_video_compositor(void *handle);
+
+DllExport(int) create_video_motion_detector(void *decoderHandle, int gridWidth, int gridHeight, void **handle);
+DllExport(int) set_video_motion_detector_parameters(void *handle, int threshold, float learningRate);
+DllExport(int) set_video_motion_detector_mask(void *handle, void *mask);
+DllExport(int) detect_video_motion(void *handle, void *activityMap, float *score);
+DllExport(void) remove_video_motion_detector(void *handle);
+DllExport(int) get_decoded_video_motion_energy(void *handle, int gridWidth, int gridHeight, float *energyGrid, float *totalEnergy);
+DllExport(int) get_acquired_video_motion_energy(void *frameHandle, int gridWidth, int gridHeight, float *energyGrid, float *totalEnergy);
+
+DllExport(int) create_video_statistics_analyzer(void *decoderHandle, int subsampling, int interval, void **handle);
+DllExport(int) compute_video_frame_statistics(void *handle, int *histogram, float *mean, float *variance, float *sharpness, float *sceneChange);
+DllExport(void) remove_video_statistics_analyzer(void *handle);
+
+DllExport(int) create_video_frame_ring(const char *name, int slotsCount, int width, int height, int pixelFormat, int quality, void **handle);
+DllExport(int) publish_decoded_video_frame(void *handle, void *ringHandle, int64_t timestamp);
+DllExport(int) publish_acquired_video_frame(void *frameHandle, void *ringHandle, int64_t timestamp);
+DllExport(int) open_video_frame_ring(const char *name, void **handle);
+DllExport(int) get_video_frame_ring_format(void *handle, int *slotsCount, int *width, int *height, int *pixelFormat, int *planeStrides);
+DllExport(int) begin_read_video_frame_ring(void *handle, int64_t lastSequence, int64_t *sequence, int64_t *timestamp, void **planes);
+DllExport(int) end_read_video_frame_ring(void *handle, int64_t sequence);
+DllExport(void) remove_video_frame_ring(void *handle);
+
+DllExport(int) create_video_presentation_ring(int bufferSize, void **handle);
+DllExport(int) begin_write_video_presentation_ring(void *handle, void **buffer);
+DllExport(int) end_write_video_presentation_ring(void *handle, int64_t timestamp);
+DllExport(int) acquire_video_presentation_buffer(void *handle, void **buffer, int64_t *timestamp);
+DllExport(int) get_video_presentation_ring_statistics(void *handle, int64_t *writtenFrames, int64_t *droppedFrames);
+DllExport(void) remove_video_presentation_ring(void *handle);
 
 DllExport(int) create_audio_decoder(int codec_id, int bits_per_coded_sample, void **handle);
 DllExport(int) set_audio_decoder_extradata(void *handle, void *extradata, int extradataLength);
 DllExport(int) decode_audio_frame(void *handle, void *rawBuffer, int rawBufferLength, int *sampleRate, int *bitsPerSample, int *channels);
+DllExport(int) decode_audio_frames(void *handle, void *rawBuffer, const int *frameOffsets, const int *frameLengths, int framesCount,
+	int outSampleFormat, void *outBuffer, int outBufferSize, int *outOffsets, int *requiredSize, int *sampleRate, int *bitsPerSample,
+	int *channels);
 DllExport(int) get_decoded_audio_frame(void *handle, void **outBuffer, int *outDataSize);
+DllExport(int) get_decoded_audio_frame_interleaved(void *handle, int outSampleFormat, void *outBuffer, int outBufferSize, int *outDataSize);
+DllExport(int) get_decoded_audio_frame_levels(void *handle, float *rms, float *peak, int channelsCapacity, int *channels, int *isActive);
+DllExport(int) set_audio_activity_detection(void *handle, float minLevelDb, float marginDb, int hangoverMs);
 DllExport(void) remove_audio_decoder(void *handle);
 
 DllExport(int) create_audio_resampler(void *decoderHandle, int outSampleRate, int outBitsPerSample, int outChannels, void **handle);
 DllExport(int) resample_decoded_audio_frame(void *decoderHandle, void *resamplerHandle, void **outBuffer, int *outDataSize);
-DllExport(void) remove_audio_resampler(void *handle);
\ No newline at end of file
+DllExport(int) set_audio_resampler_compensation(void *handle, int sampleDelta, int compensationDistance);
+DllExport(int) adjust_audio_resampler_drift(void *handle, int bufferedSamples, int targetSamples, int maxCorrection, int *sampleDelta);
+DllExport(void) remove_audio_resampler(void *handle);
+
+DllExport(int) create_audio_jitter_buffer(int sampleRate, int sampleSize, int minLatency, int maxLatency, void **handle);
+DllExport(int) push_audio_jitter_buffer(void *handle, void *samples, int samplesCount, int64_t timestamp);
+DllExport(int) pull_audio_jitter_buffer(void *handle, void *outBuffer, int samplesCount, int *playedCount);
+DllExport(int) get_audio_jitter_buffer_state(void *handle, int *bufferedSamples, int *targetLatency, int64_t *underruns,
+	int64_t *droppedSamples, int64_t *lateSamples);
+DllExport(void) remove_audio_jitter_buffer(void *handle);
+
+DllExport(int) create_audio_mixer(int sampleRate, int channels, int minLatencyMs, int maxLatencyMs, void **handle);
+DllExport(int) add_audio_mixer_input(void *handle, float gain, void **inputHandle);
+DllExport(int) set_audio_mixer_input_gain(void *inputHandle, float gain);
+DllExport(int) push_audio_mixer_input(void *inputHandle, void *decoderHandle);
+DllExport(int) push_audio_mixer_input_samples(void *inputHandle, const void *samples, int samplesCount);
+DllExport(int) pull_audio_mixer(void *handle, void *outBuffer, int samplesCount, int *mixedInputs);
+DllExport(int) get_audio_mixer_input_state(void *inputHandle, int *bufferedSamples, int64_t *underruns, int64_t *droppedSamples);
+DllExport(void) remove_audio_mixer_input(void *inputHandle);
+DllExport(void) remove_audio_mixer(void *handle);
+
+DllExport(int) create_audio_encoder(int codec_id, int sampleRate, int channels, int bitRate, int frameSize, void **handle);
+DllExport(int) encode_audio_samples(void *handle, const void *samples, int samplesCount, int *consumedCount, void **outBuffer,
+	int *outDataSize);
+DllExport(int) get_audio_encoder_frame_size(void *handle, int *frameSize);
+DllExport(void) remove_audio_encoder(void *handle);
\ No newline at end of file
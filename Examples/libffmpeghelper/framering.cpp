@@ -0,0 +1,428 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define FRAME_RING_MAGIC 0x47524656 // "VFRG"
+#define FRAME_RING_VERSION 1
+#define FRAME_RING_ALIGNMENT 64
+#define FRAME_RING_MAX_NAME_LENGTH 256
+
+// Shared memory layout: ring header followed by slots, every slot is a slot header followed by picture planes.
+// Slots are protected by sequence locks: writer makes slot sequence odd while the picture is being written
+// and sets it to 2 * frame sequence when the picture is complete. Readers check the slot sequence before and after
+// they access the picture, so they never block the writer and just retry or skip frames overwritten under them
+struct FrameRingHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	int32_t slots_count;
+	int32_t slot_stride;
+	int32_t data_offset;
+	int32_t data_size;
+	int32_t width;
+	int32_t height;
+	int32_t pixel_format;
+	int32_t plane_offsets[4];
+	int32_t plane_strides[4];
+	// Sequence of the last complete frame, frames are numbered from 1 and frame N is written to slot N % slots_count
+	std::atomic<int64_t> write_sequence;
+};
+
+struct FrameRingSlotHeader
+{
+	std::atomic<int64_t> sequence;
+	int64_t timestamp;
+};
+
+struct FrameRingContext
+{
+	uint8_t *memory;
+	size_t memory_size;
+	int owner;
+	int64_t sequence;
+	// Scaler from decoded frames to ring format, recreated when decoded frame geometry changes
+	ScalerContext *scaler_context;
+	int quality;
+#ifdef _WIN32
+	HANDLE mapping;
+#else
+	char name[FRAME_RING_MAX_NAME_LENGTH];
+#endif
+};
+
+static FrameRingHeader *get_ring_header(FrameRingContext *context)
+{
+	return reinterpret_cast<FrameRingHeader *>(context->memory);
+}
+
+static FrameRingSlotHeader *get_ring_slot(FrameRingContext *context, int64_t sequence)
+{
+	const FrameRingHeader *header = get_ring_header(context);
+	const int64_t slot = sequence % header->slots_count;
+
+	return reinterpret_cast<FrameRingSlotHeader *>(context->memory + FFALIGN(sizeof(FrameRingHeader), FRAME_RING_ALIGNMENT) +
+		slot * header->slot_stride);
+}
+
+static int map_shared_memory(FrameRingContext *context, const char *name, size_t size, bool create)
+{
+#ifdef _WIN32
+	if (create)
+		context->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), name);
+	else
+		context->mapping = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name);
+
+	if (!context->mapping)
+		return -1;
+
+	// Ring with the same name is published by someone else
+	if (create && GetLastError() == ERROR_ALREADY_EXISTS)
+		return -1;
+
+	context->memory = static_cast<uint8_t *>(MapViewOfFile(context->mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size));
+
+	if (!context->memory)
+		return -1;
+
+	if (!size)
+	{
+		MEMORY_BASIC_INFORMATION info;
+
+		if (!VirtualQuery(context->memory, &info, sizeof(info)))
+			return -1;
+
+		size = info.RegionSize;
+	}
+#else
+	if (strlen(name) >= FRAME_RING_MAX_NAME_LENGTH)
+		return -1;
+
+	strcpy(context->name, name);
+
+	const int fd = shm_open(name, create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+
+	if (fd < 0)
+		return -1;
+
+	if (create && ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		close(fd);
+		shm_unlink(name);
+		return -1;
+	}
+
+	if (!size)
+	{
+		const off_t end = lseek(fd, 0, SEEK_END);
+
+		if (end <= 0)
+		{
+			close(fd);
+			return -1;
+		}
+
+		size = static_cast<size_t>(end);
+	}
+
+	void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (memory == MAP_FAILED)
+	{
+		if (create)
+			shm_unlink(name);
+
+		return -1;
+	}
+
+	context->memory = static_cast<uint8_t *>(memory);
+#endif
+
+	context->memory_size = size;
+	context->owner = create ? 1 : 0;
+	return 0;
+}
+
+static void unmap_shared_memory(FrameRingContext *context)
+{
+#ifdef _WIN32
+	if (context->memory)
+		UnmapViewOfFile(context->memory);
+
+	if (context->mapping)
+		CloseHandle(context->mapping);
+#else
+	if (context->memory)
+		munmap(context->memory, context->memory_size);
+
+	if (context->owner)
+		shm_unlink(context->name);
+#endif
+
+	context->memory = nullptr;
+}
+
+int create_video_frame_ring(const char *name, int slotsCount, int width, int height, int pixelFormat, int quality, void **handle)
+{
+	if (!name || !handle || slotsCount < 2 || width <= 0 || height <= 0)
+		return -1;
+
+	const auto avPixelFormat = static_cast<AVPixelFormat>(pixelFormat);
+
+	if (!av_pix_fmt_desc_get(avPixelFormat))
+		return -2;
+
+	int plane_strides[4];
+	uint8_t *plane_pointers[4];
+
+	// Aligned strides keep rows of every plane suitable for SIMD on the reader side
+	if (av_image_fill_linesizes(plane_strides, avPixelFormat, FFALIGN(width, FRAME_RING_ALIGNMENT)) < 0)
+		return -2;
+
+	const int data_size = av_image_fill_pointers(plane_pointers, avPixelFormat, height, nullptr, plane_strides);
+
+	if (data_size < 0)
+		return -2;
+
+	const int data_offset = FFALIGN(sizeof(FrameRingSlotHeader), FRAME_RING_ALIGNMENT);
+	const int slot_stride = FFALIGN(data_offset + data_size, FRAME_RING_ALIGNMENT);
+	const size_t memory_size = FFALIGN(sizeof(FrameRingHeader), FRAME_RING_ALIGNMENT) + static_cast<size_t>(slot_stride) * slotsCount;
+
+	auto context = static_cast<FrameRingContext *>(av_mallocz(sizeof(FrameRingContext)));
+
+	if (!context)
+		return -3;
+
+	if (map_shared_memory(context, name, memory_size, true) != 0)
+	{
+		remove_video_frame_ring(context);
+		return -4;
+	}
+
+	context->quality = quality;
+
+	FrameRingHeader *header = get_ring_header(context);
+
+	header->version = FRAME_RING_VERSION;
+	header->slots_count = slotsCount;
+	header->slot_stride = slot_stride;
+	header->data_offset = data_offset;
+	header->data_size = data_size;
+	header->width = width;
+	header->height = height;
+	header->pixel_format = pixelFormat;
+
+	const int plane_count = av_pix_fmt_count_planes(avPixelFormat);
+
+	// Pointers were filled relative to null, so they are plane offsets
+	for (int i = 0; i < 4; i++)
+	{
+		header->plane_offsets[i] = i < plane_count ? static_cast<int32_t>(reinterpret_cast<uintptr_t>(plane_pointers[i])) : -1;
+		header->plane_strides[i] = i < plane_count ? plane_strides[i] : 0;
+	}
+
+	header->write_sequence.store(0, std::memory_order_relaxed);
+
+	// Readers accept the ring only after the magic is visible, so it is written last
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = FRAME_RING_MAGIC;
+
+	*handle = context;
+	return 0;
+}
+
+static int publish_video_frame(const AVFrame *frame, FrameRingContext *context, int64_t timestamp)
+{
+	if (frame->width <= 0 || frame->height <= 0)
+		return -2;
+
+	FrameRingHeader *header = get_ring_header(context);
+	ScalerContext *scalerContext = context->scaler_context;
+
+	if (!scalerContext || scalerContext->source_width != frame->width || scalerContext->source_height != frame->height ||
+		scalerContext->source_pixel_format != frame->format)
+	{
+		remove_video_scaler(scalerContext);
+		context->scaler_context = nullptr;
+
+		void *scalerHandle;
+		const int result = create_video_scaler(0, 0, frame->width, frame->height, frame->format, header->width, header->height,
+			header->pixel_format, context->quality, header->width, header->height, 0, 0, 0, &scalerHandle);
+
+		if (result != 0)
+			return -100 + result;
+
+		scalerContext = context->scaler_context = static_cast<ScalerContext *>(scalerHandle);
+	}
+
+	const int64_t sequence = ++context->sequence;
+	FrameRingSlotHeader *slot = get_ring_slot(context, sequence);
+	uint8_t *data = reinterpret_cast<uint8_t *>(slot) + header->data_offset;
+
+	uint8_t *planes[4];
+	int strides[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		planes[i] = header->plane_offsets[i] >= 0 ? data + header->plane_offsets[i] : nullptr;
+		strides[i] = header->plane_strides[i];
+	}
+
+	slot->sequence.store(2 * sequence - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot->timestamp = timestamp;
+
+	const int result = scale_video_frame(frame, scalerContext, planes, strides);
+
+	if (result != 0)
+	{
+		// Slot stays invalid until it is reused
+		slot->sequence.store(0, std::memory_order_release);
+		return result;
+	}
+
+	slot->sequence.store(2 * sequence, std::memory_order_release);
+	header->write_sequence.store(sequence, std::memory_order_release);
+	return 0;
+}
+
+int publish_decoded_video_frame(void *handle, void *ringHandle, int64_t timestamp)
+{
+#if _DEBUG
+	if (!handle || !ringHandle)
+		return -1;
+#endif
+
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+
+	return publish_video_frame(context->frame, static_cast<FrameRingContext *>(ringHandle), timestamp);
+}
+
+int publish_acquired_video_frame(void *frameHandle, void *ringHandle, int64_t timestamp)
+{
+#if _DEBUG
+	if (!frameHandle || !ringHandle)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+
+	return publish_video_frame(frameContext->frame, static_cast<FrameRingContext *>(ringHandle), timestamp);
+}
+
+int open_video_frame_ring(const char *name, void **handle)
+{
+	if (!name || !handle)
+		return -1;
+
+	auto context = static_cast<FrameRingContext *>(av_mallocz(sizeof(FrameRingContext)));
+
+	if (!context)
+		return -3;
+
+	if (map_shared_memory(context, name, 0, false) != 0)
+	{
+		remove_video_frame_ring(context);
+		return -4;
+	}
+
+	const FrameRingHeader *header = get_ring_header(context);
+
+	if (context->memory_size < sizeof(FrameRingHeader) || header->magic != FRAME_RING_MAGIC || header->version != FRAME_RING_VERSION)
+	{
+		remove_video_frame_ring(context);
+		return -5;
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	*handle = context;
+	return 0;
+}
+
+int get_video_frame_ring_format(void *handle, int *slotsCount, int *width, int *height, int *pixelFormat, int *planeStrides)
+{
+#if _DEBUG
+	if (!handle || !slotsCount || !width || !height || !pixelFormat || !planeStrides)
+		return -1;
+#endif
+
+	const FrameRingHeader *header = get_ring_header(static_cast<FrameRingContext *>(handle));
+
+	*slotsCount = header->slots_count;
+	*width = header->width;
+	*height = header->height;
+	*pixelFormat = header->pixel_format;
+
+	for (int i = 0; i < 4; i++)
+		planeStrides[i] = header->plane_strides[i];
+
+	return 0;
+}
+
+// Gives direct access to the planes of the latest frame newer than lastSequence, the planes should be used
+// only until end_read_video_frame_ring confirms that the frame was not overwritten meanwhile
+int begin_read_video_frame_ring(void *handle, int64_t lastSequence, int64_t *sequence, int64_t *timestamp, void **planes)
+{
+#if _DEBUG
+	if (!handle || !sequence || !timestamp || !planes)
+		return -1;
+#endif
+
+	const auto context = static_cast<FrameRingContext *>(handle);
+	const FrameRingHeader *header = get_ring_header(context);
+	const int64_t write_sequence = header->write_sequence.load(std::memory_order_acquire);
+
+	if (write_sequence == 0 || write_sequence <= lastSequence)
+		return -2;
+
+	FrameRingSlotHeader *slot = get_ring_slot(context, write_sequence);
+
+	// Writer has already moved on to this slot again
+	if (slot->sequence.load(std::memory_order_acquire) != 2 * write_sequence)
+		return -3;
+
+	uint8_t *data = reinterpret_cast<uint8_t *>(slot) + header->data_offset;
+
+	for (int i = 0; i < 4; i++)
+		planes[i] = header->plane_offsets[i] >= 0 ? data + header->plane_offsets[i] : nullptr;
+
+	*timestamp = slot->timestamp;
+	*sequence = write_sequence;
+	return 0;
+}
+
+// Returns 0 if the frame read since begin_read_video_frame_ring is consistent
+int end_read_video_frame_ring(void *handle, int64_t sequence)
+{
+#if _DEBUG
+	if (!handle || sequence <= 0)
+		return -1;
+#endif
+
+	const auto context = static_cast<FrameRingContext *>(handle);
+	FrameRingSlotHeader *slot = get_ring_slot(context, sequence);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return slot->sequence.load(std::memory_order_relaxed) == 2 * sequence ? 0 : -2;
+}
+
+void remove_video_frame_ring(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<FrameRingContext *>(handle);
+
+	unmap_shared_memory(context);
+	remove_video_scaler(context->scaler_context);
+	av_free(context);
+}
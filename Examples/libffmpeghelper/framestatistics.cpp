@@ -0,0 +1,240 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+#include <emmintrin.h>
+
+#define HISTOGRAM_SIZE 256
+
+struct StatisticsAnalyzerContext
+{
+	VideoDecoderContext *decoder_context;
+	int subsampling;
+	int interval;
+	int frames_count;
+	int sampled_width;
+	int sampled_height;
+	int has_previous_histogram;
+	uint32_t previous_histogram[HISTOGRAM_SIZE];
+	// Three sampled luma rows widened to 16 bits, enough to compute the Laplacian of the middle one
+	int16_t *rows[3];
+};
+
+// Samples every subsampling-th pixel of the row into 16-bit buffer and counts them into the histogram
+static void sample_row(const uint8_t *source, int16_t *destination, int sampledWidth, int subsampling, uint32_t histogram[4][HISTOGRAM_SIZE])
+{
+	int i = 0;
+
+	if (subsampling == 1)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i + 16 <= sampledWidth; i += 16)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_unpacklo_epi8(pixels, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 8), _mm_unpackhi_epi8(pixels, zero));
+		}
+	}
+
+	for (; i < sampledWidth; i++)
+		destination[i] = source[static_cast<ptrdiff_t>(i) * subsampling];
+
+	// Several partial histograms avoid stalls on repeated increments of the same counter
+	i = 0;
+
+	for (; i + 4 <= sampledWidth; i += 4)
+	{
+		histogram[0][destination[i]]++;
+		histogram[1][destination[i + 1]]++;
+		histogram[2][destination[i + 2]]++;
+		histogram[3][destination[i + 3]]++;
+	}
+
+	for (; i < sampledWidth; i++)
+		histogram[0][destination[i]]++;
+}
+
+// Accumulates sum and sum of squares of 4 * center - left - right - above - below for interior pixels of the row
+static void accumulate_laplacian_row(const int16_t *above, const int16_t *center, const int16_t *below, int sampledWidth,
+	int64_t *sum, int64_t *squaresSum)
+{
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum_vector = _mm_setzero_si128();
+	__m128i squares_vector = _mm_setzero_si128();
+
+	int x = 1;
+
+	for (; x + 8 <= sampledWidth - 1; x += 8)
+	{
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(center + x));
+		const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(center + x - 1));
+		const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(center + x + 1));
+		const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + x));
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(below + x));
+
+		const __m128i laplacian = _mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(u, d)));
+		const __m128i squares = _mm_madd_epi16(laplacian, laplacian);
+
+		sum_vector = _mm_add_epi32(sum_vector, _mm_madd_epi16(laplacian, ones));
+		squares_vector = _mm_add_epi64(squares_vector, _mm_unpacklo_epi32(squares, zero));
+		squares_vector = _mm_add_epi64(squares_vector, _mm_unpackhi_epi32(squares, zero));
+	}
+
+	int32_t sums[4];
+	int64_t squares_sums[2];
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(sums), sum_vector);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(squares_sums), squares_vector);
+
+	int64_t row_sum = static_cast<int64_t>(sums[0]) + sums[1] + sums[2] + sums[3];
+	int64_t row_squares_sum = squares_sums[0] + squares_sums[1];
+
+	for (; x < sampledWidth - 1; x++)
+	{
+		const int laplacian = 4 * center[x] - center[x - 1] - center[x + 1] - above[x] - below[x];
+		row_sum += laplacian;
+		row_squares_sum += laplacian * laplacian;
+	}
+
+	*sum += row_sum;
+	*squaresSum += row_squares_sum;
+}
+
+static int allocate_statistics_rows(StatisticsAnalyzerContext *context, int frameWidth, int frameHeight)
+{
+	for (int i = 0; i < 3; i++)
+		av_freep(&context->rows[i]);
+
+	context->sampled_width = (frameWidth + context->subsampling - 1) / context->subsampling;
+	context->sampled_height = (frameHeight + context->subsampling - 1) / context->subsampling;
+	context->has_previous_histogram = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		context->rows[i] = static_cast<int16_t *>(av_malloc_array(context->sampled_width, sizeof(int16_t)));
+
+		if (!context->rows[i])
+			return -1;
+	}
+
+	return 0;
+}
+
+int create_video_statistics_analyzer(void *decoderHandle, int subsampling, int interval, void **handle)
+{
+	if (!decoderHandle || !handle || subsampling <= 0 || interval <= 0)
+		return -1;
+
+	auto context = static_cast<StatisticsAnalyzerContext *>(av_mallocz(sizeof(StatisticsAnalyzerContext)));
+
+	if (!context)
+		return -2;
+
+	context->decoder_context = static_cast<VideoDecoderContext *>(decoderHandle);
+	context->subsampling = subsampling;
+	context->interval = interval;
+
+	*handle = context;
+	return 0;
+}
+
+int compute_video_frame_statistics(void *handle, int *histogram, float *mean, float *variance, float *sharpness, float *sceneChange)
+{
+#if _DEBUG
+	if (!handle || !histogram || !mean || !variance || !sharpness || !sceneChange)
+		return -1;
+#endif
+
+	const auto context = static_cast<StatisticsAnalyzerContext *>(handle);
+	const AVFrame *frame = context->decoder_context->frame;
+
+	if (!frame || !frame->data[0] || frame->width <= 0 || frame->height <= 0)
+		return -3;
+
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+
+	if (!fmtDesc || (fmtDesc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL)) ||
+		fmtDesc->comp[0].plane != 0 || fmtDesc->comp[0].step != 1 || fmtDesc->comp[0].depth != 8)
+		return -4;
+
+	// Only every interval-th valid frame is analyzed, rejected ones don't take sampling slots
+	if (context->frames_count++ % context->interval != 0)
+		return -2;
+
+	if (!context->rows[0] || context->sampled_width != (frame->width + context->subsampling - 1) / context->subsampling ||
+		context->sampled_height != (frame->height + context->subsampling - 1) / context->subsampling)
+	{
+		if (allocate_statistics_rows(context, frame->width, frame->height) != 0)
+			return -5;
+	}
+
+	const int sampled_width = context->sampled_width;
+	const int sampled_height = context->sampled_height;
+	const ptrdiff_t sampled_stride = static_cast<ptrdiff_t>(frame->linesize[0]) * context->subsampling;
+
+	uint32_t partial_histograms[4][HISTOGRAM_SIZE] = {};
+	int64_t laplacian_sum = 0;
+	int64_t laplacian_squares_sum = 0;
+	int16_t *rows[3] = { context->rows[0], context->rows[1], context->rows[2] };
+
+	for (int y = 0; y < sampled_height; y++)
+	{
+		sample_row(frame->data[0] + y * sampled_stride, rows[y % 3], sampled_width, context->subsampling, partial_histograms);
+
+		if (y >= 2)
+			accumulate_laplacian_row(rows[(y - 2) % 3], rows[(y - 1) % 3], rows[y % 3], sampled_width,
+				&laplacian_sum, &laplacian_squares_sum);
+	}
+
+	const double samples_count = static_cast<double>(sampled_width) * sampled_height;
+	double luma_sum = 0;
+	double luma_squares_sum = 0;
+	uint64_t histogram_distance = 0;
+
+	for (int i = 0; i < HISTOGRAM_SIZE; i++)
+	{
+		const uint32_t count = partial_histograms[0][i] + partial_histograms[1][i] + partial_histograms[2][i] + partial_histograms[3][i];
+
+		histogram[i] = static_cast<int>(count);
+		luma_sum += static_cast<double>(count) * i;
+		luma_squares_sum += static_cast<double>(count) * i * i;
+
+		histogram_distance += count > context->previous_histogram[i] ? count - context->previous_histogram[i] :
+			context->previous_histogram[i] - count;
+		context->previous_histogram[i] = count;
+	}
+
+	const double luma_mean = luma_sum / samples_count;
+
+	*mean = static_cast<float>(luma_mean);
+	*variance = static_cast<float>(luma_squares_sum / samples_count - luma_mean * luma_mean);
+
+	const double laplacian_count = static_cast<double>(FFMAX(sampled_width - 2, 0)) * FFMAX(sampled_height - 2, 0);
+
+	if (laplacian_count > 0)
+	{
+		const double laplacian_mean = laplacian_sum / laplacian_count;
+		*sharpness = static_cast<float>(laplacian_squares_sum / laplacian_count - laplacian_mean * laplacian_mean);
+	}
+	else
+		*sharpness = 0;
+
+	// Half of L1 distance between normalized histograms, 0 for identical frames and 1 for disjoint ones
+	*sceneChange = context->has_previous_histogram ? static_cast<float>(histogram_distance / (2 * samples_count)) : 0;
+	context->has_previous_histogram = 1;
+	return 0;
+}
+
+void remove_video_statistics_analyzer(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<StatisticsAnalyzerContext *>(handle);
+
+	for (int i = 0; i < 3; i++)
+		av_freep(&context->rows[i]);
+
+	av_free(context);
+}
@@ -0,0 +1,300 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+#include <emmintrin.h>
+
+#define DEFAULT_MOTION_THRESHOLD 12
+#define DEFAULT_MOTION_LEARNING_RATE 0.05f
+
+struct MotionDetectorContext
+{
+	VideoDecoderContext *decoder_context;
+	int grid_width;
+	int grid_height;
+	int threshold;
+	float learning_rate;
+	int frame_width;
+	int frame_height;
+	int has_background;
+	// Per block: sum of luma for the current frame, background mean and mask (0 - block is ignored)
+	uint32_t *block_sums;
+	float *background;
+	uint8_t *mask;
+	int *column_bounds;
+};
+
+// Sums bytes in [begin, end) of the row, 16 pixels per iteration with psadbw
+static uint32_t sum_row(const uint8_t *row, int begin, int end)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum = _mm_setzero_si128();
+
+	int i = begin;
+
+	for (; i + 16 <= end; i += 16)
+	{
+		const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(pixels, zero));
+	}
+
+	uint32_t result = static_cast<uint32_t>(_mm_cvtsi128_si32(sum)) + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+
+	for (; i < end; i++)
+		result += row[i];
+
+	return result;
+}
+
+static void sum_luma_blocks(MotionDetectorContext *context, const uint8_t *luma, int lumaStride)
+{
+	memset(context->block_sums, 0, sizeof(uint32_t) * context->grid_width * context->grid_height);
+
+	for (int block_y = 0; block_y < context->grid_height; block_y++)
+	{
+		const int first_row = static_cast<int>(static_cast<int64_t>(block_y) * context->frame_height / context->grid_height);
+		const int last_row = static_cast<int>(static_cast<int64_t>(block_y + 1) * context->frame_height / context->grid_height);
+		uint32_t *sums = context->block_sums + block_y * context->grid_width;
+
+		for (int y = first_row; y < last_row; y++)
+		{
+			const uint8_t *row = luma + static_cast<ptrdiff_t>(y) * lumaStride;
+
+			for (int block_x = 0; block_x < context->grid_width; block_x++)
+				sums[block_x] += sum_row(row, context->column_bounds[block_x], context->column_bounds[block_x + 1]);
+		}
+	}
+}
+
+static void reset_motion_background(MotionDetectorContext *context, int frameWidth, int frameHeight)
+{
+	context->frame_width = frameWidth;
+	context->frame_height = frameHeight;
+	context->has_background = 0;
+
+	for (int block_x = 0; block_x <= context->grid_width; block_x++)
+		context->column_bounds[block_x] = static_cast<int>(static_cast<int64_t>(block_x) * frameWidth / context->grid_width);
+}
+
+int create_video_motion_detector(void *decoderHandle, int gridWidth, int gridHeight, void **handle)
+{
+	if (!decoderHandle || !handle || gridWidth <= 0 || gridHeight <= 0)
+		return -1;
+
+	auto context = static_cast<MotionDetectorContext *>(av_mallocz(sizeof(MotionDetectorContext)));
+
+	if (!context)
+		return -2;
+
+	const int blocks_count = gridWidth * gridHeight;
+
+	context->decoder_context = static_cast<VideoDecoderContext *>(decoderHandle);
+	context->grid_width = gridWidth;
+	context->grid_height = gridHeight;
+	context->threshold = DEFAULT_MOTION_THRESHOLD;
+	context->learning_rate = DEFAULT_MOTION_LEARNING_RATE;
+	context->block_sums = static_cast<uint32_t *>(av_malloc_array(blocks_count, sizeof(uint32_t)));
+	context->background = static_cast<float *>(av_malloc_array(blocks_count, sizeof(float)));
+	context->mask = static_cast<uint8_t *>(av_malloc(blocks_count));
+	context->column_bounds = static_cast<int *>(av_malloc_array(gridWidth + 1, sizeof(int)));
+
+	if (!context->block_sums || !context->background || !context->mask || !context->column_bounds)
+	{
+		remove_video_motion_detector(context);
+		return -2;
+	}
+
+	memset(context->mask, 1, blocks_count);
+
+	*handle = context;
+	return 0;
+}
+
+int set_video_motion_detector_parameters(void *handle, int threshold, float learningRate)
+{
+	if (!handle || threshold < 0 || threshold > 255 || learningRate <= 0 || learningRate > 1)
+		return -1;
+
+	const auto context = static_cast<MotionDetectorContext *>(handle);
+
+	context->threshold = threshold;
+	context->learning_rate = learningRate;
+	return 0;
+}
+
+int set_video_motion_detector_mask(void *handle, void *mask)
+{
+	if (!handle)
+		return -1;
+
+	const auto context = static_cast<MotionDetectorContext *>(handle);
+	const int blocks_count = context->grid_width * context->grid_height;
+
+	if (mask)
+		memcpy(context->mask, mask, blocks_count);
+	else
+		memset(context->mask, 1, blocks_count);
+
+	return 0;
+}
+
+int detect_video_motion(void *handle, void *activityMap, float *score)
+{
+#if _DEBUG
+	if (!handle || !score)
+		return -1;
+#endif
+
+	const auto context = static_cast<MotionDetectorContext *>(handle);
+	const AVFrame *frame = context->decoder_context->frame;
+
+	if (!frame || frame->width <= 0 || frame->height <= 0)
+		return -2;
+
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+
+	// Luma should be a separate 8-bit plane, which is true for planar and semi-planar YUV and gray formats
+	if (!fmtDesc || (fmtDesc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL)) ||
+		fmtDesc->comp[0].plane != 0 || fmtDesc->comp[0].step != 1 || fmtDesc->comp[0].depth != 8)
+		return -3;
+
+	if (frame->width != context->frame_width || frame->height != context->frame_height)
+		reset_motion_background(context, frame->width, frame->height);
+
+	// Blocks are smaller than a pixel, nothing to detect
+	if (frame->width < context->grid_width || frame->height < context->grid_height)
+		return -4;
+
+	sum_luma_blocks(context, frame->data[0], frame->linesize[0]);
+
+	auto activity = static_cast<uint8_t *>(activityMap);
+	int active_blocks = 0;
+	int masked_blocks = 0;
+
+	for (int block_y = 0; block_y < context->grid_height; block_y++)
+	{
+		const int block_height = static_cast<int>(static_cast<int64_t>(block_y + 1) * context->frame_height / context->grid_height) -
+			static_cast<int>(static_cast<int64_t>(block_y) * context->frame_height / context->grid_height);
+
+		for (int block_x = 0; block_x < context->grid_width; block_x++)
+		{
+			const int i = block_y * context->grid_width + block_x;
+			const int block_width = context->column_bounds[block_x + 1] - context->column_bounds[block_x];
+			const float mean = static_cast<float>(context->block_sums[i]) / (block_width * block_height);
+
+			if (!context->has_background)
+			{
+				context->background[i] = mean;
+
+				if (activity)
+					activity[i] = 0;
+
+				continue;
+			}
+
+			const float difference = mean - context->background[i];
+			const bool active = context->mask[i] && (difference > context->threshold || difference < -context->threshold);
+
+			context->background[i] += difference * context->learning_rate;
+
+			if (activity)
+				activity[i] = active ? 1 : 0;
+
+			if (context->mask[i])
+				masked_blocks++;
+
+			if (active)
+				active_blocks++;
+		}
+	}
+
+	context->has_background = 1;
+	*score = masked_blocks != 0 ? static_cast<float>(active_blocks) / masked_blocks : 0;
+	return 0;
+}
+
+// Every vector contributes its displacement length weighted by block area to the grid cell containing the block center,
+// cells are normalized by their area, so energy is the mean displacement of cell pixels
+static int get_motion_vectors_energy(const AVFrame *frame, int gridWidth, int gridHeight, float *energyGrid, float *totalEnergy)
+{
+	memset(energyGrid, 0, sizeof(float) * gridWidth * gridHeight);
+	*totalEnergy = 0;
+
+	if (frame->width <= 0 || frame->height <= 0)
+		return -2;
+
+	const AVFrameSideData *sideData = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+
+	// Intra frames and frames without exported vectors have no motion
+	if (!sideData)
+		return 0;
+
+	const auto vectors = reinterpret_cast<const AVMotionVector *>(sideData->data);
+	const int vectors_count = static_cast<int>(sideData->size / sizeof(AVMotionVector));
+	float total = 0;
+
+	for (int i = 0; i < vectors_count; i++)
+	{
+		const AVMotionVector *vector = &vectors[i];
+
+		if (vector->motion_scale == 0 || (vector->motion_x == 0 && vector->motion_y == 0))
+			continue;
+
+		const int x = av_clip(vector->dst_x, 0, frame->width - 1);
+		const int y = av_clip(vector->dst_y, 0, frame->height - 1);
+		const float motion_x = static_cast<float>(vector->motion_x) / vector->motion_scale;
+		const float motion_y = static_cast<float>(vector->motion_y) / vector->motion_scale;
+		const float energy = sqrtf(motion_x * motion_x + motion_y * motion_y) * vector->w * vector->h;
+
+		const int cell_x = static_cast<int>(static_cast<int64_t>(x) * gridWidth / frame->width);
+		const int cell_y = static_cast<int>(static_cast<int64_t>(y) * gridHeight / frame->height);
+
+		energyGrid[cell_y * gridWidth + cell_x] += energy;
+		total += energy;
+	}
+
+	const float cell_area = static_cast<float>(frame->width) * frame->height / (gridWidth * gridHeight);
+
+	for (int i = 0; i < gridWidth * gridHeight; i++)
+		energyGrid[i] /= cell_area;
+
+	*totalEnergy = total / (static_cast<float>(frame->width) * frame->height);
+	return 0;
+}
+
+int get_decoded_video_motion_energy(void *handle, int gridWidth, int gridHeight, float *energyGrid, float *totalEnergy)
+{
+#if _DEBUG
+	if (!handle || gridWidth <= 0 || gridHeight <= 0 || !energyGrid || !totalEnergy)
+		return -1;
+#endif
+
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+
+	return get_motion_vectors_energy(context->frame, gridWidth, gridHeight, energyGrid, totalEnergy);
+}
+
+int get_acquired_video_motion_energy(void *frameHandle, int gridWidth, int gridHeight, float *energyGrid, float *totalEnergy)
+{
+#if _DEBUG
+	if (!frameHandle || gridWidth <= 0 || gridHeight <= 0 || !energyGrid || !totalEnergy)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+
+	return get_motion_vectors_energy(frameContext->frame, gridWidth, gridHeight, energyGrid, totalEnergy);
+}
+
+void remove_video_motion_detector(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<MotionDetectorContext *>(handle);
+
+	av_free(context->block_sums);
+	av_free(context->background);
+	av_free(context->mask);
+	av_free(context->column_bounds);
+	av_free(context);
+}
@@ -0,0 +1,134 @@
+#include "stdafx.h"
+
+#define PRESENTATION_BUFFERS_COUNT 3
+#define PRESENTATION_BUFFER_INDEX_MASK 3
+// Set on the middle buffer while it holds a picture the renderer hasn't taken yet
+#define PRESENTATION_BUFFER_NEW 4
+
+// Triple buffering: the producer writes to the back buffer and the renderer reads the front one,
+// both exchange their buffer with the middle one. Producer never waits for the renderer: a picture
+// left in the middle buffer is just overwritten by the next one, so at most one picture is queued
+struct PresentationRingContext
+{
+	uint8_t *buffers[PRESENTATION_BUFFERS_COUNT];
+	int64_t timestamps[PRESENTATION_BUFFERS_COUNT];
+	int back_index;
+	int front_index;
+	std::atomic<int> middle;
+	std::atomic<int64_t> written_frames;
+	std::atomic<int64_t> dropped_frames;
+};
+
+int create_video_presentation_ring(int bufferSize, void **handle)
+{
+	if (!handle || bufferSize <= 0)
+		return -1;
+
+	auto context = static_cast<PresentationRingContext *>(av_mallocz(sizeof(PresentationRingContext)));
+
+	if (!context)
+		return -2;
+
+	for (int i = 0; i < PRESENTATION_BUFFERS_COUNT; i++)
+	{
+		context->buffers[i] = static_cast<uint8_t *>(av_mallocz(bufferSize));
+
+		if (!context->buffers[i])
+		{
+			remove_video_presentation_ring(context);
+			return -2;
+		}
+	}
+
+	context->back_index = 0;
+	context->middle = 1;
+	context->front_index = 2;
+	context->written_frames = 0;
+	context->dropped_frames = 0;
+
+	*handle = context;
+	return 0;
+}
+
+int begin_write_video_presentation_ring(void *handle, void **buffer)
+{
+#if _DEBUG
+	if (!handle || !buffer)
+		return -1;
+#endif
+
+	const auto context = static_cast<PresentationRingContext *>(handle);
+
+	*buffer = context->buffers[context->back_index];
+	return 0;
+}
+
+int end_write_video_presentation_ring(void *handle, int64_t timestamp)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	const auto context = static_cast<PresentationRingContext *>(handle);
+
+	context->timestamps[context->back_index] = timestamp;
+
+	const int previous = context->middle.exchange(context->back_index | PRESENTATION_BUFFER_NEW, std::memory_order_acq_rel);
+
+	if (previous & PRESENTATION_BUFFER_NEW)
+		context->dropped_frames.fetch_add(1, std::memory_order_relaxed);
+
+	context->back_index = previous & PRESENTATION_BUFFER_INDEX_MASK;
+	context->written_frames.fetch_add(1, std::memory_order_relaxed);
+	return 0;
+}
+
+// Takes the newest complete picture, which stays valid until the next successful call.
+// Returns -2 if nothing was written since then, so the renderer can keep the current picture
+int acquire_video_presentation_buffer(void *handle, void **buffer, int64_t *timestamp)
+{
+#if _DEBUG
+	if (!handle || !buffer || !timestamp)
+		return -1;
+#endif
+
+	const auto context = static_cast<PresentationRingContext *>(handle);
+
+	if (!(context->middle.load(std::memory_order_relaxed) & PRESENTATION_BUFFER_NEW))
+		return -2;
+
+	// Only the renderer clears the flag, so it is still set here
+	context->front_index = context->middle.exchange(context->front_index, std::memory_order_acq_rel) & PRESENTATION_BUFFER_INDEX_MASK;
+
+	*buffer = context->buffers[context->front_index];
+	*timestamp = context->timestamps[context->front_index];
+	return 0;
+}
+
+int get_video_presentation_ring_statistics(void *handle, int64_t *writtenFrames, int64_t *droppedFrames)
+{
+#if _DEBUG
+	if (!handle || !writtenFrames || !droppedFrames)
+		return -1;
+#endif
+
+	const auto context = static_cast<PresentationRingContext *>(handle);
+
+	*writtenFrames = context->written_frames.load(std::memory_order_relaxed);
+	*droppedFrames = context->dropped_frames.load(std::memory_order_relaxed);
+	return 0;
+}
+
+void remove_video_presentation_ring(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<PresentationRingContext *>(handle);
+
+	for (int i = 0; i < PRESENTATION_BUFFERS_COUNT; i++)
+		av_free(context->buffers[i]);
+
+	av_free(context);
+}
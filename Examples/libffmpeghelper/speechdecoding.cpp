@@ -0,0 +1,388 @@
+#include "stdafx.h"
+#include "speechdecoding.h"
+
+#define G711_SIGN_BIT 0x80
+#define G711_QUANT_MASK 0x0F
+#define G711_SEG_SHIFT 4
+#define G711_SEG_MASK 0x70
+#define G711_ULAW_BIAS 0x84
+
+struct G711Tables
+{
+	int16_t alaw[256];
+	int16_t ulaw[256];
+};
+
+struct G726Tables
+{
+	const int16_t *dqln;
+	const int *wi;
+	const int16_t *fi;
+};
+
+static const int16_t g726_16_dqln[4] = { 116, 365, 365, 116 };
+static const int g726_16_wi[4] = { -704, 14048, 14048, -704 };
+static const int16_t g726_16_fi[4] = { 0, 0xE00, 0xE00, 0 };
+
+static const int16_t g726_24_dqln[8] = { -2048, 135, 273, 373, 373, 273, 135, -2048 };
+static const int g726_24_wi[8] = { -128, 960, 4384, 18624, 18624, 4384, 960, -128 };
+static const int16_t g726_24_fi[8] = { 0, 0x200, 0x400, 0xE00, 0xE00, 0x400, 0x200, 0 };
+
+static const int16_t g726_32_dqln[16] = { -2048, 4, 135, 213, 273, 323, 373, 425, 425, 373, 323, 273, 213, 135, 4, -2048 };
+static const int g726_32_wi[16] = { -384, 576, 1312, 2048, 3584, 6336, 11360, 35904, 35904, 11360, 6336, 3584, 2048, 1312, 576, -384 };
+static const int16_t g726_32_fi[16] = { 0, 0, 0, 0x200, 0x200, 0x200, 0x600, 0xE00, 0xE00, 0x600, 0x200, 0x200, 0x200, 0, 0, 0 };
+
+static const int16_t g726_40_dqln[32] = { -2048, -66, 28, 104, 169, 224, 274, 318, 358, 395, 429, 459, 488, 514, 539, 566,
+	566, 539, 514, 488, 459, 429, 395, 358, 318, 274, 224, 169, 104, 28, -66, -2048 };
+static const int g726_40_wi[32] = { 448, 448, 768, 1248, 1280, 1312, 1856, 3200, 4512, 5728, 7008, 8960, 11456, 14080, 16928, 22272,
+	22272, 16928, 14080, 11456, 8960, 7008, 5728, 4512, 3200, 1856, 1312, 1280, 1248, 768, 448, 448 };
+static const int16_t g726_40_fi[32] = { 0, 0, 0, 0, 0, 0x200, 0x200, 0x200, 0x200, 0x200, 0x400, 0x600, 0x800, 0xA00, 0xC00, 0xC00,
+	0xC00, 0xC00, 0xA00, 0x800, 0x600, 0x400, 0x200, 0x200, 0x200, 0x200, 0x200, 0, 0, 0, 0, 0 };
+
+// Indexed by code size, starting from 2 bits
+static const G726Tables g726_tables[4] =
+{
+	{ g726_16_dqln, g726_16_wi, g726_16_fi },
+	{ g726_24_dqln, g726_24_wi, g726_24_fi },
+	{ g726_32_dqln, g726_32_wi, g726_32_fi },
+	{ g726_40_dqln, g726_40_wi, g726_40_fi }
+};
+
+// Same expansion as avcodec uses, so samples don't change when decoding bypasses it
+static int16_t alaw_to_s16(uint8_t value)
+{
+	value ^= 0x55;
+
+	int sample = value & G711_QUANT_MASK;
+	const int segment = (value & G711_SEG_MASK) >> G711_SEG_SHIFT;
+
+	if (segment)
+		sample = (sample + sample + 1 + 32) << (segment + 2);
+	else
+		sample = (sample + sample + 1) << 3;
+
+	return static_cast<int16_t>((value & G711_SIGN_BIT) ? sample : -sample);
+}
+
+static int16_t ulaw_to_s16(uint8_t value)
+{
+	value = ~value;
+
+	int sample = ((value & G711_QUANT_MASK) << 3) + G711_ULAW_BIAS;
+	sample <<= (value & G711_SEG_MASK) >> G711_SEG_SHIFT;
+
+	return static_cast<int16_t>((value & G711_SIGN_BIT) ? G711_ULAW_BIAS - sample : sample - G711_ULAW_BIAS);
+}
+
+static G711Tables create_g711_tables()
+{
+	G711Tables tables;
+
+	for (int i = 0; i < 256; i++)
+	{
+		tables.alaw[i] = alaw_to_s16(static_cast<uint8_t>(i));
+		tables.ulaw[i] = ulaw_to_s16(static_cast<uint8_t>(i));
+	}
+
+	return tables;
+}
+
+static const G711Tables &get_g711_tables()
+{
+	static const G711Tables tables = create_g711_tables();
+	return tables;
+}
+
+static void decode_g711(const uint8_t *raw, int rawLength, int16_t *samples, const int16_t *table)
+{
+	int i = 0;
+
+	for (; i + 4 <= rawLength; i += 4)
+	{
+		samples[i] = table[raw[i]];
+		samples[i + 1] = table[raw[i + 1]];
+		samples[i + 2] = table[raw[i + 2]];
+		samples[i + 3] = table[raw[i + 3]];
+	}
+
+	for (; i < rawLength; i++)
+		samples[i] = table[raw[i]];
+}
+
+// Index of the first power of two that is greater than the value
+static int16_t g726_quan(int value)
+{
+	int16_t i = 0;
+
+	while (i < 15 && value >= (1 << i))
+		i++;
+
+	return i;
+}
+
+// Multiplies a predictor coefficient by a signal in the 4 bit exponent, 6 bit mantissa floating format
+static int16_t g726_fmult(int an, int srn)
+{
+	const int16_t anmag = static_cast<int16_t>(an > 0 ? an : (-an) & 0x1FFF);
+	const int16_t anexp = static_cast<int16_t>(g726_quan(anmag) - 6);
+	const int16_t anmant = static_cast<int16_t>(anmag == 0 ? 32 : anexp >= 0 ? anmag >> anexp : anmag << -anexp);
+	const int16_t wanexp = static_cast<int16_t>(anexp + ((srn >> 6) & 0xF) - 13);
+	const int16_t wanmant = static_cast<int16_t>((anmant * (srn & 0x3F) + 0x30) >> 4);
+	const int16_t result = static_cast<int16_t>(wanexp >= 0 ? (wanmant << wanexp) & 0x7FFF : wanmant >> -wanexp);
+
+	return static_cast<int16_t>((an ^ srn) < 0 ? -result : result);
+}
+
+static void init_g726_state(G726State *state)
+{
+	memset(state, 0, sizeof(G726State));
+
+	state->yl = 34816;
+	state->yu = 544;
+
+	for (int i = 0; i < 2; i++)
+		state->sr[i] = 32;
+
+	for (int i = 0; i < 6; i++)
+		state->dq[i] = 32;
+}
+
+static int16_t g726_step_size(const G726State *state)
+{
+	if (state->ap >= 256)
+		return state->yu;
+
+	int y = state->yl >> 6;
+	const int dif = state->yu - y;
+	const int al = state->ap >> 2;
+
+	if (dif > 0)
+		y += (dif * al) >> 6;
+	else if (dif < 0)
+		y += (dif * al + 0x3F) >> 6;
+
+	return static_cast<int16_t>(y);
+}
+
+// Quantized difference signal in sign magnitude form
+static int16_t g726_reconstruct(int sign, int dqln, int y)
+{
+	const int16_t dql = static_cast<int16_t>(dqln + (y >> 2));
+
+	if (dql < 0)
+		return static_cast<int16_t>(sign ? -0x8000 : 0);
+
+	const int16_t dex = static_cast<int16_t>((dql >> 7) & 15);
+	const int16_t dqt = static_cast<int16_t>(128 + (dql & 127));
+	const int16_t dq = static_cast<int16_t>((dqt << 7) >> (14 - dex));
+
+	return static_cast<int16_t>(sign ? dq - 0x8000 : dq);
+}
+
+static int16_t to_g726_float(int magnitude, bool negative)
+{
+	const int16_t exponent = g726_quan(magnitude);
+	const int value = (exponent << 6) + ((magnitude << 6) >> exponent);
+
+	return static_cast<int16_t>(negative ? value - 0x400 : value);
+}
+
+static void g726_update(G726State *state, int codeSize, int y, int wi, int fi, int dq, int sr, int dqsez)
+{
+	const int16_t pk0 = static_cast<int16_t>(dqsez < 0 ? 1 : 0);
+	const int16_t mag = static_cast<int16_t>(dq & 0x7FFF);
+
+	// Tone and transition detector
+	const int16_t ylint = static_cast<int16_t>(state->yl >> 15);
+	const int16_t ylfrac = static_cast<int16_t>((state->yl >> 10) & 0x1F);
+	const int16_t thr1 = static_cast<int16_t>((32 + ylfrac) << ylint);
+	const int16_t thr2 = static_cast<int16_t>(ylint > 9 ? 31 << 10 : thr1);
+	const int16_t dqthr = static_cast<int16_t>((thr2 + (thr2 >> 1)) >> 1);
+	const bool tr = state->td != 0 && mag > dqthr;
+
+	// Quantizer scale factor adaptation
+	state->yu = static_cast<int16_t>(av_clip(y + ((wi - y) >> 5), 544, 5120));
+	state->yl += state->yu + ((-state->yl) >> 6);
+
+	int16_t a2p = 0;
+
+	if (tr)
+	{
+		memset(state->a, 0, sizeof(state->a));
+		memset(state->b, 0, sizeof(state->b));
+	}
+	else
+	{
+		const int16_t pks1 = static_cast<int16_t>(pk0 ^ state->pk[0]);
+
+		a2p = static_cast<int16_t>(state->a[1] - (state->a[1] >> 7));
+
+		if (dqsez != 0)
+		{
+			const int16_t fa1 = pks1 ? state->a[0] : static_cast<int16_t>(-state->a[0]);
+
+			if (fa1 < -8191)
+				a2p -= 0x100;
+			else if (fa1 > 8191)
+				a2p += 0xFF;
+			else
+				a2p += fa1 >> 5;
+
+			if (pk0 ^ state->pk[1])
+			{
+				if (a2p <= -12160)
+					a2p = -12288;
+				else if (a2p >= 12416)
+					a2p = 12288;
+				else
+					a2p -= 0x80;
+			}
+			else if (a2p <= -12416)
+				a2p = -12288;
+			else if (a2p >= 12160)
+				a2p = 12288;
+			else
+				a2p += 0x80;
+		}
+
+		state->a[1] = a2p;
+
+		state->a[0] -= state->a[0] >> 8;
+
+		if (dqsez != 0)
+			state->a[0] += pks1 == 0 ? 192 : -192;
+
+		const int16_t a1ul = static_cast<int16_t>(15360 - a2p);
+		state->a[0] = static_cast<int16_t>(av_clip(state->a[0], -a1ul, a1ul));
+
+		for (int i = 0; i < 6; i++)
+		{
+			state->b[i] -= state->b[i] >> (codeSize == 5 ? 9 : 8);
+
+			if (dq & 0x7FFF)
+				state->b[i] += (dq ^ state->dq[i]) >= 0 ? 128 : -128;
+		}
+	}
+
+	for (int i = 5; i > 0; i--)
+		state->dq[i] = state->dq[i - 1];
+
+	if (mag == 0)
+		state->dq[0] = static_cast<int16_t>(dq >= 0 ? 0x20 : 0xFC20);
+	else
+		state->dq[0] = to_g726_float(mag, dq < 0);
+
+	state->sr[1] = state->sr[0];
+
+	if (sr == 0)
+		state->sr[0] = 0x20;
+	else if (sr > 0)
+		state->sr[0] = to_g726_float(sr, false);
+	else if (sr > -32768)
+		state->sr[0] = to_g726_float(-sr, true);
+	else
+		state->sr[0] = static_cast<int16_t>(0xFC20);
+
+	state->pk[1] = state->pk[0];
+	state->pk[0] = pk0;
+
+	if (tr)
+		state->td = 0;
+	else
+		state->td = a2p < -11776 ? 1 : 0;
+
+	// Adaptation speed control
+	state->dms += (fi - state->dms) >> 5;
+	state->dml += ((fi << 2) - state->dml) >> 7;
+
+	if (tr)
+		state->ap = 256;
+	else if (y < 1536 || state->td == 1 || abs((state->dms << 2) - state->dml) >= (state->dml >> 3))
+		state->ap += (0x200 - state->ap) >> 4;
+	else
+		state->ap += (-state->ap) >> 4;
+}
+
+static int16_t decode_g726_code(G726State *state, int codeSize, int code)
+{
+	const G726Tables &tables = g726_tables[codeSize - 2];
+
+	int16_t sezi = 0;
+
+	for (int i = 0; i < 6; i++)
+		sezi += g726_fmult(state->b[i] >> 2, state->dq[i]);
+
+	const int16_t sez = sezi >> 1;
+	const int16_t sei = static_cast<int16_t>(sezi + g726_fmult(state->a[1] >> 2, state->sr[1]) + g726_fmult(state->a[0] >> 2, state->sr[0]));
+	const int16_t se = sei >> 1;
+
+	const int16_t y = g726_step_size(state);
+	const int16_t dq = g726_reconstruct(code & (1 << (codeSize - 1)), tables.dqln[code], y);
+	const int16_t sr = static_cast<int16_t>(dq < 0 ? se - (dq & 0x3FFF) : se + dq);
+	const int16_t dqsez = static_cast<int16_t>(sr - se + sez);
+
+	g726_update(state, codeSize, y, tables.wi[code], tables.fi[code], dq, sr, dqsez);
+
+	// Reconstructed signal has 14 bit dynamic range
+	return av_clip_int16(sr * 4);
+}
+
+// Codes are packed starting from the most significant bit, like AV_CODEC_ID_ADPCM_G726 expects them
+static void decode_g726(G726State *state, int codeSize, const uint8_t *raw, int rawLength, int16_t *samples)
+{
+	const int mask = (1 << codeSize) - 1;
+	unsigned int bits = 0;
+	int bitsCount = 0;
+
+	for (int i = 0; i < rawLength; i++)
+	{
+		bits = (bits << 8) | raw[i];
+		bitsCount += 8;
+
+		while (bitsCount >= codeSize)
+		{
+			bitsCount -= codeSize;
+			*samples++ = decode_g726_code(state, codeSize, (bits >> bitsCount) & mask);
+		}
+	}
+}
+
+// Returns -1 for codecs avcodec should be used for
+int init_speech_decoder(SpeechDecoder *decoder, AVCodecID codecId, int bitsPerCodedSample)
+{
+	if (codecId == AV_CODEC_ID_PCM_ALAW || codecId == AV_CODEC_ID_PCM_MULAW)
+	{
+		decoder->codec_id = codecId;
+		decoder->code_size = 8;
+
+		// Tables are built once before any decoder is used
+		get_g711_tables();
+		return 0;
+	}
+
+	if (codecId == AV_CODEC_ID_ADPCM_G726 && bitsPerCodedSample >= 2 && bitsPerCodedSample <= 5)
+	{
+		decoder->codec_id = codecId;
+		decoder->code_size = bitsPerCodedSample;
+
+		init_g726_state(&decoder->g726);
+		return 0;
+	}
+
+	return -1;
+}
+
+int get_speech_samples_count(const SpeechDecoder *decoder, int rawLength)
+{
+	return rawLength * 8 / decoder->code_size;
+}
+
+void decode_speech(SpeechDecoder *decoder, const uint8_t *raw, int rawLength, int16_t *samples)
+{
+	if (decoder->codec_id == AV_CODEC_ID_PCM_ALAW)
+		decode_g711(raw, rawLength, samples, get_g711_tables().alaw);
+	else if (decoder->codec_id == AV_CODEC_ID_PCM_MULAW)
+		decode_g711(raw, rawLength, samples, get_g711_tables().ulaw);
+	else
+		decode_g726(&decoder->g726, decoder->code_size, raw, rawLength, samples);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// State of ITU-T G.726 ADPCM decoder, names follow the recommendation
+struct G726State
+{
+	int yl;
+	int16_t yu;
+	int16_t dms;
+	int16_t dml;
+	int16_t ap;
+	int16_t a[2];
+	int16_t b[6];
+	int16_t pk[2];
+	int16_t dq[6];
+	int16_t sr[2];
+	int td;
+};
+
+// G.711 and G.726 are decoded with tables instead of avcodec, samples go straight to 16 bit output
+struct SpeechDecoder
+{
+	AVCodecID codec_id;
+	int code_size;
+	G726State g726;
+};
+
+int init_speech_decoder(SpeechDecoder *decoder, AVCodecID codecId, int bitsPerCodedSample);
+int get_speech_samples_count(const SpeechDecoder *decoder, int rawLength);
+void decode_speech(SpeechDecoder *decoder, const uint8_t *raw, int rawLength, int16_t *samples);
@@ -11,6 +11,8 @@
 // Windows Header Files:
 #include <Windows.h>
 
+#include <atomic>
+
 extern "C"
 {
 	#include <libavutil/opt.h>
@@ -19,6 +21,7 @@ extern "C"
 	#include <libavutil/common.h>
 	#include <libavutil/imgutils.h>
 	#include <libavutil/mathematics.h>
+	#include <libavutil/motion_vector.h>
 	#include <libavutil/samplefmt.h>
 	#include <libswscale/swscale.h>
     #include <libavutil/samplefmt.h>
@@ -0,0 +1,311 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+#include <emmintrin.h>
+
+#define TENSOR_DATA_TYPE_FLOAT32 0
+#define TENSOR_DATA_TYPE_FLOAT16 1
+
+#define TENSOR_CHANNEL_ORDER_RGB 0
+#define TENSOR_CHANNEL_ORDER_BGR 1
+
+#define TENSOR_CHANNELS 3
+
+struct TensorConverterContext
+{
+	SwsContext *sws_context;
+	int source_height;
+	int tensor_width;
+	int tensor_height;
+	int tensor_data_type;
+	int content_left;
+	int content_top;
+	int content_width;
+	int content_height;
+	// Index of GBRP plane for every tensor channel
+	int channel_planes[TENSOR_CHANNELS];
+	float scale[TENSOR_CHANNELS];
+	float bias[TENSOR_CHANNELS];
+	float pad_value[TENSOR_CHANNELS];
+	// Every byte value maps to a single half, so fp16 output is a table lookup per pixel
+	uint16_t half_lookup[TENSOR_CHANNELS][256];
+	uint8_t *rgb_data[4];
+	int rgb_linesize[4];
+};
+
+static uint16_t float_to_half(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return static_cast<uint16_t>(sign);
+
+		mantissa |= 0x800000;
+
+		const int shift = 14 - exponent;
+		const uint32_t halfway = 1u << (shift - 1);
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t half = mantissa >> shift;
+
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+			half++;
+
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	if (exponent >= 31)
+		return static_cast<uint16_t>(sign | 0x7C00);
+
+	const uint32_t remainder = mantissa & 0x1FFF;
+	uint32_t half = static_cast<uint32_t>(exponent) << 10 | mantissa >> 13;
+
+	// Carry out of the mantissa correctly rounds up into the exponent
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+		half++;
+
+	return static_cast<uint16_t>(sign | half);
+}
+
+static void normalize_row_float32(const uint8_t *source, float *destination, int count, float scale, float bias)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale_vector = _mm_set1_ps(scale);
+	const __m128 bias_vector = _mm_set1_ps(bias);
+
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+		const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+		const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+
+		const __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero));
+		const __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero));
+		const __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero));
+		const __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero));
+
+		_mm_storeu_ps(destination + i, _mm_add_ps(_mm_mul_ps(f0, scale_vector), bias_vector));
+		_mm_storeu_ps(destination + i + 4, _mm_add_ps(_mm_mul_ps(f1, scale_vector), bias_vector));
+		_mm_storeu_ps(destination + i + 8, _mm_add_ps(_mm_mul_ps(f2, scale_vector), bias_vector));
+		_mm_storeu_ps(destination + i + 12, _mm_add_ps(_mm_mul_ps(f3, scale_vector), bias_vector));
+	}
+
+	for (; i < count; i++)
+		destination[i] = source[i] * scale + bias;
+}
+
+static void normalize_row_float16(const uint8_t *source, uint16_t *destination, int count, const uint16_t *lookup)
+{
+	for (int i = 0; i < count; i++)
+		destination[i] = lookup[source[i]];
+}
+
+template <typename T>
+static void fill_span(T *destination, int count, T value)
+{
+	for (int i = 0; i < count; i++)
+		destination[i] = value;
+}
+
+template <typename T, typename TNormalizeRow>
+static void convert_channel(TensorConverterContext *context, int channel, T *destination, T pad_value, TNormalizeRow normalize_row)
+{
+	const uint8_t *source = context->rgb_data[context->channel_planes[channel]];
+	const int source_linesize = context->rgb_linesize[context->channel_planes[channel]];
+	const int right_padding = context->tensor_width - context->content_left - context->content_width;
+
+	for (int y = 0; y < context->tensor_height; y++)
+	{
+		T *row = destination + static_cast<ptrdiff_t>(y) * context->tensor_width;
+
+		if (y < context->content_top || y >= context->content_top + context->content_height)
+		{
+			fill_span(row, context->tensor_width, pad_value);
+			continue;
+		}
+
+		fill_span(row, context->content_left, pad_value);
+
+		normalize_row(source + static_cast<ptrdiff_t>(y - context->content_top) * source_linesize,
+			row + context->content_left, context->content_width);
+
+		fill_span(row + context->content_left + context->content_width, right_padding, pad_value);
+	}
+}
+
+static int convert_video_frame_to_tensor(const AVFrame *frame, TensorConverterContext *context, void *tensorBuffer, int batchIndex)
+{
+	if (sws_scale(context->sws_context, frame->data, frame->linesize, 0, context->source_height,
+		context->rgb_data, context->rgb_linesize) <= 0)
+		return -2;
+
+	const ptrdiff_t channel_size = static_cast<ptrdiff_t>(context->tensor_width) * context->tensor_height;
+	const ptrdiff_t batch_offset = channel_size * TENSOR_CHANNELS * batchIndex;
+
+	for (int channel = 0; channel < TENSOR_CHANNELS; channel++)
+	{
+		if (context->tensor_data_type == TENSOR_DATA_TYPE_FLOAT16)
+		{
+			uint16_t *destination = static_cast<uint16_t *>(tensorBuffer) + batch_offset + channel_size * channel;
+			const uint16_t *lookup = context->half_lookup[channel];
+
+			convert_channel(context, channel, destination, float_to_half(context->pad_value[channel]),
+				[lookup](const uint8_t *source, uint16_t *row, int count) { normalize_row_float16(source, row, count, lookup); });
+		}
+		else
+		{
+			float *destination = static_cast<float *>(tensorBuffer) + batch_offset + channel_size * channel;
+			const float scale = context->scale[channel];
+			const float bias = context->bias[channel];
+
+			convert_channel(context, channel, destination, context->pad_value[channel],
+				[scale, bias](const uint8_t *source, float *row, int count) { normalize_row_float32(source, row, count, scale, bias); });
+		}
+	}
+
+	return 0;
+}
+
+int create_video_tensor_converter(int sourceWidth, int sourceHeight, int sourcePixelFormat, int tensorWidth, int tensorHeight,
+	int tensorDataType, int channelOrder, float *mean, float *stdDev, int padColor, int letterbox, int quality, void **handle)
+{
+	if (!handle || !mean || !stdDev)
+		return -1;
+
+	if (tensorDataType != TENSOR_DATA_TYPE_FLOAT32 && tensorDataType != TENSOR_DATA_TYPE_FLOAT16)
+		return -2;
+
+	if (channelOrder != TENSOR_CHANNEL_ORDER_RGB && channelOrder != TENSOR_CHANNEL_ORDER_BGR)
+		return -3;
+
+	auto context = static_cast<TensorConverterContext *>(av_mallocz(sizeof(TensorConverterContext)));
+
+	if (!context)
+		return -4;
+
+	context->source_height = sourceHeight;
+	context->tensor_width = tensorWidth;
+	context->tensor_height = tensorHeight;
+	context->tensor_data_type = tensorDataType;
+
+	if (letterbox && static_cast<int64_t>(tensorWidth) * sourceHeight != static_cast<int64_t>(tensorHeight) * sourceWidth)
+	{
+		if (static_cast<int64_t>(tensorWidth) * sourceHeight < static_cast<int64_t>(tensorHeight) * sourceWidth)
+		{
+			context->content_width = tensorWidth;
+			context->content_height = FFMAX(1, static_cast<int>(static_cast<int64_t>(sourceHeight) * tensorWidth / sourceWidth));
+		}
+		else
+		{
+			context->content_width = FFMAX(1, static_cast<int>(static_cast<int64_t>(sourceWidth) * tensorHeight / sourceHeight));
+			context->content_height = tensorHeight;
+		}
+
+		context->content_left = (tensorWidth - context->content_width) / 2;
+		context->content_top = (tensorHeight - context->content_height) / 2;
+	}
+	else
+	{
+		context->content_width = tensorWidth;
+		context->content_height = tensorHeight;
+	}
+
+	// AV_PIX_FMT_GBRP planes are G, B, R
+	if (channelOrder == TENSOR_CHANNEL_ORDER_RGB)
+	{
+		context->channel_planes[0] = 2;
+		context->channel_planes[1] = 0;
+		context->channel_planes[2] = 1;
+	}
+	else
+	{
+		context->channel_planes[0] = 1;
+		context->channel_planes[1] = 0;
+		context->channel_planes[2] = 2;
+	}
+
+	const int pad_components[TENSOR_CHANNELS] = { (padColor >> 16) & 0xFF, (padColor >> 8) & 0xFF, padColor & 0xFF };
+
+	for (int channel = 0; channel < TENSOR_CHANNELS; channel++)
+	{
+		if (stdDev[channel] == 0)
+		{
+			remove_video_tensor_converter(context);
+			return -5;
+		}
+
+		// (x / 255 - mean) / std folded into a single multiply-add
+		context->scale[channel] = 1.0f / (255.0f * stdDev[channel]);
+		context->bias[channel] = -mean[channel] / stdDev[channel];
+
+		const int pad_component = pad_components[channelOrder == TENSOR_CHANNEL_ORDER_RGB ? channel : TENSOR_CHANNELS - 1 - channel];
+		context->pad_value[channel] = pad_component * context->scale[channel] + context->bias[channel];
+
+		for (int i = 0; i < 256; i++)
+			context->half_lookup[channel][i] = float_to_half(i * context->scale[channel] + context->bias[channel]);
+	}
+
+	context->sws_context = sws_getContext(sourceWidth, sourceHeight, static_cast<AVPixelFormat>(sourcePixelFormat),
+		context->content_width, context->content_height, AV_PIX_FMT_GBRP, quality, nullptr, nullptr, nullptr);
+
+	if (!context->sws_context)
+	{
+		remove_video_tensor_converter(context);
+		return -6;
+	}
+
+	if (av_image_alloc(context->rgb_data, context->rgb_linesize, context->content_width, context->content_height, AV_PIX_FMT_GBRP, 16) < 0)
+	{
+		remove_video_tensor_converter(context);
+		return -7;
+	}
+
+	*handle = context;
+	return 0;
+}
+
+int convert_decoded_video_frame_to_tensor(void *handle, void *converterHandle, void *tensorBuffer, int batchIndex)
+{
+#if _DEBUG
+	if (!handle || !converterHandle || !tensorBuffer || batchIndex < 0)
+		return -1;
+#endif
+
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+	const auto converterContext = static_cast<TensorConverterContext *>(converterHandle);
+
+	return convert_video_frame_to_tensor(context->frame, converterContext, tensorBuffer, batchIndex);
+}
+
+int convert_acquired_video_frame_to_tensor(void *frameHandle, void *converterHandle, void *tensorBuffer, int batchIndex)
+{
+#if _DEBUG
+	if (!frameHandle || !converterHandle || !tensorBuffer || batchIndex < 0)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+	const auto converterContext = static_cast<TensorConverterContext *>(converterHandle);
+
+	return convert_video_frame_to_tensor(frameContext->frame, converterContext, tensorBuffer, batchIndex);
+}
+
+void remove_video_tensor_converter(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<TensorConverterContext *>(handle);
+
+	sws_freeContext(context->sws_context);
+	av_freep(&context->rgb_data[0]);
+	av_free(context);
+}
@@ -0,0 +1,306 @@
+#include "stdafx.h"
+#include "videodecoding.h"
+
+// One bit per tile in dirty mask
+#define MAX_COMPOSITOR_TILES 64
+
+struct CompositorTile
+{
+	int left;
+	int top;
+	int width;
+	int height;
+	// Tile area inside the border, scaled pictures are placed here
+	int inner_left;
+	int inner_top;
+	int inner_width;
+	int inner_height;
+	// Scaler is created lazily for the current source geometry of the tile
+	ScalerContext *scaler_context;
+	int source_width;
+	int source_height;
+	AVPixelFormat source_pixel_format;
+};
+
+struct CompositorContext
+{
+	int width;
+	int height;
+	AVPixelFormat pixel_format;
+	const AVPixFmtDescriptor *fmt_desc;
+	int fill_color;
+	int border_width;
+	int keep_aspect_ratio;
+	int quality;
+	uint8_t fill_pattern[4][4];
+	uint8_t border_pattern[4][4];
+	uint8_t *surface_data[4];
+	int surface_linesize[4];
+	CompositorTile tiles[MAX_COMPOSITOR_TILES];
+	std::atomic<uint64_t> dirty_tiles;
+};
+
+static int align_down(int value, int log2Alignment)
+{
+	return value & ~((1 << log2Alignment) - 1);
+}
+
+static int create_tile_scaler(CompositorContext *context, CompositorTile *tile, const AVFrame *frame)
+{
+	const int log2_chroma_w = context->fmt_desc->log2_chroma_w;
+	const int log2_chroma_h = context->fmt_desc->log2_chroma_h;
+	int content_width = tile->inner_width;
+	int content_height = tile->inner_height;
+
+	if (context->keep_aspect_ratio)
+	{
+		if (static_cast<int64_t>(tile->inner_width) * frame->height < static_cast<int64_t>(tile->inner_height) * frame->width)
+			content_height = static_cast<int>(static_cast<int64_t>(frame->height) * tile->inner_width / frame->width);
+		else
+			content_width = static_cast<int>(static_cast<int64_t>(frame->width) * tile->inner_height / frame->height);
+
+		content_width = align_down(content_width, log2_chroma_w);
+		content_height = align_down(content_height, log2_chroma_h);
+
+		if (content_width <= 0 || content_height <= 0)
+			return -6;
+	}
+
+	remove_video_scaler(tile->scaler_context);
+	tile->scaler_context = nullptr;
+
+	void *scalerHandle;
+	const int result = create_video_scaler(0, 0, frame->width, frame->height, frame->format, content_width, content_height,
+		context->pixel_format, context->quality, tile->inner_width, tile->inner_height, 0, 0, context->fill_color, &scalerHandle);
+
+	if (result != 0)
+		return result;
+
+	tile->scaler_context = static_cast<ScalerContext *>(scalerHandle);
+	tile->source_width = frame->width;
+	tile->source_height = frame->height;
+	tile->source_pixel_format = static_cast<AVPixelFormat>(frame->format);
+	return 0;
+}
+
+static int compose_video_frame(CompositorContext *context, int tileIndex, const AVFrame *frame)
+{
+	CompositorTile *tile = &context->tiles[tileIndex];
+
+	if (tile->inner_width <= 0 || tile->inner_height <= 0)
+		return -2;
+
+	if (frame->width <= 0 || frame->height <= 0)
+		return -3;
+
+	if (!tile->scaler_context || tile->source_width != frame->width || tile->source_height != frame->height ||
+		tile->source_pixel_format != frame->format)
+	{
+		const int result = create_tile_scaler(context, tile, frame);
+
+		if (result != 0)
+			return -100 + result;
+	}
+
+	uint8_t *tilePlanes[4];
+	int tilePlaneStrides[4];
+
+	offset_image_planes(context->pixel_format, context->surface_data, context->surface_linesize,
+		tile->inner_left, tile->inner_top, tilePlanes);
+	memcpy(tilePlaneStrides, context->surface_linesize, sizeof(tilePlaneStrides));
+
+	const int result = scale_video_frame(frame, tile->scaler_context, tilePlanes, tilePlaneStrides);
+
+	if (result != 0)
+		return result;
+
+	context->dirty_tiles.fetch_or(static_cast<uint64_t>(1) << tileIndex);
+	return 0;
+}
+
+int create_video_compositor(int width, int height, int pixelFormat, int fillColor, int borderColor, int borderWidth,
+	int keepAspectRatio, int quality, void **handle)
+{
+	if (!handle || width <= 0 || height <= 0 || borderWidth < 0)
+		return -1;
+
+	const auto avPixelFormat = static_cast<AVPixelFormat>(pixelFormat);
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(avPixelFormat);
+
+	if (!fmtDesc)
+		return -4;
+
+	auto context = static_cast<CompositorContext *>(av_mallocz(sizeof(CompositorContext)));
+
+	if (!context)
+		return -2;
+
+	context->width = width;
+	context->height = height;
+	context->pixel_format = avPixelFormat;
+	context->fmt_desc = fmtDesc;
+	context->fill_color = fillColor;
+	context->border_width = borderWidth;
+	context->keep_aspect_ratio = keepAspectRatio;
+	context->quality = quality;
+	context->dirty_tiles = 0;
+
+	if (get_fill_pattern(avPixelFormat, fillColor, context->fill_pattern) != 0 ||
+		get_fill_pattern(avPixelFormat, borderColor, context->border_pattern) != 0)
+	{
+		remove_video_compositor(context);
+		return -5;
+	}
+
+	if (av_image_alloc(context->surface_data, context->surface_linesize, width, height, avPixelFormat, 16) < 0)
+	{
+		remove_video_compositor(context);
+		return -3;
+	}
+
+	fill_image_rect(avPixelFormat, context->surface_data, context->surface_linesize, 0, 0, width, height, context->fill_pattern);
+
+	*handle = context;
+	return 0;
+}
+
+int set_video_compositor_tile(void *handle, int tileIndex, int left, int top, int width, int height)
+{
+	if (!handle || tileIndex < 0 || tileIndex >= MAX_COMPOSITOR_TILES)
+		return -1;
+
+	const auto context = static_cast<CompositorContext *>(handle);
+	const int log2_chroma_w = context->fmt_desc->log2_chroma_w;
+	const int log2_chroma_h = context->fmt_desc->log2_chroma_h;
+
+	// Tile edges should not split subsampled chroma samples of the surface
+	left = align_down(left, log2_chroma_w);
+	top = align_down(top, log2_chroma_h);
+	width = align_down(width, log2_chroma_w);
+	height = align_down(height, log2_chroma_h);
+
+	if (left < 0 || top < 0 || width < 0 || height < 0 || left + width > context->width || top + height > context->height)
+		return -2;
+
+	CompositorTile *tile = &context->tiles[tileIndex];
+
+	remove_video_scaler(tile->scaler_context);
+	tile->scaler_context = nullptr;
+
+	tile->left = left;
+	tile->top = top;
+	tile->width = width;
+	tile->height = height;
+
+	const int border_width = align_down(context->border_width + (1 << FFMAX(log2_chroma_w, log2_chroma_h)) - 1,
+		FFMAX(log2_chroma_w, log2_chroma_h));
+
+	tile->inner_left = left + border_width;
+	tile->inner_top = top + border_width;
+	tile->inner_width = FFMAX(0, width - 2 * border_width);
+	tile->inner_height = FFMAX(0, height - 2 * border_width);
+
+	fill_image_rect(context->pixel_format, context->surface_data, context->surface_linesize, left, top, width, height,
+		context->border_pattern);
+	fill_image_rect(context->pixel_format, context->surface_data, context->surface_linesize, tile->inner_left, tile->inner_top,
+		tile->inner_width, tile->inner_height, context->fill_pattern);
+
+	context->dirty_tiles.fetch_or(static_cast<uint64_t>(1) << tileIndex);
+	return 0;
+}
+
+int compose_decoded_video_frame(void *compositorHandle, int tileIndex, void *decoderHandle)
+{
+#if _DEBUG
+	if (!compositorHandle || !decoderHandle || tileIndex < 0 || tileIndex >= MAX_COMPOSITOR_TILES)
+		return -1;
+#endif
+
+	const auto context = static_cast<CompositorContext *>(compositorHandle);
+	const auto decoderContext = static_cast<VideoDecoderContext *>(decoderHandle);
+
+	return compose_video_frame(context, tileIndex, decoderContext->frame);
+}
+
+int compose_acquired_video_frame(void *compositorHandle, int tileIndex, void *frameHandle)
+{
+#if _DEBUG
+	if (!compositorHandle || !frameHandle || tileIndex < 0 || tileIndex >= MAX_COMPOSITOR_TILES)
+		return -1;
+#endif
+
+	const auto context = static_cast<CompositorContext *>(compositorHandle);
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+
+	return compose_video_frame(context, tileIndex, frameContext->frame);
+}
+
+int get_video_compositor_surface(void *handle, void **planes, int *strides)
+{
+#if _DEBUG
+	if (!handle || !planes || !strides)
+		return -1;
+#endif
+
+	const auto context = static_cast<CompositorContext *>(handle);
+
+	for (int i = 0; i < 4; i++)
+	{
+		planes[i] = context->surface_data[i];
+		strides[i] = context->surface_linesize[i];
+	}
+
+	return 0;
+}
+
+int get_video_compositor_dirty_rects(void *handle, int *rects, int maxRectsCount, int *rectsCount)
+{
+#if _DEBUG
+	if (!handle || !rects || maxRectsCount < 0 || !rectsCount)
+		return -1;
+#endif
+
+	const auto context = static_cast<CompositorContext *>(handle);
+	uint64_t dirty_tiles = context->dirty_tiles.exchange(0);
+	int count = 0;
+
+	for (int i = 0; i < MAX_COMPOSITOR_TILES && dirty_tiles != 0 && count < maxRectsCount; i++)
+	{
+		const uint64_t tile_bit = static_cast<uint64_t>(1) << i;
+
+		if (!(dirty_tiles & tile_bit))
+			continue;
+
+		dirty_tiles &= ~tile_bit;
+
+		const CompositorTile *tile = &context->tiles[i];
+		int *rect = rects + count * 4;
+
+		rect[0] = tile->left;
+		rect[1] = tile->top;
+		rect[2] = tile->width;
+		rect[3] = tile->height;
+		count++;
+	}
+
+	// Tiles that didn't fit are reported on the next call
+	if (dirty_tiles != 0)
+		context->dirty_tiles.fetch_or(dirty_tiles);
+
+	*rectsCount = count;
+	return 0;
+}
+
+void remove_video_compositor(void *handle)
+{
+	if (!handle)
+		return;
+
+	auto context = static_cast<CompositorContext *>(handle);
+
+	for (int i = 0; i < MAX_COMPOSITOR_TILES; i++)
+		remove_video_scaler(context->tiles[i].scaler_context);
+
+	av_freep(&context->surface_data[0]);
+	av_free(context);
+}
@@ -1,24 +1,5 @@
 #include "stdafx.h"
-
-struct VideoDecoderContext
-{
-	AVCodec *codec;
-	AVCodecContext *av_codec_context;
-	AVPacket av_raw_packet;
-	AVFrame *frame;
-};
-
-struct ScalerContext
-{
-	SwsContext *sws_context;
-	int source_left;
-	int source_top;
-	int source_height;
-	AVPixelFormat source_pixel_format;
-	int scaled_width;
-	int scaled_height;
-	AVPixelFormat scaled_pixel_format;
-};
+#include "videodecoding.h"
 
 int create_video_decoder(int codec_id, void **handle)
 {
@@ -30,6 +11,10 @@ int create_video_decoder(int codec_id, void **handle)
 	if (!context)
 		return -2;
 
+	context->references = 1;
+	context->acquired_frames = 0;
+	context->max_acquired_frames = DEFAULT_MAX_ACQUIRED_FRAMES;
+
 	context->codec = avcodec_find_decoder(static_cast<AVCodecID>(codec_id));
 	if (!context->codec)
 	{
@@ -93,18 +78,89 @@ int set_video_decoder_extradata(void *handle, void *extradata, int extradataLeng
 	return 0;
 }
 
-int decode_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int *frameWidth, int *frameHeight, int *framePixelFormat)
+// Picture structure of draw_horiz_band for progressive frames, field bands are not converted
+#define BAND_PICTURE_FRAME 3
+
+// Called by the decoder for every finished row band of the picture, so conversion of the upper rows overlaps decoding of the lower ones
+static void convert_decoded_band(AVCodecContext *codecContext, const AVFrame *source, int offset[AV_NUM_DATA_POINTERS], int y, int type, int height)
+{
+	const auto context = static_cast<VideoDecoderContext *>(codecContext->opaque);
+	ScalerContext *scalerContext = context->scaler_context;
+
+	if (!context->band_planes[0])
+		return;
+
+	if (y == 0)
+	{
+		context->band_source = source->data[0];
+		context->band_rows = 0;
+	}
+
+	// Conversion of the picture is valid only while its bands come top to bottom without gaps
+	if (type != BAND_PICTURE_FRAME || source->data[0] != context->band_source || y != context->band_rows ||
+		source->width != scalerContext->source_width || source->format != scalerContext->source_pixel_format)
+	{
+		context->band_source = nullptr;
+		return;
+	}
+
+	// Rows below the cropped picture are decoded too, but they are not part of the output
+	height = FFMIN(height, scalerContext->source_height - y);
+
+	if (height <= 0)
+		return;
+
+	uint8_t *sourcePlanes[4] = {};
+	const int planes = av_pix_fmt_count_planes(scalerContext->source_pixel_format);
+
+	for (int i = 0; i < planes; i++)
+		sourcePlanes[i] = source->data[i] + offset[i];
+
+	uint8_t *contentPlanes[4];
+
+	offset_image_planes(scalerContext->scaled_pixel_format, context->band_planes, context->band_strides,
+		scalerContext->content_left, scalerContext->content_top, contentPlanes);
+
+	if (scalerContext->sws_context)
+	{
+		// swscale keeps the vertical filter state between slices of one picture, the slice starting at zero resets it
+		if (sws_scale(scalerContext->sws_context, sourcePlanes, source->linesize, y, height, contentPlanes, context->band_strides) < 0)
+		{
+			context->band_source = nullptr;
+			return;
+		}
+	}
+	else
+	{
+		uint8_t *rowPlanes[4];
+
+		offset_image_planes(scalerContext->scaled_pixel_format, contentPlanes, context->band_strides, 0, y, rowPlanes);
+		av_image_copy(rowPlanes, context->band_strides, const_cast<const uint8_t **>(sourcePlanes), source->linesize,
+			scalerContext->scaled_pixel_format, scalerContext->scaled_width, height);
+	}
+
+	context->band_rows = y + height;
+}
+
+int set_video_decoder_band_conversion(void *handle, int enabled)
 {
 #if _DEBUG
-	if (!handle || !rawBuffer || !rawBufferLength || !frameWidth || !frameHeight || !framePixelFormat)
+	if (!handle)
 		return -1;
-
-	if (reinterpret_cast<uintptr_t>(rawBuffer) % 4 != 0)
-		return -2;
 #endif
 
-	auto context = static_cast<VideoDecoderContext *>(handle);
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+
+	// Decoder checks the callback for every row, so it can be changed between packets. Codecs without
+	// band support and pictures output out of decoding order just take the regular path
+	context->av_codec_context->opaque = context;
+	context->av_codec_context->draw_horiz_band = enabled ? convert_decoded_band : nullptr;
+	context->band_conversion = enabled;
+	return 0;
+}
 
+static int decode_video_packet(VideoDecoderContext *context, void *rawBuffer, int rawBufferLength)
+{
 	context->av_raw_packet.data = static_cast<uint8_t *>(rawBuffer);
 	context->av_raw_packet.size = rawBufferLength;
 
@@ -115,15 +171,390 @@ int decode_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int *
 	if (len != rawBufferLength)
 		return -3;
 
-	if (got_frame)
+	return got_frame ? 0 : -4;
+}
+
+int decode_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int *frameWidth, int *frameHeight, int *framePixelFormat)
+{
+#if _DEBUG
+	if (!handle || !rawBuffer || !rawBufferLength || !frameWidth || !frameHeight || !framePixelFormat)
+		return -1;
+
+	if (reinterpret_cast<uintptr_t>(rawBuffer) % 4 != 0)
+		return -2;
+#endif
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+
+	const int result = decode_video_packet(context, rawBuffer, rawBufferLength);
+
+	if (result != 0)
+		return result;
+
+	*frameWidth = context->av_codec_context->width;
+	*frameHeight = context->av_codec_context->height;
+	*framePixelFormat = context->av_codec_context->pix_fmt;
+	return 0;
+}
+
+int flush_video_decoder(void *handle)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+
+	// Acquired frames hold their own references, so only the decoder state and the last frame are dropped
+	avcodec_flush_buffers(context->av_codec_context);
+	av_frame_unref(context->frame);
+	return 0;
+}
+
+int set_video_decoder_error_options(void *handle, int concealErrors, int outputCorruptFrames, int outputAllFrames)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	AVCodecContext *codecContext = static_cast<VideoDecoderContext *>(handle)->av_codec_context;
+
+	codecContext->error_concealment = concealErrors ? FF_EC_GUESS_MVS | FF_EC_DEBLOCK : 0;
+
+	if (outputCorruptFrames)
+		codecContext->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT;
+	else
+		codecContext->flags &= ~AV_CODEC_FLAG_OUTPUT_CORRUPT;
+
+	// Frames referencing pictures lost before flush are output too instead of waiting for the next key frame
+	if (outputAllFrames)
+		codecContext->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
+	else
+		codecContext->flags2 &= ~AV_CODEC_FLAG2_SHOW_ALL;
+
+	return 0;
+}
+
+int get_decoded_video_frame_error_flags(void *handle, int *errorFlags)
+{
+#if _DEBUG
+	if (!handle || !errorFlags)
+		return -1;
+#endif
+
+	const AVFrame *frame = static_cast<VideoDecoderContext *>(handle)->frame;
+	int flags = 0;
+
+	if (frame->flags & AV_FRAME_FLAG_CORRUPT)
+		flags |= VIDEO_FRAME_ERROR_CORRUPT;
+
+	if (frame->decode_error_flags & FF_DECODE_ERROR_INVALID_BITSTREAM)
+		flags |= VIDEO_FRAME_ERROR_INVALID_BITSTREAM;
+
+	if (frame->decode_error_flags & FF_DECODE_ERROR_MISSING_REFERENCE)
+		flags |= VIDEO_FRAME_ERROR_MISSING_REFERENCE;
+
+	*errorFlags = flags;
+	return 0;
+}
+
+int set_video_decoder_analysis_options(void *handle, int exportMotionVectors, int skipLoopFilter)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	const auto context = static_cast<VideoDecoderContext *>(handle);
+
+	// Both options are checked by the decoder on every frame, so they can be changed while decoding
+	if (exportMotionVectors)
+		context->av_codec_context->flags2 |= AV_CODEC_FLAG2_EXPORT_MVS;
+	else
+		context->av_codec_context->flags2 &= ~AV_CODEC_FLAG2_EXPORT_MVS;
+
+	context->av_codec_context->skip_loop_filter = skipLoopFilter ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+	return 0;
+}
+
+void get_source_planes(const AVFrame *frame, ScalerContext *scalerContext, uint8_t *srcData[4])
+{
+	if (scalerContext->source_top != 0 || scalerContext->source_left != 0)
 	{
-		*frameWidth = context->av_codec_context->width;
-		*frameHeight = context->av_codec_context->height;
-		*framePixelFormat = context->av_codec_context->pix_fmt;
-		return 0;
+		const AVPixFmtDescriptor *sourceFmtDesc = av_pix_fmt_desc_get(scalerContext->source_pixel_format);
+
+		const int x_shift = sourceFmtDesc->log2_chroma_w;
+		const int y_shift = sourceFmtDesc->log2_chroma_h;
+
+		srcData[0] = frame->data[0] + scalerContext->source_top * frame->linesize[0] + scalerContext->source_left;
+		srcData[1] = frame->data[1] + (scalerContext->source_top >> y_shift) * frame->linesize[1] + (scalerContext->source_left >> x_shift);
+		srcData[2] = frame->data[2] + (scalerContext->source_top >> y_shift) * frame->linesize[2] + (scalerContext->source_left >> x_shift);
+		srcData[3] = nullptr;
+	}
+	else
+	{
+		for (int i = 0; i < 4; i++)
+			srcData[i] = frame->data[i];
+	}
+}
+
+// Lays out the planes of scaled image one after another in a single buffer, chroma plane strides are derived
+// from the luma stride, so I420 is Y, U, V with halved strides, NV12 is Y and UV with the same stride
+// Returns size of the buffer occupied by all planes
+int fill_scaled_planes(ScalerContext *scalerContext, uint8_t *scaledBuffer, int scaledBufferStride,
+	uint8_t *scaledPlanes[4], int scaledPlaneStrides[4])
+{
+	const AVPixFmtDescriptor *scaledFmtDesc = scalerContext->scaled_fmt_desc;
+	uint8_t *plane = scaledBuffer;
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (i >= scalerContext->scaled_plane_count)
+		{
+			scaledPlanes[i] = nullptr;
+			scaledPlaneStrides[i] = 0;
+			continue;
+		}
+
+		const bool is_chroma = i == 1 || i == 2;
+		const int x_shift = is_chroma ? scaledFmtDesc->log2_chroma_w : 0;
+		const int y_shift = is_chroma ? scaledFmtDesc->log2_chroma_h : 0;
+
+		scaledPlanes[i] = plane;
+		scaledPlaneStrides[i] = scaledBufferStride * scalerContext->scaled_plane_steps[i] / scalerContext->scaled_plane_steps[0] >> x_shift;
+
+		plane += scaledPlaneStrides[i] * AV_CEIL_RSHIFT(scalerContext->target_height, y_shift);
+	}
+
+	return static_cast<int>(plane - scaledBuffer);
+}
+
+static int get_plane_height(const AVPixFmtDescriptor *fmtDesc, int plane, int height)
+{
+	return plane == 1 || plane == 2 ? AV_CEIL_RSHIFT(height, fmtDesc->log2_chroma_h) : height;
+}
+
+static int get_plane_width(const AVPixFmtDescriptor *fmtDesc, int plane, int width)
+{
+	return plane == 1 || plane == 2 ? AV_CEIL_RSHIFT(width, fmtDesc->log2_chroma_w) : width;
+}
+
+static void fill_row(uint8_t *row, int begin, int end, const uint8_t *pattern, int patternSize)
+{
+	if (patternSize == 1)
+	{
+		memset(row + begin, pattern[0], end - begin);
+		return;
+	}
+
+	for (int i = begin; i < end; i++)
+		row[i] = pattern[i % patternSize];
+}
+
+void offset_image_planes(AVPixelFormat pixelFormat, uint8_t *planes[4], const int strides[4], int left, int top, uint8_t *offsetPlanes[4])
+{
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(pixelFormat);
+	const int plane_count = av_pix_fmt_count_planes(pixelFormat);
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (i >= plane_count)
+		{
+			offsetPlanes[i] = nullptr;
+			continue;
+		}
+
+		offsetPlanes[i] = planes[i] + static_cast<ptrdiff_t>(get_plane_height(fmtDesc, i, top)) * strides[i] +
+			av_image_get_linesize(pixelFormat, left, i);
+	}
+}
+
+void fill_image_rect(AVPixelFormat pixelFormat, uint8_t *planes[4], const int strides[4], int left, int top, int width, int height,
+	const uint8_t fillPattern[4][4])
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	const AVPixFmtDescriptor *fmtDesc = av_pix_fmt_desc_get(pixelFormat);
+	const int plane_count = av_pix_fmt_count_planes(pixelFormat);
+	int plane_steps[4];
+
+	av_image_fill_max_pixsteps(plane_steps, nullptr, fmtDesc);
+
+	for (int i = 0; i < plane_count; i++)
+	{
+		const int begin = av_image_get_linesize(pixelFormat, left, i);
+		const int end = begin + av_image_get_linesize(pixelFormat, width, i);
+		const int first_row = get_plane_height(fmtDesc, i, top);
+		const int last_row = first_row + get_plane_height(fmtDesc, i, height);
+
+		for (int y = first_row; y < last_row; y++)
+			fill_row(planes[i] + static_cast<ptrdiff_t>(y) * strides[i], begin, end, fillPattern[i], plane_steps[i]);
+	}
+}
+
+// Only the letterbox borders around content rectangle are filled, content is overwritten by the scaled picture anyway
+static void fill_borders(ScalerContext *scalerContext, uint8_t *scaledPlanes[4], int scaledPlaneStrides[4])
+{
+	const int content_right = scalerContext->content_left + scalerContext->content_width;
+	const int content_bottom = scalerContext->content_top + scalerContext->content_height;
+	const AVPixelFormat pixelFormat = scalerContext->scaled_pixel_format;
+
+	if (scalerContext->content_width == scalerContext->target_width && scalerContext->content_height == scalerContext->target_height)
+		return;
+
+	fill_image_rect(pixelFormat, scaledPlanes, scaledPlaneStrides, 0, 0,
+		scalerContext->target_width, scalerContext->content_top, scalerContext->fill_pattern);
+	fill_image_rect(pixelFormat, scaledPlanes, scaledPlaneStrides, 0, content_bottom,
+		scalerContext->target_width, scalerContext->target_height - content_bottom, scalerContext->fill_pattern);
+	fill_image_rect(pixelFormat, scaledPlanes, scaledPlaneStrides, 0, scalerContext->content_top,
+		scalerContext->content_left, scalerContext->content_height, scalerContext->fill_pattern);
+	fill_image_rect(pixelFormat, scaledPlanes, scaledPlaneStrides, content_right, scalerContext->content_top,
+		scalerContext->target_width - content_right, scalerContext->content_height, scalerContext->fill_pattern);
+}
+
+// Copies every pixel (x, y) of the plane to origin + x * stepX + y * stepY, walking in tiles so that
+// rotations by 90 degrees stay cache friendly on both source and destination sides
+template <int PixelSize>
+static void remap_plane(const uint8_t *source, int sourceStride, int width, int height, uint8_t *origin, ptrdiff_t stepX, ptrdiff_t stepY)
+{
+	const int tile_size = 32;
+
+	for (int tile_y = 0; tile_y < height; tile_y += tile_size)
+	{
+		const int tile_bottom = FFMIN(tile_y + tile_size, height);
+
+		for (int tile_x = 0; tile_x < width; tile_x += tile_size)
+		{
+			const int tile_right = FFMIN(tile_x + tile_size, width);
+
+			for (int y = tile_y; y < tile_bottom; y++)
+			{
+				const uint8_t *src = source + static_cast<ptrdiff_t>(y) * sourceStride + tile_x * PixelSize;
+				uint8_t *dst = origin + y * stepY + tile_x * stepX;
+
+				for (int x = tile_x; x < tile_right; x++, src += PixelSize, dst += stepX)
+					memcpy(dst, src, PixelSize);
+			}
+		}
+	}
+}
+
+static void rotate_plane(ScalerContext *scalerContext, int plane, const uint8_t *source, int sourceStride, uint8_t *destination, int destinationStride)
+{
+	const AVPixFmtDescriptor *fmtDesc = scalerContext->scaled_fmt_desc;
+	const int width = get_plane_width(fmtDesc, plane, scalerContext->scaled_width);
+	const int height = get_plane_height(fmtDesc, plane, scalerContext->scaled_height);
+	const int rotated_width = get_plane_width(fmtDesc, plane, scalerContext->content_width);
+	const int pixel_size = scalerContext->scaled_plane_steps[plane];
+
+	// Destination position of source pixel (x, y) is (origin_x + x * ax + y * bx, origin_y + x * ay + y * by)
+	int origin_x = 0, origin_y = 0, ax = 1, ay = 0, bx = 0, by = 1;
+
+	switch (scalerContext->rotation)
+	{
+	case 90:
+		origin_x = height - 1; ax = 0; ay = 1; bx = -1; by = 0;
+		break;
+	case 180:
+		origin_x = width - 1; origin_y = height - 1; ax = -1; ay = 0; bx = 0; by = -1;
+		break;
+	case 270:
+		origin_y = width - 1; ax = 0; ay = -1; bx = 1; by = 0;
+		break;
+	default:
+		break;
+	}
+
+	if (scalerContext->mirror)
+	{
+		origin_x = rotated_width - 1 - origin_x;
+		ax = -ax;
+		bx = -bx;
+	}
+
+	uint8_t *origin = destination + static_cast<ptrdiff_t>(origin_y) * destinationStride + origin_x * pixel_size;
+	const ptrdiff_t step_x = static_cast<ptrdiff_t>(ay) * destinationStride + ax * pixel_size;
+	const ptrdiff_t step_y = static_cast<ptrdiff_t>(by) * destinationStride + bx * pixel_size;
+
+	switch (pixel_size)
+	{
+	case 1:
+		remap_plane<1>(source, sourceStride, width, height, origin, step_x, step_y);
+		break;
+	case 2:
+		remap_plane<2>(source, sourceStride, width, height, origin, step_x, step_y);
+		break;
+	case 3:
+		remap_plane<3>(source, sourceStride, width, height, origin, step_x, step_y);
+		break;
+	default:
+		remap_plane<4>(source, sourceStride, width, height, origin, step_x, step_y);
+		break;
+	}
+}
+
+int scale_video_frame(const AVFrame *frame, ScalerContext *scalerContext, uint8_t *scaledPlanes[4], int scaledPlaneStrides[4])
+{
+	uint8_t *srcData[4];
+	int srcLinesize[4];
+
+	get_source_planes(frame, scalerContext, srcData);
+	memcpy(srcLinesize, frame->linesize, sizeof(srcLinesize));
+
+	uint8_t *contentPlanes[4];
+
+	offset_image_planes(scalerContext->scaled_pixel_format, scaledPlanes, scaledPlaneStrides,
+		scalerContext->content_left, scalerContext->content_top, contentPlanes);
+
+	const bool vertical_flip = scalerContext->rotation == 180 && scalerContext->mirror;
+
+	if (vertical_flip)
+	{
+		// Rotation by 180 degrees with mirroring is just a vertical flip, which swscale does for free with negative source strides
+		const AVPixFmtDescriptor *sourceFmtDesc = av_pix_fmt_desc_get(scalerContext->source_pixel_format);
+		const int planes = av_pix_fmt_count_planes(scalerContext->source_pixel_format);
+
+		for (int i = 0; i < planes; i++)
+		{
+			srcData[i] += static_cast<ptrdiff_t>(get_plane_height(sourceFmtDesc, i, scalerContext->source_height) - 1) * srcLinesize[i];
+			srcLinesize[i] = -srcLinesize[i];
+		}
 	}
 
-	return -4;
+	if (vertical_flip || (scalerContext->rotation == 0 && !scalerContext->mirror))
+	{
+		// Same geometry and pixel format, the picture is copied as is without touching swscale
+		if (!scalerContext->sws_context)
+			av_image_copy(contentPlanes, scaledPlaneStrides, const_cast<const uint8_t **>(srcData), srcLinesize,
+				scalerContext->scaled_pixel_format, scalerContext->scaled_width, scalerContext->scaled_height);
+		else if (sws_scale(scalerContext->sws_context, srcData, srcLinesize, 0,
+			scalerContext->source_height, contentPlanes, scaledPlaneStrides) <= 0)
+			return -4;
+	}
+	else
+	{
+		uint8_t **rotationSource = srcData;
+		int *rotationSourceLinesize = srcLinesize;
+
+		if (scalerContext->sws_context)
+		{
+			if (sws_scale(scalerContext->sws_context, srcData, srcLinesize, 0,
+				scalerContext->source_height, scalerContext->rotation_data, scalerContext->rotation_linesize) <= 0)
+				return -4;
+
+			rotationSource = scalerContext->rotation_data;
+			rotationSourceLinesize = scalerContext->rotation_linesize;
+		}
+
+		for (int i = 0; i < scalerContext->scaled_plane_count; i++)
+			rotate_plane(scalerContext, i, rotationSource[i], rotationSourceLinesize[i], contentPlanes[i], scaledPlaneStrides[i]);
+	}
+
+	fill_borders(scalerContext, scaledPlanes, scaledPlaneStrides);
+	return 0;
 }
 
 int scale_decoded_video_frame(void *handle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride)
@@ -136,39 +567,247 @@ int scale_decoded_video_frame(void *handle, void *scalerHandle, void *scaledBuff
 	auto context = static_cast<VideoDecoderContext *>(handle);
 	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
 
-	if (scalerContext->source_top != 0 || scalerContext->source_left != 0)
+	uint8_t *scaledPlanes[4];
+	int scaledPlaneStrides[4];
+
+	fill_scaled_planes(scalerContext, static_cast<uint8_t *>(scaledBuffer), scaledBufferStride, scaledPlanes, scaledPlaneStrides);
+
+	return scale_video_frame(context->frame, scalerContext, scaledPlanes, scaledPlaneStrides);
+}
+
+int scale_decoded_video_frame_planes(void *handle, void *scalerHandle, void **scaledPlanes, int *scaledPlaneStrides)
+{
+#if _DEBUG
+	if (!handle || !scalerHandle || !scaledPlanes || !scaledPlaneStrides)
+		return -1;
+#endif
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	return scale_video_frame(context->frame, scalerContext, reinterpret_cast<uint8_t **>(scaledPlanes), scaledPlaneStrides);
+}
+
+// Bands go through the scaler of the previous frame, so the first frame and geometry changes are converted after decoding
+static void begin_band_conversion(VideoDecoderContext *context, int scaledWidth, int scaledHeight, int scaledPixelFormat, int quality,
+	uint8_t *scaledBuffer, int scaledBufferSize, int scaledBufferStride)
+{
+	const ScalerContext *scalerContext = context->scaler_context;
+
+	context->band_source = nullptr;
+
+	// With reorder delay the decoded picture is not the one output by this packet, its bands would only
+	// overwrite the buffer with a picture that is not returned
+	if (!context->band_conversion || !scalerContext || context->av_codec_context->has_b_frames > 0)
+		return;
+
+	if (scaledWidth == 0 || scaledHeight == 0)
 	{
-		const AVPixFmtDescriptor *sourceFmtDesc = av_pix_fmt_desc_get(scalerContext->source_pixel_format);
+		scaledWidth = scalerContext->source_width;
+		scaledHeight = scalerContext->source_height;
+	}
 
-		if (!sourceFmtDesc)
-			return -4;
+	if (scalerContext->target_width != scaledWidth || scalerContext->target_height != scaledHeight ||
+		scalerContext->scaled_pixel_format != scaledPixelFormat || context->scale_quality != quality)
+		return;
 
-		const int x_shift = sourceFmtDesc->log2_chroma_w;
-		const int y_shift = sourceFmtDesc->log2_chroma_h;
-		
-		uint8_t *srcData[8];
+	if (fill_scaled_planes(context->scaler_context, scaledBuffer, scaledBufferStride, context->band_planes, context->band_strides) >
+		scaledBufferSize)
+		context->band_planes[0] = nullptr;
+}
 
-		srcData[0] = context->frame->data[0] + scalerContext->source_top * context->frame->linesize[0] + scalerContext->source_left;
-		srcData[1] = context->frame->data[1] + (scalerContext->source_top >> y_shift) * context->frame->linesize[1] + (scalerContext->source_left >> x_shift);
-		srcData[2] = context->frame->data[2] + (scalerContext->source_top >> y_shift) * context->frame->linesize[2] + (scalerContext->source_left >> x_shift);
-		srcData[3] = nullptr;
-		srcData[4] = nullptr;
-		srcData[5] = nullptr;
-		srcData[6] = nullptr;
-		srcData[7] = nullptr;
+// With band conversion the buffer is written while the packet is decoded, so its content is undefined
+// whenever a non-zero result is returned
+int decode_and_scale_video_frame(void *handle, void *rawBuffer, int rawBufferLength, int scaledWidth, int scaledHeight,
+	int scaledPixelFormat, int quality, void *scaledBuffer, int scaledBufferSize, int scaledBufferStride,
+	int *frameWidth, int *frameHeight, int *framePixelFormat)
+{
+#if _DEBUG
+	if (!handle || !rawBuffer || !rawBufferLength || !scaledBuffer || !frameWidth || !frameHeight || !framePixelFormat)
+		return -1;
+
+	if (reinterpret_cast<uintptr_t>(rawBuffer) % 4 != 0)
+		return -2;
+#endif
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+
+	begin_band_conversion(context, scaledWidth, scaledHeight, scaledPixelFormat, quality,
+		static_cast<uint8_t *>(scaledBuffer), scaledBufferSize, scaledBufferStride);
+
+	int result = decode_video_packet(context, rawBuffer, rawBufferLength);
+
+	context->band_planes[0] = nullptr;
+
+	if (result != 0)
+		return result;
+
+	const AVFrame *frame = context->frame;
+
+	*frameWidth = frame->width;
+	*frameHeight = frame->height;
+	*framePixelFormat = frame->format;
 
-		sws_scale(scalerContext->sws_context, srcData, context->frame->linesize, 0,
-			scalerContext->source_height, reinterpret_cast<uint8_t **>(&scaledBuffer), &scaledBufferStride);
+	// Zero scaled size means the size of the frame itself
+	if (scaledWidth == 0 || scaledHeight == 0)
+	{
+		scaledWidth = frame->width;
+		scaledHeight = frame->height;
 	}
-	else
+
+	ScalerContext *scalerContext = context->scaler_context;
+	// Bands went through the current scaler, so they are usable only if it is not recreated below
+	bool bandsConverted = context->band_source && context->band_source == frame->data[0];
+
+	if (!scalerContext || scalerContext->source_width != frame->width || scalerContext->source_height != frame->height ||
+		scalerContext->source_pixel_format != frame->format || scalerContext->target_width != scaledWidth ||
+		scalerContext->target_height != scaledHeight || scalerContext->scaled_pixel_format != scaledPixelFormat ||
+		context->scale_quality != quality)
+	{
+		remove_video_scaler(scalerContext);
+		context->scaler_context = nullptr;
+
+		void *scalerHandle;
+		result = create_video_scaler(0, 0, frame->width, frame->height, frame->format, scaledWidth, scaledHeight,
+			scaledPixelFormat, quality, scaledWidth, scaledHeight, 0, 0, 0, &scalerHandle);
+
+		if (result != 0)
+			return -100 + result;
+
+		scalerContext = context->scaler_context = static_cast<ScalerContext *>(scalerHandle);
+		context->scale_quality = quality;
+		bandsConverted = false;
+	}
+
+	uint8_t *scaledPlanes[4];
+	int scaledPlaneStrides[4];
+
+	// Frame stays decoded, so it could be scaled again into a bigger buffer
+	if (fill_scaled_planes(scalerContext, static_cast<uint8_t *>(scaledBuffer), scaledBufferStride, scaledPlanes, scaledPlaneStrides) >
+		scaledBufferSize)
+		return -5;
+
+	// All rows of the output picture were already converted while it was decoded
+	if (bandsConverted && context->band_rows >= scalerContext->source_height)
+	{
+		fill_borders(scalerContext, scaledPlanes, scaledPlaneStrides);
+		return 0;
+	}
+
+	return scale_video_frame(frame, scalerContext, scaledPlanes, scaledPlaneStrides);
+}
+
+static void release_video_decoder_context(VideoDecoderContext *context)
+{
+	if (--context->references == 0)
+		av_free(context);
+}
+
+int set_video_decoder_max_acquired_frames(void *handle, int maxAcquiredFrames)
+{
+#if _DEBUG
+	if (!handle)
+		return -1;
+#endif
+
+	if (maxAcquiredFrames < 1)
+		return -2;
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+	context->max_acquired_frames = maxAcquiredFrames;
+	return 0;
+}
+
+int acquire_decoded_video_frame(void *handle, void **frameHandle)
+{
+#if _DEBUG
+	if (!handle || !frameHandle)
+		return -1;
+#endif
+
+	auto context = static_cast<VideoDecoderContext *>(handle);
+
+	// Nothing is decoded yet or the last decoding failed
+	if (!context->frame->data[0])
+		return -5;
+
+	if (++context->acquired_frames > context->max_acquired_frames)
 	{
-		sws_scale(scalerContext->sws_context, context->frame->data, context->frame->linesize, 0,
-			scalerContext->source_height, reinterpret_cast<uint8_t **>(&scaledBuffer), &scaledBufferStride);
+		--context->acquired_frames;
+		return -2;
+	}
+
+	auto frameContext = static_cast<AcquiredFrameContext *>(av_mallocz(sizeof(AcquiredFrameContext)));
+
+	if (!frameContext)
+	{
+		--context->acquired_frames;
+		return -3;
 	}
 
+	frameContext->frame = av_frame_alloc();
+
+	if (!frameContext->frame || av_frame_ref(frameContext->frame, context->frame) < 0)
+	{
+		av_frame_free(&frameContext->frame);
+		av_free(frameContext);
+		--context->acquired_frames;
+		return -4;
+	}
+
+	++context->references;
+	frameContext->decoder_context = context;
+
+	*frameHandle = frameContext;
 	return 0;
 }
 
+int scale_acquired_video_frame(void *frameHandle, void *scalerHandle, void *scaledBuffer, int scaledBufferStride)
+{
+#if _DEBUG
+	if (!frameHandle || !scalerHandle || !scaledBuffer)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	uint8_t *scaledPlanes[4];
+	int scaledPlaneStrides[4];
+
+	fill_scaled_planes(scalerContext, static_cast<uint8_t *>(scaledBuffer), scaledBufferStride, scaledPlanes, scaledPlaneStrides);
+
+	return scale_video_frame(frameContext->frame, scalerContext, scaledPlanes, scaledPlaneStrides);
+}
+
+int scale_acquired_video_frame_planes(void *frameHandle, void *scalerHandle, void **scaledPlanes, int *scaledPlaneStrides)
+{
+#if _DEBUG
+	if (!frameHandle || !scalerHandle || !scaledPlanes || !scaledPlaneStrides)
+		return -1;
+#endif
+
+	const auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+	const auto scalerContext = static_cast<ScalerContext *>(scalerHandle);
+
+	return scale_video_frame(frameContext->frame, scalerContext, reinterpret_cast<uint8_t **>(scaledPlanes), scaledPlaneStrides);
+}
+
+void release_acquired_video_frame(void *frameHandle)
+{
+	if (!frameHandle)
+		return;
+
+	auto frameContext = static_cast<AcquiredFrameContext *>(frameHandle);
+	VideoDecoderContext *context = frameContext->decoder_context;
+
+	av_frame_free(&frameContext->frame);
+	av_free(frameContext);
+
+	--context->acquired_frames;
+	release_video_decoder_context(context);
+}
+
 void remove_video_decoder(void *handle)
 {
 	if (!handle)
@@ -184,15 +823,75 @@ void remove_video_decoder(void *handle)
 	}
 
 	av_frame_free(&context->frame);
-	av_free(context);
+	remove_video_scaler(context->scaler_context);
+	context->scaler_context = nullptr;
+	release_video_decoder_context(context);
+}
+
+// Converts fill color to every plane of the pixel format by running swscale on a small solid picture
+int get_fill_pattern(AVPixelFormat pixelFormat, int fillColor, uint8_t fillPattern[4][4])
+{
+	const int size = 16;
+	uint8_t *colorData[4];
+	int colorLinesize[4];
+	uint8_t *fillData[4];
+	int fillLinesize[4];
+
+	if (av_image_alloc(colorData, colorLinesize, size, size, AV_PIX_FMT_BGRA, 16) < 0)
+		return -1;
+
+	if (av_image_alloc(fillData, fillLinesize, size, size, pixelFormat, 16) < 0)
+	{
+		av_freep(&colorData[0]);
+		return -1;
+	}
+
+	for (int y = 0; y < size; y++)
+	{
+		auto row = reinterpret_cast<uint32_t *>(colorData[0] + y * colorLinesize[0]);
+
+		for (int x = 0; x < size; x++)
+			row[x] = 0xFF000000u | static_cast<uint32_t>(fillColor);
+	}
+
+	int result = -1;
+	SwsContext *swsContext = sws_getContext(size, size, AV_PIX_FMT_BGRA, size, size, pixelFormat,
+		SWS_POINT, nullptr, nullptr, nullptr);
+
+	if (swsContext)
+	{
+		if (sws_scale(swsContext, colorData, colorLinesize, 0, size, fillData, fillLinesize) > 0)
+		{
+			int plane_steps[4];
+			av_image_fill_max_pixsteps(plane_steps, nullptr, av_pix_fmt_desc_get(pixelFormat));
+
+			for (int i = 0; i < av_pix_fmt_count_planes(pixelFormat); i++)
+				memcpy(fillPattern[i], fillData[i], plane_steps[i]);
+
+			result = 0;
+		}
+
+		sws_freeContext(swsContext);
+	}
+
+	av_freep(&fillData[0]);
+	av_freep(&colorData[0]);
+	return result;
 }
 
 int create_video_scaler(int sourceLeft, int sourceTop, int sourceWidth, int sourceHeight, int sourcePixelFormat,
-	int scaledWidth, int scaledHeight, int scaledPixelFormat, int quality, void **handle)
+	int scaledWidth, int scaledHeight, int scaledPixelFormat, int quality, int targetWidth, int targetHeight,
+	int rotation, int mirror, int fillColor, void **handle)
 {
 	if (!handle)
 		return -1;
 
+	if (rotation != 0 && rotation != 90 && rotation != 180 && rotation != 270)
+		return -5;
+
+	if (targetWidth < scaledWidth || targetHeight < scaledHeight)
+		return -6;
+
 	auto context = static_cast<ScalerContext *>(av_mallocz(sizeof(ScalerContext)));
 
 	if (!context)
@@ -201,24 +900,84 @@ int create_video_scaler(int sourceLeft, int sourceTop, int sourceWidth, int sour
 	const auto sourceAvPixelFormat = static_cast<AVPixelFormat>(sourcePixelFormat);
 	const auto scaledAvPixelFormat = static_cast<AVPixelFormat>(scaledPixelFormat);
 
-	SwsContext *swsContext = sws_getContext(sourceWidth, sourceHeight, sourceAvPixelFormat, scaledWidth, scaledHeight,
-		scaledAvPixelFormat, quality, nullptr, nullptr, nullptr);
-	
-	if (!swsContext)
+	const AVPixFmtDescriptor *scaledFmtDesc = av_pix_fmt_desc_get(scaledAvPixelFormat);
+
+	if (!av_pix_fmt_desc_get(sourceAvPixelFormat) || !scaledFmtDesc)
 	{
 		remove_video_scaler(context);
-		return -3;
+		return -4;
+	}
+
+	const bool transposed = rotation == 90 || rotation == 270;
+
+	// Packed formats with subsampled chroma (YUY2) can't be rotated or mirrored pixel by pixel,
+	// and rotation by 90 degrees requires the same subsampling in both directions
+	if ((rotation != 0 || mirror) && !(rotation == 180 && mirror) &&
+		((!(scaledFmtDesc->flags & AV_PIX_FMT_FLAG_PLANAR) && scaledFmtDesc->log2_chroma_w != 0) ||
+			(transposed && scaledFmtDesc->log2_chroma_w != scaledFmtDesc->log2_chroma_h)))
+	{
+		remove_video_scaler(context);
+		return -5;
+	}
+
+	context->target_width = targetWidth;
+	context->target_height = targetHeight;
+	context->content_width = scaledWidth;
+	context->content_height = scaledHeight;
+	// Content position should not split subsampled chroma samples
+	context->content_left = (targetWidth - scaledWidth) / 2 & ~((1 << scaledFmtDesc->log2_chroma_w) - 1);
+	context->content_top = (targetHeight - scaledHeight) / 2 & ~((1 << scaledFmtDesc->log2_chroma_h) - 1);
+	context->rotation = rotation;
+	context->mirror = mirror;
+
+	// Scaled size before rotation
+	if (transposed)
+	{
+		scaledWidth = context->content_height;
+		scaledHeight = context->content_width;
+	}
+
+	if (sourceWidth != scaledWidth || sourceHeight != scaledHeight || sourceAvPixelFormat != scaledAvPixelFormat)
+	{
+		SwsContext *swsContext = sws_getContext(sourceWidth, sourceHeight, sourceAvPixelFormat, scaledWidth, scaledHeight,
+			scaledAvPixelFormat, quality, nullptr, nullptr, nullptr);
+
+		if (!swsContext)
+		{
+			remove_video_scaler(context);
+			return -3;
+		}
+
+		context->sws_context = swsContext;
 	}
 
-	context->sws_context = swsContext;
+	av_image_fill_max_pixsteps(context->scaled_plane_steps, nullptr, scaledFmtDesc);
+
+	context->scaled_fmt_desc = scaledFmtDesc;
+	context->scaled_plane_count = av_pix_fmt_count_planes(scaledAvPixelFormat);
 	context->source_left = sourceLeft;
 	context->source_top = sourceTop;
+	context->source_width = sourceWidth;
 	context->source_height = sourceHeight;
 	context->source_pixel_format = sourceAvPixelFormat;
 	context->scaled_width = scaledWidth;
 	context->scaled_height = scaledHeight;
 	context->scaled_pixel_format = scaledAvPixelFormat;
 
+	if ((rotation != 0 || mirror) && !(rotation == 180 && mirror) && context->sws_context &&
+		av_image_alloc(context->rotation_data, context->rotation_linesize, scaledWidth, scaledHeight, scaledAvPixelFormat, 16) < 0)
+	{
+		remove_video_scaler(context);
+		return -7;
+	}
+
+	if ((targetWidth != context->content_width || targetHeight != context->content_height) &&
+		get_fill_pattern(scaledAvPixelFormat, fillColor, context->fill_pattern) != 0)
+	{
+		remove_video_scaler(context);
+		return -8;
+	}
+
 	*handle = context;
 	return 0;
 }
@@ -231,6 +990,8 @@ void remove_video_scaler(void *handle)
 	const auto context = static_cast<ScalerContext *>(handle);
 
 	sws_freeContext(context->sws_context);
+	av_freep(&context->rotation_data[0]);
+	remove_scaler_change_detection(context);
 	av_free(context);
 }
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#define DEFAULT_MAX_ACQUIRED_FRAMES 4
+
+#define VIDEO_FRAME_ERROR_CORRUPT 1
+#define VIDEO_FRAME_ERROR_INVALID_BITSTREAM 2
+#define VIDEO_FRAME_ERROR_MISSING_REFERENCE 4
+
+struct ScalerContext;
+
+struct VideoDecoderContext
+{
+	AVCodec *codec;
+	AVCodecContext *av_codec_context;
+	AVPacket av_raw_packet;
+	AVFrame *frame;
+	// One reference is held by the decoder handle itself and one by every acquired frame,
+	// so the context outlives remove_video_decoder while frames are still in use
+	std::atomic<int> references;
+	std::atomic<int> acquired_frames;
+	int max_acquired_frames;
+	// Scaler of decode_and_scale_video_frame, recreated when frame or output geometry changes
+	ScalerContext *scaler_context;
+	int scale_quality;
+	// Target of row bands converted while decode_and_scale_video_frame decodes, see set_video_decoder_band_conversion
+	int band_conversion;
+	uint8_t *band_planes[4];
+	int band_strides[4];
+	const uint8_t *band_source;
+	int band_rows;
+};
+
+struct AcquiredFrameContext
+{
+	VideoDecoderContext *decoder_context;
+	AVFrame *frame;
+};
+
+struct ScalerContext
+{
+	SwsContext *sws_context;
+	int source_left;
+	int source_top;
+	int source_width;
+	int source_height;
+	AVPixelFormat source_pixel_format;
+	int scaled_width;
+	int scaled_height;
+	AVPixelFormat scaled_pixel_format;
+	int scaled_plane_count;
+	int scaled_plane_steps[4];
+	const AVPixFmtDescriptor *scaled_fmt_desc;
+	// Scaled picture is placed at content rectangle of the target buffer, the rest is filled with fill color
+	int target_width;
+	int target_height;
+	int content_left;
+	int content_top;
+	int content_width;
+	int content_height;
+	int rotation;
+	int mirror;
+	uint8_t *rotation_data[4];
+	int rotation_linesize[4];
+	uint8_t fill_pattern[4][4];
+	// Change detection state, see set_video_scaler_change_detection
+	int change_tile_size;
+	int change_threshold;
+	int change_columns;
+	int change_rows;
+	int has_previous_frame;
+	uint8_t *previous_data[4];
+	int previous_linesize[4];
+	uint8_t *dirty_tiles;
+	// Converters of a single tile when there is no scaling: regular, right column, bottom row and corner tiles
+	SwsContext *tile_sws_contexts[4];
+};
+
+int get_fill_pattern(AVPixelFormat pixelFormat, int fillColor, uint8_t fillPattern[4][4]);
+void fill_image_rect(AVPixelFormat pixelFormat, uint8_t *planes[4], const int strides[4], int left, int top, int width, int height,
+	const uint8_t fillPattern[4][4]);
+void offset_image_planes(AVPixelFormat pixelFormat, uint8_t *planes[4], const int strides[4], int left, int top, uint8_t *offsetPlanes[4]);
+int fill_scaled_planes(ScalerContext *scalerContext, uint8_t *scaledBuffer, int scaledBufferStride,
+	uint8_t *scaledPlanes[4], int scaledPlaneStrides[4]);
+void get_source_planes(const AVFrame *frame, ScalerContext *scalerContext, uint8_t *srcData[4]);
+int scale_video_frame(const AVFrame *frame, ScalerContext *scalerContext, uint8_t *scaledPlanes[4], int scaledPlaneStrides[4]);
+void remove_scaler_change_detection(ScalerContext *scalerContext);
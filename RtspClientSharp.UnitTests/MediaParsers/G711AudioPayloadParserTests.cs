@@ -27,5 +27,26 @@ namespace RtspClientSharp.UnitTests.MediaParsers
             Assert.AreEqual(FrameType.Audio, frame.Type);
             Assert.IsTrue(frame.FrameSegment.SequenceEqual(testBytes));
         }
+
+        [TestMethod]
+        public void Parse_ReuseFramesAndTwoPayloads_SameFrameWithLastData()
+        {
+            var testCodecInfo = new G711UCodecInfo();
+
+            byte[] testBytes1 = {1, 2, 3, 4};
+            byte[] testBytes2 = {5, 6, 7, 8, 9};
+
+            RawG711UFrame frame1 = null;
+            RawG711UFrame frame2 = null;
+            var parser = new G711AudioPayloadParser(testCodecInfo) {ReuseFrames = true};
+            parser.FrameGenerated = rawFrame => frame1 = (RawG711UFrame) rawFrame;
+            parser.Parse(TimeSpan.Zero, new ArraySegment<byte>(testBytes1), true);
+            parser.FrameGenerated = rawFrame => frame2 = (RawG711UFrame) rawFrame;
+            parser.Parse(TimeSpan.FromSeconds(1), new ArraySegment<byte>(testBytes2), true);
+
+            Assert.AreSame(frame1, frame2);
+            Assert.AreEqual(testCodecInfo.SampleRate, frame2.SampleRate);
+            Assert.IsTrue(frame2.FrameSegment.SequenceEqual(testBytes2));
+        }
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.Linq;
 using Microsoft.VisualStudio.TestTools.UnitTesting;
 using RtspClientSharp.MediaParsers;
@@ -32,6 +33,33 @@ namespace RtspClientSharp.UnitTests.MediaParsers
             Assert.IsTrue(frame.FrameSegment.SequenceEqual(pFrameBytes));
         }
 
+        [TestMethod]
+        public void Parse_ReuseFramesAndTwoPFrames_SameFrameWithLastData()
+        {
+            var spsBytes = Convert.FromBase64String("AAAAAWdNQCmaZgUB7YC1AQEBBenA");
+            var ppsBytes = Convert.FromBase64String("AAAAAWjuPIA=");
+            var iFrameBytes = new byte[] {0x0, 0x0, 0x0, 0x1, 0x65, 0x88, 0x80, 0x10, 0x00};
+            var pFrameBytes1 = new byte[] {0x0, 0x0, 0x0, 0x1, 0x61, 0x9a, 0x01, 0x01, 0x64};
+            var pFrameBytes2 = new byte[] {0x0, 0x0, 0x0, 0x1, 0x61, 0x9a, 0x02, 0x02, 0x65, 0x11};
+
+            var frames = new List<RawH264Frame>();
+            var parser = new H264Parser(() => DateTime.UtcNow)
+            {
+                FrameGenerated = rawFrame => frames.Add((RawH264Frame) rawFrame),
+                ReuseFrames = true
+            };
+            parser.Parse(new ArraySegment<byte>(spsBytes), false);
+            parser.Parse(new ArraySegment<byte>(ppsBytes), false);
+            parser.Parse(new ArraySegment<byte>(iFrameBytes), true);
+            parser.Parse(new ArraySegment<byte>(pFrameBytes1), true);
+            parser.Parse(new ArraySegment<byte>(pFrameBytes2), true);
+
+            Assert.AreEqual(3, frames.Count);
+            Assert.IsInstanceOfType(frames[0], typeof(RawH264IFrame));
+            Assert.AreSame(frames[1], frames[2]);
+            Assert.IsTrue(frames[2].FrameSegment.SequenceEqual(pFrameBytes2));
+        }
+
         [TestMethod]
         public void ResetState_SpsPpsThenIFrameThenReset_FrameGenerated()
         {
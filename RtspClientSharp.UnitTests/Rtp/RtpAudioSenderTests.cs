@@ -0,0 +1,103 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using RtspClientSharp.Codecs.Audio;
+using RtspClientSharp.Rtp;
+
+namespace RtspClientSharp.UnitTests.Rtp
+{
+    [TestClass]
+    public class RtpAudioSenderTests
+    {
+        private readonly List<byte[]> _sentPackets = new List<byte[]>();
+
+        [TestMethod]
+        public async Task SendAsync_SmallG711Frame_SendsOnePacketWithMarker()
+        {
+            var frameBytes = new byte[] {1, 2, 3, 4};
+            RtpAudioSender sender = CreateSender(new G711ACodecInfo(), 8);
+
+            await sender.SendAsync(new ArraySegment<byte>(frameBytes), CancellationToken.None);
+
+            Assert.AreEqual(1, _sentPackets.Count);
+            Assert.IsTrue(RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[0]), out RtpPacket rtpPacket));
+            Assert.IsTrue(rtpPacket.MarkerBit);
+            Assert.AreEqual(8, rtpPacket.PayloadType);
+            Assert.AreEqual(100, rtpPacket.SeqNumber);
+            Assert.AreEqual(1000u, rtpPacket.Timestamp);
+            Assert.AreEqual(0x11223344u, rtpPacket.SyncSourceId);
+            Assert.IsTrue(frameBytes.SequenceEqual(rtpPacket.PayloadSegment));
+        }
+
+        [TestMethod]
+        public async Task SendAsync_LargeG711Frame_SplitsToPacketsWithIncreasingTimestamps()
+        {
+            var frameBytes = new byte[RtpAudioSender.MaxPacketSize * 2];
+            RtpAudioSender sender = CreateSender(new G711UCodecInfo(), 0);
+
+            await sender.SendAsync(new ArraySegment<byte>(frameBytes), CancellationToken.None);
+
+            Assert.AreEqual(3, _sentPackets.Count);
+            RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[0]), out RtpPacket firstPacket);
+            RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[1]), out RtpPacket secondPacket);
+            RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[2]), out RtpPacket thirdPacket);
+            Assert.IsFalse(secondPacket.MarkerBit);
+            Assert.AreEqual(firstPacket.SeqNumber + 1, secondPacket.SeqNumber);
+            Assert.AreEqual(firstPacket.Timestamp + (uint) firstPacket.PayloadSegment.Count, secondPacket.Timestamp);
+            Assert.AreEqual(frameBytes.Length, firstPacket.PayloadSegment.Count + secondPacket.PayloadSegment.Count +
+                                               thirdPacket.PayloadSegment.Count);
+        }
+
+        [TestMethod]
+        public async Task SendAsync_TwoAACFrames_SendsPacketsWithAuHeaders()
+        {
+            var frameBytes = new byte[] {1, 2, 3, 4, 5};
+            var codecInfo = new AACCodecInfo {SizeLength = 13, IndexLength = 3, IndexDeltaLength = 3};
+            RtpAudioSender sender = CreateSender(codecInfo, 96);
+
+            await sender.SendAsync(new ArraySegment<byte>(frameBytes), CancellationToken.None);
+            await sender.SendAsync(new ArraySegment<byte>(frameBytes), CancellationToken.None);
+
+            RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[0]), out RtpPacket firstPacket);
+            RtpPacket.TryParse(new ArraySegment<byte>(_sentPackets[1]), out RtpPacket secondPacket);
+            Assert.IsTrue(firstPacket.MarkerBit);
+            Assert.IsTrue(secondPacket.MarkerBit);
+            Assert.AreEqual(firstPacket.Timestamp + 1024, secondPacket.Timestamp);
+
+            byte[] payload = firstPacket.PayloadSegment.ToArray();
+            Assert.AreEqual(16, payload[0] << 8 | payload[1]);
+            Assert.AreEqual(frameBytes.Length, (payload[2] << 8 | payload[3]) >> 3);
+            Assert.IsTrue(frameBytes.SequenceEqual(payload.Skip(4)));
+        }
+
+        [TestMethod]
+        [ExpectedException(typeof(ArgumentException))]
+        public async Task SendAsync_AACFrameLargerThanSizeLength_ThrowsException()
+        {
+            var frameBytes = new byte[64];
+            var codecInfo = new AACCodecInfo {SizeLength = 6, IndexLength = 2, IndexDeltaLength = 2};
+            RtpAudioSender sender = CreateSender(codecInfo, 96);
+
+            await sender.SendAsync(new ArraySegment<byte>(frameBytes), CancellationToken.None);
+        }
+
+        [TestMethod]
+        [ExpectedException(typeof(ArgumentException))]
+        public void Constructor_UnsupportedCodec_ThrowsException()
+        {
+            CreateSender(new PCMCodecInfo(8000, 16, 1), 97);
+        }
+
+        private RtpAudioSender CreateSender(AudioCodecInfo codecInfo, int payloadType)
+        {
+            return new RtpAudioSender(codecInfo, payloadType, 8000, 0x11223344, 100, 1000, (packetSegment, token) =>
+            {
+                _sentPackets.Add(packetSegment.ToArray());
+                return Task.CompletedTask;
+            });
+        }
+    }
+}
\ No newline at end of file
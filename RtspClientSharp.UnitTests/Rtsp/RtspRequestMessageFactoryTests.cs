@@ -118,6 +118,26 @@ namespace RtspClientSharp.UnitTests.Rtsp
             Assert.AreEqual(factory.ContentBase, request.ConnectionUri);
         }
 
+        [TestMethod]
+        public void CreateDescribeRequest_BackchannelIsRequired_AddsRequireHeader()
+        {
+            var factory = new RtspRequestMessageFactory(FakeUri, UserAgent) {RequireBackchannel = true};
+
+            RtspRequestMessage request = factory.CreateDescribeRequest();
+
+            Assert.AreEqual("www.onvif.org/ver20/backchannel", request.Headers.Get("Require"));
+        }
+
+        [TestMethod]
+        public void CreateDescribeRequest_BackchannelIsNotRequired_NoRequireHeader()
+        {
+            var factory = new RtspRequestMessageFactory(FakeUri, UserAgent);
+
+            RtspRequestMessage request = factory.CreateDescribeRequest();
+
+            Assert.IsNull(request.Headers.Get("Require"));
+        }
+
         [TestMethod]
         public void CreateTeardownRequest_ValidProperties()
         {
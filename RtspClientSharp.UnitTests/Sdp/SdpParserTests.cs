@@ -47,6 +47,35 @@ namespace RtspClientSharp.UnitTests.Sdp
             Assert.AreEqual(32000, audioTrack.SamplesFrequency);
         }
 
+        [TestMethod]
+        public void Parse_TestDocumentWithBackchannelTrack_ReturnsSendOnlyTrackWithSamePayloadType()
+        {
+            string testInput = "m=video 0 RTP/AVP 26\r\n" +
+                               "a=control:rtsp://192.168.0.1/video\r\n" +
+                               "a=recvonly\r\n" +
+                               "m=audio 0 RTP/AVP 0\r\n" +
+                               "a=control:rtsp://192.168.0.1/audio\r\n" +
+                               "a=recvonly\r\n" +
+                               "m=audio 0 RTP/AVP 0\r\n" +
+                               "a=control:rtsp://192.168.0.1/audioback\r\n" +
+                               "a=rtpmap:0 PCMU/8000\r\n" +
+                               "a=sendonly\r\n";
+
+            var testBytes = Encoding.ASCII.GetBytes(testInput);
+
+            var parser = new SdpParser();
+            IReadOnlyList<RtspMediaTrackInfo> tracks = parser.Parse(testBytes).Where(t => t is RtspMediaTrackInfo)
+                .Cast<RtspMediaTrackInfo>().ToList();
+
+            Assert.AreEqual(3, tracks.Count);
+            RtspMediaTrackInfo audioTrack = tracks.First(t => t.Codec is AudioCodecInfo && !t.IsSendOnly);
+            Assert.AreEqual("rtsp://192.168.0.1/audio", audioTrack.TrackName);
+            RtspMediaTrackInfo backchannelTrack = tracks.Single(t => t.IsSendOnly);
+            Assert.AreEqual("rtsp://192.168.0.1/audioback", backchannelTrack.TrackName);
+            Assert.AreEqual(0, backchannelTrack.PayloadType);
+            Assert.IsInstanceOfType(backchannelTrack.Codec, typeof(G711UCodecInfo));
+        }
+
         [TestMethod]
         public void Parse_SDPWithH264Track_ReturnsWithH264CodecTrack()
         {
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.IO;
 using System.Linq;
 using System.Threading.Tasks;
@@ -25,6 +26,49 @@ namespace RtspClientSharp.UnitTests.Tpkt
             Assert.AreEqual(9, payload.PayloadSegment[0]);
         }
 
+        [TestMethod]
+        public async Task ReadAsync_HandlerAndTwoPacketsInStream_PassesBothPackets()
+        {
+            var streamBytes = new byte[] {TpktHeader.Id, 0, 0, 2, 7, 8, TpktHeader.Id, 1, 0, 1, 9};
+            var ms = new MemoryStream(streamBytes);
+            var payloads = new List<TpktPayload>();
+
+            var tpktStream = new TpktStream(ms);
+            await tpktStream.ReadAsync(payload => payloads.Add(payload));
+
+            Assert.AreEqual(2, payloads.Count);
+            Assert.AreEqual(0, payloads[0].Channel);
+            Assert.IsTrue(payloads[0].PayloadSegment.SequenceEqual(new byte[] {7, 8}));
+            Assert.AreEqual(1, payloads[1].Channel);
+            Assert.IsTrue(payloads[1].PayloadSegment.SequenceEqual(new byte[] {9}));
+        }
+
+        [TestMethod]
+        public async Task ReadAsync_PacketsCrossingBufferEnd_ReadsAllPayloads()
+        {
+            int[] payloadSizes = {1000, 30000, 40000, 65535, 7, 65535, 1500};
+            var ms = new MemoryStream();
+            var writeStream = new TpktStream(ms);
+
+            for (int i = 0; i < payloadSizes.Length; i++)
+            {
+                byte[] payloadBytes = Enumerable.Repeat((byte) i, payloadSizes[i]).ToArray();
+                await writeStream.WriteAsync(i, new ArraySegment<byte>(payloadBytes));
+            }
+
+            ms.Position = 0;
+            var tpktStream = new TpktStream(ms);
+
+            for (int i = 0; i < payloadSizes.Length; i++)
+            {
+                TpktPayload payload = await tpktStream.ReadAsync();
+
+                Assert.AreEqual(i, payload.Channel);
+                Assert.AreEqual(payloadSizes[i], payload.PayloadSegment.Count);
+                Assert.IsTrue(payload.PayloadSegment.All(b => b == i));
+            }
+        }
+
         [TestMethod]
         public async Task WriteAsync_TestPayload_WritesWithValidHeader()
         {
@@ -0,0 +1,9 @@
+﻿namespace RtspClientSharp
+{
+    public enum BackchannelAudioCodec
+    {
+        G711A,
+        G711U,
+        AAC
+    }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+﻿using System;
+
+namespace RtspClientSharp
+{
+    /// <summary>
+    /// Audio format device expects on backchannel, encoder should be configured accordingly
+    /// </summary>
+    public class BackchannelAudioFormat
+    {
+        public BackchannelAudioCodec Codec { get; }
+        public int SampleRate { get; }
+        public int Channels { get; }
+
+        /// <summary>
+        /// AudioSpecificConfig of AAC backchannel, empty for other codecs
+        /// </summary>
+        public ArraySegment<byte> ConfigSegment { get; }
+
+        public BackchannelAudioFormat(BackchannelAudioCodec codec, int sampleRate, int channels,
+            ArraySegment<byte> configSegment)
+        {
+            Codec = codec;
+            SampleRate = sampleRate;
+            Channels = channels;
+            ConfigSegment = configSegment;
+        }
+    }
+}
\ No newline at end of file
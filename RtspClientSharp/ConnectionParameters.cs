@@ -28,6 +28,18 @@ namespace RtspClientSharp
         public string UserAgent { get; set; } = DefaultUserAgent;
         public RtpTransportProtocol RtpTransport { get; set; } = RtpTransportProtocol.TCP;
 
+        /// <summary>
+        /// Request ONVIF audio backchannel (two-way audio) from device.
+        /// Important notes: devices without backchannel support could reject DESCRIBE request in that case
+        /// </summary>
+        public bool RequireBackchannel { get; set; }
+
+        /// <summary>
+        /// Pass frames of every track in the same instances instead of allocating new ones.
+        /// Important notes: frame and its data are valid inside FrameReceived handler only, copy them to keep longer
+        /// </summary>
+        public bool ReuseRawFrames { get; set; }
+
         public ConnectionParameters(Uri connectionUri)
         {
             ValidateUri(connectionUri);
@@ -11,6 +11,11 @@ namespace RtspClientSharp
     {
         ConnectionParameters ConnectionParameters { get; }
 
+        /// <summary>
+        /// Audio format of ONVIF backchannel or null if it was not required or endpoint doesn't provide it
+        /// </summary>
+        BackchannelAudioFormat BackchannelFormat { get; }
+
         event EventHandler<RawFrame> FrameReceived;
 
         /// <summary>
@@ -29,5 +34,13 @@ namespace RtspClientSharp
         /// <exception cref="RtspClientException"></exception>
         /// <exception cref="InvalidOperationException"></exception>
         Task ReceiveAsync(CancellationToken token);
+
+        /// <summary>
+        /// Send encoded audio frame to endpoint over backchannel.
+        /// Should be called while frames are received, calls should not overlap
+        /// </summary>
+        /// <exception cref="OperationCanceledException"></exception>
+        /// <exception cref="InvalidOperationException"></exception>
+        Task SendBackchannelAudioAsync(ArraySegment<byte> frameSegment, CancellationToken token);
     }
 }
\ No newline at end of file
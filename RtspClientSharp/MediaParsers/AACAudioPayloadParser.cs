@@ -10,6 +10,7 @@ namespace RtspClientSharp.MediaParsers
     {
         private readonly AACCodecInfo _codecInfo;
         private readonly BitStreamReader _bitStreamReader = new BitStreamReader();
+        private RawAACFrame _reusableFrame;
 
         public AACAudioPayloadParser(AACCodecInfo codecInfo)
         {
@@ -47,8 +48,18 @@ namespace RtspClientSharp.MediaParsers
 
                 DateTime timestamp = GetFrameTimestamp(timeOffset);
 
-                var aacFrame = new RawAACFrame(timestamp, frameBytes,
-                    new ArraySegment<byte>(_codecInfo.ConfigBytes));
+                RawAACFrame aacFrame;
+
+                if (!ReuseFrames)
+                    aacFrame = new RawAACFrame(timestamp, frameBytes, new ArraySegment<byte>(_codecInfo.ConfigBytes));
+                else if (_reusableFrame == null)
+                    aacFrame = _reusableFrame = new RawAACFrame(timestamp, frameBytes,
+                        new ArraySegment<byte>(_codecInfo.ConfigBytes));
+                else
+                {
+                    aacFrame = _reusableFrame;
+                    aacFrame.Reinitialize(timestamp, frameBytes);
+                }
 
                 OnFrameGenerated(aacFrame);
                 offset += frameSize;
@@ -7,6 +7,7 @@ namespace RtspClientSharp.MediaParsers
     class G711AudioPayloadParser : MediaPayloadParser
     {
         private readonly G711CodecInfo _g711CodecInfo;
+        private RawG711Frame _reusableFrame;
 
         public G711AudioPayloadParser(G711CodecInfo g711CodecInfo)
         {
@@ -21,6 +22,13 @@ namespace RtspClientSharp.MediaParsers
 
             DateTime timestamp = GetFrameTimestamp(timeOffset);
 
+            if (ReuseFrames && _reusableFrame != null)
+            {
+                _reusableFrame.Reinitialize(timestamp, byteSegment);
+                OnFrameGenerated(_reusableFrame);
+                return;
+            }
+
             if (g711UCodecInfo != null)
                 frame = new RawG711UFrame(timestamp, byteSegment);
             else
@@ -29,6 +37,9 @@ namespace RtspClientSharp.MediaParsers
             frame.SampleRate = _g711CodecInfo.SampleRate;
             frame.Channels = _g711CodecInfo.Channels;
 
+            if (ReuseFrames)
+                _reusableFrame = frame;
+
             OnFrameGenerated(frame);
         }
 
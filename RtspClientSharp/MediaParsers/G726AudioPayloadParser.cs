@@ -7,6 +7,7 @@ namespace RtspClientSharp.MediaParsers
     class G726AudioPayloadParser : MediaPayloadParser
     {
         private readonly int _bitsPerCodedSample;
+        private RawG726Frame _reusableFrame;
 
         public G726AudioPayloadParser(G726CodecInfo g726CodecInfo)
         {
@@ -18,7 +19,19 @@ namespace RtspClientSharp.MediaParsers
         public override void Parse(TimeSpan timeOffset, ArraySegment<byte> byteSegment, bool markerBit)
         {
             DateTime timestamp = GetFrameTimestamp(timeOffset);
+
+            if (ReuseFrames && _reusableFrame != null)
+            {
+                _reusableFrame.Reinitialize(timestamp, byteSegment);
+                OnFrameGenerated(_reusableFrame);
+                return;
+            }
+
             var frame = new RawG726Frame(timestamp, byteSegment, _bitsPerCodedSample);
+
+            if (ReuseFrames)
+                _reusableFrame = frame;
+
             OnFrameGenerated(frame);
         }
 
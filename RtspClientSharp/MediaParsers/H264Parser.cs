@@ -31,8 +31,16 @@ namespace RtspClientSharp.MediaParsers
 
         private readonly MemoryStream _frameStream;
 
+        private RawH264IFrame _reusableIFrame;
+        private RawH264PFrame _reusablePFrame;
+
         public Action<RawFrame> FrameGenerated;
 
+        /// <summary>
+        /// Every I and P frame is passed in the same instance, so it is valid inside FrameGenerated handler only
+        /// </summary>
+        public bool ReuseFrames { get; set; }
+
         public H264Parser(Func<DateTime> frameTimestampProvider)
         {
             _frameTimestampProvider = frameTimestampProvider ?? throw new ArgumentNullException(nameof(frameTimestampProvider));
@@ -81,7 +89,7 @@ namespace RtspClientSharp.MediaParsers
             if (frameType == FrameType.PredictionFrame && !_waitForIFrame)
             {
                 frameTimestamp = _frameTimestampProvider();
-                FrameGenerated?.Invoke(new RawH264PFrame(frameTimestamp, frameBytes));
+                FrameGenerated?.Invoke(CreatePFrame(frameTimestamp, frameBytes));
                 return;
             }
 
@@ -92,7 +100,34 @@ namespace RtspClientSharp.MediaParsers
             var byteSegment = new ArraySegment<byte>(_spsPpsBytes);
 
             frameTimestamp = _frameTimestampProvider();
-            FrameGenerated?.Invoke(new RawH264IFrame(frameTimestamp, frameBytes, byteSegment));
+            FrameGenerated?.Invoke(CreateIFrame(frameTimestamp, frameBytes, byteSegment));
+        }
+
+        private RawH264PFrame CreatePFrame(DateTime timestamp, ArraySegment<byte> frameBytes)
+        {
+            if (!ReuseFrames)
+                return new RawH264PFrame(timestamp, frameBytes);
+
+            if (_reusablePFrame == null)
+                _reusablePFrame = new RawH264PFrame(timestamp, frameBytes);
+            else
+                _reusablePFrame.Reinitialize(timestamp, frameBytes);
+
+            return _reusablePFrame;
+        }
+
+        private RawH264IFrame CreateIFrame(DateTime timestamp, ArraySegment<byte> frameBytes,
+            ArraySegment<byte> spsPpsSegment)
+        {
+            if (!ReuseFrames)
+                return new RawH264IFrame(timestamp, frameBytes, spsPpsSegment);
+
+            if (_reusableIFrame == null)
+                _reusableIFrame = new RawH264IFrame(timestamp, frameBytes, spsPpsSegment);
+            else
+                _reusableIFrame.Reinitialize(timestamp, frameBytes, spsPpsSegment);
+
+            return _reusableIFrame;
         }
 
         public void ResetState()
@@ -27,6 +27,12 @@ namespace RtspClientSharp.MediaParsers
         private bool _waitForStartFu = true;
         private TimeSpan _timeOffset = TimeSpan.MinValue;
 
+        public override bool ReuseFrames
+        {
+            get => _h264Parser.ReuseFrames;
+            set => _h264Parser.ReuseFrames = value;
+        }
+
         public H264VideoPayloadParser(H264CodecInfo codecInfo)
         {
             if (codecInfo == null)
@@ -7,6 +7,11 @@ namespace RtspClientSharp.MediaParsers
     {
         Action<RawFrame> FrameGenerated { get; set; }
 
+        /// <summary>
+        /// Every frame is passed in the same instance, so it is valid inside FrameGenerated handler only
+        /// </summary>
+        bool ReuseFrames { get; set; }
+
         void Parse(TimeSpan timeOffset, ArraySegment<byte> byteSegment, bool markerBit);
 
         void ResetState();
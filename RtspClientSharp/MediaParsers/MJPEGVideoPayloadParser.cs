@@ -115,6 +115,7 @@ namespace RtspClientSharp.MediaParsers
         };
 
         private readonly MemoryStream _frameStream;
+        private RawJpegFrame _reusableFrame;
 
         private int _currentDri;
         private int _currentQ;
@@ -419,7 +420,18 @@ namespace RtspClientSharp.MediaParsers
             var frameBytes = new ArraySegment<byte>(_frameStream.GetBuffer(), 0, (int)_frameStream.Position);
             _frameStream.Position = 0;
 
+            if (ReuseFrames && _reusableFrame != null)
+            {
+                _reusableFrame.Reinitialize(timestamp, frameBytes);
+                OnFrameGenerated(_reusableFrame);
+                return;
+            }
+
             var frame = new RawJpegFrame(timestamp, frameBytes);
+
+            if (ReuseFrames)
+                _reusableFrame = frame;
+
             OnFrameGenerated(frame);
         }
     }
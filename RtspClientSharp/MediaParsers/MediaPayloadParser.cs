@@ -12,6 +12,8 @@ namespace RtspClientSharp.MediaParsers
 
         public Action<RawFrame> FrameGenerated { get; set; }
 
+        public virtual bool ReuseFrames { get; set; }
+
         public abstract void Parse(TimeSpan timeOffset, ArraySegment<byte> byteSegment, bool markerBit);
 
         public abstract void ResetState();
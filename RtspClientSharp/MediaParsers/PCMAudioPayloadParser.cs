@@ -7,6 +7,7 @@ namespace RtspClientSharp.MediaParsers
     class PCMAudioPayloadParser : MediaPayloadParser
     {
         private readonly PCMCodecInfo _pcmCodecInfo;
+        private RawPCMFrame _reusableFrame;
 
         public PCMAudioPayloadParser(PCMCodecInfo pcmCodecInfo)
         {
@@ -17,9 +18,19 @@ namespace RtspClientSharp.MediaParsers
         {
             DateTime timestamp = GetFrameTimestamp(timeOffset);
 
+            if (ReuseFrames && _reusableFrame != null)
+            {
+                _reusableFrame.Reinitialize(timestamp, byteSegment);
+                OnFrameGenerated(_reusableFrame);
+                return;
+            }
+
             var frame = new RawPCMFrame(timestamp, byteSegment, _pcmCodecInfo.SampleRate, _pcmCodecInfo.BitsPerSample,
                 _pcmCodecInfo.Channels);
 
+            if (ReuseFrames)
+                _reusableFrame = frame;
+
             OnFrameGenerated(frame);
         }
 
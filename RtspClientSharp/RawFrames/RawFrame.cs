@@ -4,8 +4,8 @@ namespace RtspClientSharp.RawFrames
 {
     public abstract class RawFrame
     {
-        public DateTime Timestamp { get; }
-        public ArraySegment<byte> FrameSegment { get; }
+        public DateTime Timestamp { get; private set; }
+        public ArraySegment<byte> FrameSegment { get; private set; }
         public abstract FrameType Type { get; }
 
         protected RawFrame(DateTime timestamp, ArraySegment<byte> frameSegment)
@@ -13,5 +13,14 @@ namespace RtspClientSharp.RawFrames
             Timestamp = timestamp;
             FrameSegment = frameSegment;
         }
+
+        /// <summary>
+        /// Parsers reuse their frame instances this way when frame reusing is enabled
+        /// </summary>
+        internal void Reinitialize(DateTime timestamp, ArraySegment<byte> frameSegment)
+        {
+            Timestamp = timestamp;
+            FrameSegment = frameSegment;
+        }
     }
 }
\ No newline at end of file
@@ -4,12 +4,18 @@ namespace RtspClientSharp.RawFrames.Video
 {
     public class RawH264IFrame : RawH264Frame
     {
-        public ArraySegment<byte> SpsPpsSegment { get; }
+        public ArraySegment<byte> SpsPpsSegment { get; private set; }
 
         public RawH264IFrame(DateTime timestamp, ArraySegment<byte> frameSegment, ArraySegment<byte> spsPpsSegment)
             : base(timestamp, frameSegment)
         {
             SpsPpsSegment = spsPpsSegment;
         }
+
+        internal void Reinitialize(DateTime timestamp, ArraySegment<byte> frameSegment, ArraySegment<byte> spsPpsSegment)
+        {
+            Reinitialize(timestamp, frameSegment);
+            SpsPpsSegment = spsPpsSegment;
+        }
     }
 }
\ No newline at end of file
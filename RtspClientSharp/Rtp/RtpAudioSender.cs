@@ -0,0 +1,184 @@
+﻿using System;
+using System.Threading;
+using System.Threading.Tasks;
+using RtspClientSharp.Codecs.Audio;
+
+namespace RtspClientSharp.Rtp
+{
+    class RtpAudioSender
+    {
+        public const int MaxPacketSize = 1400;
+        private const int AacSamplesPerFrame = 1024;
+        private const int AuHeadersLengthSize = 2;
+        private const int DefaultAacSizeLength = 13;
+        private const int DefaultAacIndexLength = 3;
+
+        // Device buffers are reset when stream is silent that long, so the next frame starts a new talkspurt
+        private const int TalkspurtGapMs = 200;
+
+        private readonly Func<ArraySegment<byte>, CancellationToken, Task> _packetSender;
+        private readonly int _samplesFrequency;
+        private readonly int _bytesPerSample;
+        private readonly int _auHeaderSizeLength;
+        private readonly int _auHeaderIndexLength;
+        private readonly int _auHeaderSize;
+        private readonly int _maxAuSize;
+        private readonly bool _isAac;
+
+        private readonly byte[] _packetBuffer = new byte[MaxPacketSize];
+
+        private ushort _seqNumber;
+        private uint _timestamp;
+        private int _lastFrameTicks;
+        private int _lastFrameDurationMs;
+        private bool _isFirstFrame = true;
+
+        public RtpAudioSender(AudioCodecInfo codecInfo, int payloadType, int samplesFrequency, uint syncSourceId,
+            ushort initialSeqNumber, uint initialTimestamp, Func<ArraySegment<byte>, CancellationToken, Task> packetSender)
+        {
+            if (codecInfo == null)
+                throw new ArgumentNullException(nameof(codecInfo));
+            if (samplesFrequency <= 0)
+                throw new ArgumentOutOfRangeException(nameof(samplesFrequency));
+
+            _packetSender = packetSender ?? throw new ArgumentNullException(nameof(packetSender));
+            _samplesFrequency = samplesFrequency;
+            _seqNumber = initialSeqNumber;
+            _timestamp = initialTimestamp;
+
+            if (codecInfo is G711CodecInfo g711CodecInfo)
+                _bytesPerSample = g711CodecInfo.Channels;
+            else if (codecInfo is AACCodecInfo aacCodecInfo)
+            {
+                _isAac = true;
+                _auHeaderSizeLength = aacCodecInfo.SizeLength != 0 ? aacCodecInfo.SizeLength : DefaultAacSizeLength;
+                _auHeaderIndexLength = aacCodecInfo.SizeLength != 0 ? aacCodecInfo.IndexLength : DefaultAacIndexLength;
+                _auHeaderSize = (_auHeaderSizeLength + _auHeaderIndexLength + 7) / 8;
+                _maxAuSize = (1 << _auHeaderSizeLength) - 1;
+            }
+            else
+                throw new ArgumentException($"Codec is not supported for sending: {codecInfo.GetType().Name}",
+                    nameof(codecInfo));
+
+            _packetBuffer[0] = RtpPacket.RtpProtocolVersion << 6;
+            _packetBuffer[1] = (byte) (payloadType & 0x7F);
+            _packetBuffer[8] = (byte) (syncSourceId >> 24);
+            _packetBuffer[9] = (byte) (syncSourceId >> 16);
+            _packetBuffer[10] = (byte) (syncSourceId >> 8);
+            _packetBuffer[11] = (byte) syncSourceId;
+        }
+
+        /// <summary>
+        /// G.711 frame is split to packets when it doesn't fit into one, AAC frame should be a single access unit
+        /// </summary>
+        public async Task SendAsync(ArraySegment<byte> frameSegment, CancellationToken token)
+        {
+            if (frameSegment.Array == null)
+                throw new ArgumentNullException(nameof(frameSegment));
+
+            int headersSize = RtpPacket.RtpHeaderSize + AuHeadersLengthSize + _auHeaderSize;
+
+            if (_isAac)
+            {
+                if (headersSize + frameSegment.Count > MaxPacketSize)
+                    throw new ArgumentException("AAC frame is too large to be sent in one packet", nameof(frameSegment));
+
+                // Larger size would overflow into AU-index bits of the header
+                if (frameSegment.Count > _maxAuSize)
+                    throw new ArgumentException(
+                        $"AAC frame size exceeds the maximum of {_auHeaderSizeLength} bit AU-size: {_maxAuSize}",
+                        nameof(frameSegment));
+            }
+
+            bool markerBit = BeginFrame(frameSegment.Count);
+
+            if (_isAac)
+            {
+                // RFC 3640: marker is set on the last fragment of access unit, it's always the only one here
+                WriteRtpHeader(true);
+                WriteAuHeaderSection(frameSegment.Count);
+
+                Buffer.BlockCopy(frameSegment.Array, frameSegment.Offset, _packetBuffer, headersSize,
+                    frameSegment.Count);
+
+                await _packetSender(new ArraySegment<byte>(_packetBuffer, 0, headersSize + frameSegment.Count), token);
+                _timestamp += AacSamplesPerFrame;
+                return;
+            }
+
+            const int maxPayloadSize = MaxPacketSize - RtpPacket.RtpHeaderSize;
+            int alignedMaxPayloadSize = maxPayloadSize - maxPayloadSize % _bytesPerSample;
+
+            int offset = frameSegment.Offset;
+            int endOffset = frameSegment.Offset + frameSegment.Count;
+
+            while (offset < endOffset)
+            {
+                int payloadSize = Math.Min(endOffset - offset, alignedMaxPayloadSize);
+
+                WriteRtpHeader(markerBit);
+                markerBit = false;
+
+                Buffer.BlockCopy(frameSegment.Array, offset, _packetBuffer, RtpPacket.RtpHeaderSize, payloadSize);
+
+                await _packetSender(new ArraySegment<byte>(_packetBuffer, 0, RtpPacket.RtpHeaderSize + payloadSize),
+                    token);
+
+                _timestamp += (uint) (payloadSize / _bytesPerSample);
+                offset += payloadSize;
+            }
+        }
+
+        private bool BeginFrame(int frameSize)
+        {
+            int ticksNow = Environment.TickCount;
+            bool isTalkspurtStart = _isFirstFrame;
+
+            if (!_isFirstFrame)
+            {
+                int silenceMs = ticksNow - _lastFrameTicks - _lastFrameDurationMs;
+
+                if (silenceMs > TalkspurtGapMs)
+                {
+                    _timestamp += (uint) ((long) silenceMs * _samplesFrequency / 1000);
+                    isTalkspurtStart = true;
+                }
+            }
+
+            int samplesCount = _isAac ? AacSamplesPerFrame : frameSize / _bytesPerSample;
+
+            _isFirstFrame = false;
+            _lastFrameTicks = ticksNow;
+            _lastFrameDurationMs = (int) ((long) samplesCount * 1000 / _samplesFrequency);
+            return isTalkspurtStart;
+        }
+
+        private void WriteRtpHeader(bool markerBit)
+        {
+            _packetBuffer[1] = (byte) (markerBit ? _packetBuffer[1] | 0x80 : _packetBuffer[1] & 0x7F);
+            _packetBuffer[2] = (byte) (_seqNumber >> 8);
+            _packetBuffer[3] = (byte) _seqNumber;
+            _packetBuffer[4] = (byte) (_timestamp >> 24);
+            _packetBuffer[5] = (byte) (_timestamp >> 16);
+            _packetBuffer[6] = (byte) (_timestamp >> 8);
+            _packetBuffer[7] = (byte) _timestamp;
+
+            ++_seqNumber;
+        }
+
+        private void WriteAuHeaderSection(int frameSize)
+        {
+            int auHeaderBits = _auHeaderSizeLength + _auHeaderIndexLength;
+            int offset = RtpPacket.RtpHeaderSize;
+
+            _packetBuffer[offset++] = (byte) (auHeaderBits >> 8);
+            _packetBuffer[offset++] = (byte) auHeaderBits;
+
+            // AU-size is followed by zero AU-index, the rest of the last byte is padding
+            long auHeader = (long) frameSize << (_auHeaderIndexLength + _auHeaderSize * 8 - auHeaderBits);
+
+            for (int i = _auHeaderSize - 1; i >= 0; i--)
+                _packetBuffer[offset++] = (byte) (auHeader >> (i * 8));
+        }
+    }
+}
\ No newline at end of file
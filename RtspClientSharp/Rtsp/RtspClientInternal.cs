@@ -37,6 +37,10 @@ namespace RtspClientSharp.Rtsp
 
         private TpktStream _tpktStream;
 
+        private RtpAudioSender _backchannelSender;
+        private Socket _backchannelRtpClient;
+        private Socket _backchannelRtcpClient;
+
         private readonly SimpleHybridLock _hybridLock = new SimpleHybridLock();
         private readonly Random _random = RandomGeneratorFactory.CreateGenerator();
         private IRtspTransportClient _rtspTransportClient;
@@ -49,6 +53,8 @@ namespace RtspClientSharp.Rtsp
 
         public Action<RawFrame> FrameReceived;
 
+        public BackchannelAudioFormat BackchannelFormat { get; private set; }
+
         public RtspClientInternal(ConnectionParameters connectionParameters,
             Func<IRtspTransportClient> transportClientProvider = null)
         {
@@ -57,7 +63,10 @@ namespace RtspClientSharp.Rtsp
             _transportClientProvider = transportClientProvider ?? CreateTransportClient;
 
             Uri fixedRtspUri = connectionParameters.GetFixedRtspUri();
-            _requestMessageFactory = new RtspRequestMessageFactory(fixedRtspUri, connectionParameters.UserAgent);
+            _requestMessageFactory = new RtspRequestMessageFactory(fixedRtspUri, connectionParameters.UserAgent)
+            {
+                RequireBackchannel = connectionParameters.RequireBackchannel
+            };
         }
 
         public async Task ConnectAsync(CancellationToken token)
@@ -88,13 +97,25 @@ namespace RtspClientSharp.Rtsp
             bool anyTrackRequested = false;
             foreach (RtspMediaTrackInfo track in GetTracksToSetup(tracks))
             {
-                await SetupTrackAsync(track, token);
+                await SetupTrackAsync(track, false, token);
                 anyTrackRequested = true;
             }
 
             if (!anyTrackRequested)
                 throw new RtspClientException("Any suitable track is not found");
 
+            if (_connectionParameters.RequireBackchannel)
+            {
+                RtspMediaTrackInfo backchannelTrack = tracks.OfType<RtspMediaTrackInfo>()
+                    .FirstOrDefault(t => t.IsSendOnly && CreateBackchannelFormat(t) != null);
+
+                if (backchannelTrack != null)
+                {
+                    await SetupTrackAsync(backchannelTrack, true, token);
+                    BackchannelFormat = CreateBackchannelFormat(backchannelTrack);
+                }
+            }
+
             RtspRequestMessage playRequest = _requestMessageFactory.CreatePlayRequest();
             await _rtspTransportClient.EnsureExecuteRequest(playRequest, token, 1);
         }
@@ -143,6 +164,14 @@ namespace RtspClientSharp.Rtsp
             }
         }
 
+        public Task SendBackchannelAudioAsync(ArraySegment<byte> frameSegment, CancellationToken token)
+        {
+            if (_backchannelSender == null)
+                throw new InvalidOperationException("Backchannel is not established");
+
+            return _backchannelSender.SendAsync(frameSegment, token);
+        }
+
         public void Dispose()
         {
             if (Interlocked.CompareExchange(ref _disposed, 1, 0) != 0)
@@ -152,6 +181,9 @@ namespace RtspClientSharp.Rtsp
                 foreach (Socket client in _udpClientsMap.Values)
                     client.Close();
 
+            _backchannelRtpClient?.Close();
+            _backchannelRtcpClient?.Close();
+
             IRtspTransportClient rtspTransportClient = Volatile.Read(ref _rtspTransportClient);
 
             if (rtspTransportClient != null)
@@ -178,7 +210,7 @@ namespace RtspClientSharp.Rtsp
             return RtcpReportIntervalBaseMs + _random.Next(0, 11) * 100;
         }
 
-        private async Task SetupTrackAsync(RtspMediaTrackInfo track, CancellationToken token)
+        private async Task SetupTrackAsync(RtspMediaTrackInfo track, bool isBackchannel, CancellationToken token)
         {
             RtspRequestMessage setupRequest;
             RtspResponseMessage setupResponse;
@@ -274,13 +306,28 @@ namespace RtspClientSharp.Rtsp
                 await rtpClient.SendAsync(udpHolePunchingPacketSegment, SocketFlags.None);
                 await rtcpClient.SendAsync(udpHolePunchingPacketSegment, SocketFlags.None);
 
-                _udpClientsMap[rtpChannelNumber] = rtpClient;
-                _udpClientsMap[rtcpChannelNumber] = rtcpClient;
+                if (isBackchannel)
+                {
+                    _backchannelRtpClient = rtpClient;
+                    _backchannelRtcpClient = rtcpClient;
+                }
+                else
+                {
+                    _udpClientsMap[rtpChannelNumber] = rtpClient;
+                    _udpClientsMap[rtcpChannelNumber] = rtcpClient;
+                }
             }
 
             ParseSessionHeader(setupResponse.Headers[WellKnownHeaders.Session]);
 
+            if (isBackchannel)
+            {
+                _backchannelSender = CreateBackchannelSender(track, rtpChannelNumber, rtpClient);
+                return;
+            }
+
             IMediaPayloadParser mediaPayloadParser = MediaPayloadParser.CreateFrom(track.Codec);
+            mediaPayloadParser.ReuseFrames = _connectionParameters.ReuseRawFrames;
 
             IRtpSequenceAssembler rtpSequenceAssembler;
 
@@ -308,6 +355,70 @@ namespace RtspClientSharp.Rtsp
             _reportProvidersMap.Add(rtpChannelNumber, rtcpReportsProvider);
         }
 
+        private RtpAudioSender CreateBackchannelSender(RtspMediaTrackInfo track, int rtpChannelNumber, Socket rtpClient)
+        {
+            Func<ArraySegment<byte>, CancellationToken, Task> packetSender;
+
+            if (_connectionParameters.RtpTransport == RtpTransportProtocol.TCP)
+                packetSender = (packetSegment, token) =>
+                {
+                    TpktStream tpktStream = Volatile.Read(ref _tpktStream);
+
+                    if (tpktStream == null)
+                        throw new InvalidOperationException("Receiving should be started before sending to backchannel");
+
+                    return tpktStream.WriteAsync(rtpChannelNumber, packetSegment, token);
+                };
+            else
+                packetSender = (packetSegment, token) => rtpClient.SendAsync(packetSegment, SocketFlags.None);
+
+            return new RtpAudioSender((AudioCodecInfo) track.Codec, track.PayloadType, track.SamplesFrequency,
+                (uint) _random.Next(), (ushort) _random.Next(), (uint) _random.Next(), packetSender);
+        }
+
+        private static BackchannelAudioFormat CreateBackchannelFormat(RtspMediaTrackInfo track)
+        {
+            var emptySegment = new ArraySegment<byte>(Array.Empty<byte>());
+
+            switch (track.Codec)
+            {
+                case G711ACodecInfo g711ACodecInfo:
+                    return new BackchannelAudioFormat(BackchannelAudioCodec.G711A, g711ACodecInfo.SampleRate,
+                        g711ACodecInfo.Channels, emptySegment);
+                case G711UCodecInfo g711UCodecInfo:
+                    return new BackchannelAudioFormat(BackchannelAudioCodec.G711U, g711UCodecInfo.SampleRate,
+                        g711UCodecInfo.Channels, emptySegment);
+                case AACCodecInfo aacCodecInfo:
+                    if (aacCodecInfo.ConfigBytes == null)
+                        return new BackchannelAudioFormat(BackchannelAudioCodec.AAC, track.SamplesFrequency, 1,
+                            emptySegment);
+
+                    var configSegment = new ArraySegment<byte>(aacCodecInfo.ConfigBytes);
+                    return new BackchannelAudioFormat(BackchannelAudioCodec.AAC, track.SamplesFrequency,
+                        GetAacChannelsCount(configSegment), configSegment);
+            }
+
+            return null;
+        }
+
+        private static int GetAacChannelsCount(ArraySegment<byte> configSegment)
+        {
+            const int escapeObjectType = 31;
+            const int escapeFrequencyIndex = 15;
+
+            var bitStreamReader = new BitStreamReader();
+            bitStreamReader.ReInitialize(configSegment);
+
+            if (bitStreamReader.ReadBits(5) == escapeObjectType)
+                bitStreamReader.ReadBits(6);
+
+            if (bitStreamReader.ReadBits(4) == escapeFrequencyIndex)
+                bitStreamReader.ReadBits(24);
+
+            int channelConfiguration = bitStreamReader.ReadBits(4);
+            return channelConfiguration > 0 ? channelConfiguration : 1;
+        }
+
         private async Task SendRtspKeepAliveAsync(CancellationToken token)
         {
             RtspRequestMessage getParameterRequest = _requestMessageFactory.CreateGetParameterRequest();
@@ -332,6 +443,9 @@ namespace RtspClientSharp.Rtsp
         {
             foreach (RtspMediaTrackInfo track in tracks.OfType<RtspMediaTrackInfo>())
             {
+                if (track.IsSendOnly && _connectionParameters.RequireBackchannel)
+                    continue;
+
                 if (track.Codec is VideoCodecInfo && (_connectionParameters.RequiredTracks & RequiredTracks.Video) != 0)
                     yield return track;
                 else if (track.Codec is AudioCodecInfo &&
@@ -487,18 +601,16 @@ namespace RtspClientSharp.Rtsp
 
         private async Task ReceiveOverTcpAsync(Stream rtspStream, CancellationToken token)
         {
-            _tpktStream = new TpktStream(rtspStream);
+            Volatile.Write(ref _tpktStream, new TpktStream(rtspStream));
 
             int nextRtcpReportInterval = GetNextRtcpReportIntervalMs();
             int lastTimeRtcpReportsSent = Environment.TickCount;
             var bufferStream = new MemoryStream();
+            Action<TpktPayload> payloadHandler = ProcessTpktPayload;
 
             while (!token.IsCancellationRequested)
             {
-                TpktPayload payload = await _tpktStream.ReadAsync();
-
-                if (_streamsMap.TryGetValue(payload.Channel, out ITransportStream stream))
-                    stream.Process(payload.PayloadSegment);
+                await _tpktStream.ReadAsync(payloadHandler);
 
                 int ticksNow = Environment.TickCount;
 
@@ -519,6 +631,12 @@ namespace RtspClientSharp.Rtsp
             }
         }
 
+        private void ProcessTpktPayload(TpktPayload payload)
+        {
+            if (_streamsMap.TryGetValue(payload.Channel, out ITransportStream stream))
+                stream.Process(payload.PayloadSegment);
+        }
+
         private Task ReceiveOverUdpAsync(CancellationToken token)
         {
             var waitList = new List<Task>(_udpClientsMap.Count / 2);
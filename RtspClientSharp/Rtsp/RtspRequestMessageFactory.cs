@@ -5,6 +5,7 @@ namespace RtspClientSharp.Rtsp
     class RtspRequestMessageFactory
     {
         private static readonly Version ProtocolVersion = new Version(1, 0);
+        private const string BackchannelFeatureTag = "www.onvif.org/ver20/backchannel";
 
         private uint _cSeq;
         private readonly Uri _rtspUri;
@@ -12,6 +13,7 @@ namespace RtspClientSharp.Rtsp
 
         public Uri ContentBase { get; set; }
         public string SessionId { get; set; }
+        public bool RequireBackchannel { get; set; }
 
         public RtspRequestMessageFactory(Uri rtspUri, string userAgent)
         {
@@ -31,6 +33,7 @@ namespace RtspClientSharp.Rtsp
             var rtspRequestMessage = new RtspRequestMessage(RtspMethod.DESCRIBE, _rtspUri, ProtocolVersion, 
                 NextCSeqProvider, _userAgent, SessionId);
             rtspRequestMessage.Headers.Add("Accept", "application/sdp");
+            AddRequireHeader(rtspRequestMessage);
             return rtspRequestMessage;
         }
 
@@ -41,6 +44,7 @@ namespace RtspClientSharp.Rtsp
             var rtspRequestMessage = new RtspRequestMessage(RtspMethod.SETUP, trackUri, ProtocolVersion, 
                 NextCSeqProvider, _userAgent, SessionId);
             rtspRequestMessage.Headers.Add("Transport", $"RTP/AVP/TCP;unicast;interleaved={rtpChannel}-{rtcpChannel}");
+            AddRequireHeader(rtspRequestMessage);
             return rtspRequestMessage;
         }
 
@@ -51,6 +55,7 @@ namespace RtspClientSharp.Rtsp
             var rtspRequestMessage = new RtspRequestMessage(RtspMethod.SETUP, trackUri, ProtocolVersion, 
                 NextCSeqProvider, _userAgent, SessionId);
             rtspRequestMessage.Headers.Add("Transport", $"RTP/AVP/UDP;unicast;client_port={rtpPort}-{rtcpPort}");
+            AddRequireHeader(rtspRequestMessage);
             return rtspRequestMessage;
         }
 
@@ -61,6 +66,7 @@ namespace RtspClientSharp.Rtsp
             var rtspRequestMessage =
                 new RtspRequestMessage(RtspMethod.PLAY, uri, ProtocolVersion, NextCSeqProvider, _userAgent, SessionId);
             rtspRequestMessage.Headers.Add("Range", "npt=0.000-");
+            AddRequireHeader(rtspRequestMessage);
             return rtspRequestMessage;
         }
 
@@ -86,6 +92,12 @@ namespace RtspClientSharp.Rtsp
             return _rtspUri;
         }
 
+        private void AddRequireHeader(RtspRequestMessage rtspRequestMessage)
+        {
+            if (RequireBackchannel)
+                rtspRequestMessage.Headers.Add("Require", BackchannelFeatureTag);
+        }
+
         private uint NextCSeqProvider()
         {
             return ++_cSeq;
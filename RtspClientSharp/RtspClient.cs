@@ -18,6 +18,8 @@ namespace RtspClientSharp
 
         public ConnectionParameters ConnectionParameters { get; }
 
+        public BackchannelAudioFormat BackchannelFormat => Volatile.Read(ref _rtspClientInternal)?.BackchannelFormat;
+
         public event EventHandler<RawFrame> FrameReceived;
 
         public RtspClient(ConnectionParameters connectionParameters)
@@ -193,6 +195,23 @@ namespace RtspClientSharp
             }
         }
 
+        /// <summary>
+        /// Send encoded audio frame to endpoint over backchannel.
+        /// G.711 frame could be of any size (20 ms is usual), AAC frame should be one raw access unit without ADTS header.
+        /// Should be called while frames are received, calls should not overlap
+        /// </summary>
+        /// <exception cref="OperationCanceledException"></exception>
+        /// <exception cref="InvalidOperationException"></exception>
+        public Task SendBackchannelAudioAsync(ArraySegment<byte> frameSegment, CancellationToken token)
+        {
+            RtspClientInternal rtspClientInternal = Volatile.Read(ref _rtspClientInternal);
+
+            if (rtspClientInternal == null)
+                throw new InvalidOperationException("Client should be connected first");
+
+            return rtspClientInternal.SendBackchannelAudioAsync(frameSegment, token);
+        }
+
         /// <summary>
         /// Clean up unmanaged resources
         /// </summary>
@@ -6,12 +6,20 @@ namespace RtspClientSharp.Sdp
     {
         public CodecInfo Codec { get; }
         public int SamplesFrequency { get; }
+        public int PayloadType { get; }
 
-        public RtspMediaTrackInfo(string trackName, CodecInfo codec, int samplesFrequency)
+        /// <summary>
+        /// Media is marked with "a=sendonly", that's how ONVIF devices describe backchannel (client to device) track
+        /// </summary>
+        public bool IsSendOnly { get; }
+
+        public RtspMediaTrackInfo(string trackName, CodecInfo codec, int samplesFrequency, int payloadType, bool isSendOnly)
             : base(trackName)
         {
             Codec = codec;
             SamplesFrequency = samplesFrequency;
+            PayloadType = payloadType;
+            IsSendOnly = isSendOnly;
         }
     }
 }
\ No newline at end of file
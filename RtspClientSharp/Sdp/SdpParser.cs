@@ -16,11 +16,14 @@ namespace RtspClientSharp.Sdp
         private class PayloadFormatInfo
         {
             public string TrackName { get; set; }
+            public int PayloadType { get; }
             public CodecInfo CodecInfo { get; set; }
             public int SamplesFrequency { get; set; }
+            public bool IsSendOnly { get; set; }
 
-            public PayloadFormatInfo(CodecInfo codecInfo, int samplesFrequency)
+            public PayloadFormatInfo(int payloadType, CodecInfo codecInfo, int samplesFrequency)
             {
+                PayloadType = payloadType;
                 CodecInfo = codecInfo;
                 SamplesFrequency = samplesFrequency;
             }
@@ -29,6 +32,9 @@ namespace RtspClientSharp.Sdp
         private readonly Dictionary<int, PayloadFormatInfo> _payloadFormatNumberToInfoMap =
             new Dictionary<int, PayloadFormatInfo>();
 
+        // ONVIF backchannel media could reuse payload type of receive media, so every media line is kept
+        private readonly List<PayloadFormatInfo> _mediaFormatInfos = new List<PayloadFormatInfo>();
+
         private PayloadFormatInfo _lastParsedFormatInfo;
 
         public IEnumerable<RtspTrackInfo> Parse(ArraySegment<byte> payloadSegment)
@@ -39,6 +45,7 @@ namespace RtspClientSharp.Sdp
                 throw new ArgumentException("Empty SDP document", nameof(payloadSegment));
 
             _payloadFormatNumberToInfoMap.Clear();
+            _mediaFormatInfos.Clear();
             _lastParsedFormatInfo = null;
 
             var sdpStream = new MemoryStream(payloadSegment.Array, payloadSegment.Offset, payloadSegment.Count);
@@ -53,9 +60,10 @@ namespace RtspClientSharp.Sdp
                     ParseAttributesLine(line);
             }
 
-            return _payloadFormatNumberToInfoMap.Values
+            return _mediaFormatInfos
                 .Where(fi => fi.TrackName != null && fi.CodecInfo != null)
-                .Select(fi => new RtspMediaTrackInfo(fi.TrackName, fi.CodecInfo, fi.SamplesFrequency));
+                .Select(fi => new RtspMediaTrackInfo(fi.TrackName, fi.CodecInfo, fi.SamplesFrequency, fi.PayloadType,
+                    fi.IsSendOnly));
         }
 
         private void ParseMediaLine(string line)
@@ -79,8 +87,9 @@ namespace RtspClientSharp.Sdp
             CodecInfo codecInfo = TryCreateCodecInfo(payloadFormatNumber);
             int samplesFrequency = GetSamplesFrequencyFromPayloadType(payloadFormatNumber);
 
-            _lastParsedFormatInfo = new PayloadFormatInfo(codecInfo, samplesFrequency);
+            _lastParsedFormatInfo = new PayloadFormatInfo(payloadFormatNumber, codecInfo, samplesFrequency);
             _payloadFormatNumberToInfoMap[payloadFormatNumber] = _lastParsedFormatInfo;
+            _mediaFormatInfos.Add(_lastParsedFormatInfo);
         }
 
         private void ParseAttributesLine(string line)
@@ -92,10 +101,13 @@ namespace RtspClientSharp.Sdp
 
             int colonIndex = line.IndexOf(':', equalsSignIndex);
 
+            ++equalsSignIndex;
+
             if (colonIndex == -1)
+            {
+                ParsePropertyAttribute(line.Substring(equalsSignIndex).Trim());
                 return;
-
-            ++equalsSignIndex;
+            }
 
             int attributeLength = colonIndex - equalsSignIndex;
 
@@ -125,6 +137,13 @@ namespace RtspClientSharp.Sdp
             }
         }
 
+        private void ParsePropertyAttribute(string attributeName)
+        {
+            if (_lastParsedFormatInfo != null &&
+                attributeName.Equals("sendonly", StringComparison.InvariantCultureIgnoreCase))
+                _lastParsedFormatInfo.IsSendOnly = true;
+        }
+
         private void ParseRtpMapAttribute(string attributeValue)
         {
             int spaceIndex = attributeValue.IndexOf(' ');
@@ -1,7 +1,7 @@
 ﻿using System;
 using System.Diagnostics;
 using System.IO;
-using System.Runtime.CompilerServices;
+using System.Threading;
 using System.Threading.Tasks;
 using RtspClientSharp.Utils;
 
@@ -11,11 +11,14 @@ namespace RtspClientSharp.Tpkt
     {
         private static readonly byte[] TpktHeaderIdArray = {TpktHeader.Id};
 
-        private byte[] _readBuffer = new byte[8 * 1024];
+        private const int ReadBufferSize = 64 * 1024;
+
+        private byte[] _readBuffer = new byte[ReadBufferSize];
         private byte[] _writeBuffer = new byte[0];
+        private readonly SemaphoreSlim _writeLock = new SemaphoreSlim(1, 1);
 
-        private int _nonParsedDataSize;
         private int _nonParsedDataOffset;
+        private int _nonParsedDataEnd;
 
         private readonly Stream _stream;
 
@@ -26,102 +29,149 @@ namespace RtspClientSharp.Tpkt
 
         public async Task<TpktPayload> ReadAsync()
         {
-            int nextTpktPositon = await FindNextPacketAsync();
+            TpktPayload payload;
 
-            int usefulDataSize = _nonParsedDataSize - nextTpktPositon;
+            while (!TryParsePacket(out payload))
+                await FillReadBufferAsync();
 
-            if (nextTpktPositon != 0)
-                Buffer.BlockCopy(_readBuffer, nextTpktPositon, _readBuffer, 0, usefulDataSize);
+            return payload;
+        }
 
-            int readCount = TpktHeader.Size - usefulDataSize;
+        /// <summary>
+        /// Reads stream until at least one packet is complete and passes every complete packet of read data to handler.
+        /// Payload segments are valid until the next read call
+        /// </summary>
+        public async Task ReadAsync(Action<TpktPayload> payloadHandler)
+        {
+            TpktPayload payload;
 
-            if (readCount > 0)
+            while (!TryParsePacket(out payload))
+                await FillReadBufferAsync();
+
+            do
             {
-                await _stream.ReadExactAsync(_readBuffer, usefulDataSize, readCount);
-                usefulDataSize = 0;
-            }
-            else
-                usefulDataSize = -readCount;
+                payloadHandler(payload);
+            } while (TryParsePacket(out payload));
+        }
 
-            int channel = _readBuffer[1];
-            int payloadSize = BigEndianConverter.ReadUInt16(_readBuffer, 2);
-            int totalSize = TpktHeader.Size + payloadSize;
+        public Task WriteAsync(int channel, ArraySegment<byte> payloadSegment)
+        {
+            return WriteAsync(channel, payloadSegment, CancellationToken.None);
+        }
 
-            if (_readBuffer.Length < totalSize)
-            {
-                int alignedTotalSize = SystemMemory.RoundToPageAlignmentSize(totalSize);
-                Array.Resize(ref _readBuffer, alignedTotalSize);
-            }
+        /// <summary>
+        /// Could be called concurrently, e.g. backchannel packets are sent while receiver writes RTCP reports.
+        /// Token cancels waiting for other writers only, a started packet is always written completely
+        /// </summary>
+        public async Task WriteAsync(int channel, ArraySegment<byte> payloadSegment, CancellationToken token)
+        {
+            Debug.Assert(payloadSegment.Array != null, "payloadSegment.Array != null");
 
-            readCount = payloadSize - usefulDataSize;
+            int packetSize = TpktHeader.Size + payloadSegment.Count;
 
-            if (readCount > 0)
+            await _writeLock.WaitAsync(token);
+
+            try
             {
-                await _stream.ReadExactAsync(_readBuffer, TpktHeader.Size + usefulDataSize, readCount);
-                _nonParsedDataSize = 0;
+                if (_writeBuffer.Length < packetSize)
+                {
+                    _writeBuffer = new byte[packetSize];
+                    _writeBuffer[0] = TpktHeader.Id;
+                }
+
+                _writeBuffer[1] = (byte) channel;
+                _writeBuffer[2] = (byte) (payloadSegment.Count >> 8);
+                _writeBuffer[3] = (byte) payloadSegment.Count;
+
+                Buffer.BlockCopy(payloadSegment.Array, payloadSegment.Offset, _writeBuffer, TpktHeader.Size,
+                    payloadSegment.Count);
+
+                await _stream.WriteAsync(_writeBuffer, 0, packetSize, CancellationToken.None);
             }
-            else
+            finally
             {
-                _nonParsedDataSize = -readCount;
-                _nonParsedDataOffset = totalSize;
+                _writeLock.Release();
             }
-
-            var payloadSegment = new ArraySegment<byte>(_readBuffer, TpktHeader.Size, payloadSize);
-            return new TpktPayload(channel, payloadSegment);
         }
 
-        public async Task WriteAsync(int channel, ArraySegment<byte> payloadSegment)
+        private bool TryParsePacket(out TpktPayload payload)
         {
-            Debug.Assert(payloadSegment.Array != null, "payloadSegment.Array != null");
+            payload = default(TpktPayload);
 
-            int packetSize = TpktHeader.Size + payloadSegment.Count;
+            int dataSize = _nonParsedDataEnd - _nonParsedDataOffset;
+
+            if (dataSize == 0)
+                return false;
 
-            if (_writeBuffer.Length < packetSize)
+            if (_readBuffer[_nonParsedDataOffset] != TpktHeader.Id)
             {
-                _writeBuffer = new byte[packetSize];
-                _writeBuffer[0] = TpktHeader.Id;
+                int packetPosition = ArrayUtils.IndexOfBytes(_readBuffer, TpktHeaderIdArray, _nonParsedDataOffset + 1,
+                    dataSize - 1);
+
+                if (packetPosition == -1)
+                {
+                    _nonParsedDataOffset = _nonParsedDataEnd;
+                    return false;
+                }
+
+                _nonParsedDataOffset = packetPosition;
+                dataSize = _nonParsedDataEnd - packetPosition;
             }
 
-            _writeBuffer[1] = (byte) channel;
-            _writeBuffer[2] = (byte) (payloadSegment.Count >> 8);
-            _writeBuffer[3] = (byte) payloadSegment.Count;
+            if (dataSize < TpktHeader.Size)
+                return false;
+
+            int payloadSize = BigEndianConverter.ReadUInt16(_readBuffer, _nonParsedDataOffset + 2);
+            int totalSize = TpktHeader.Size + payloadSize;
 
-            Buffer.BlockCopy(payloadSegment.Array, payloadSegment.Offset, _writeBuffer, TpktHeader.Size,
-                payloadSegment.Count);
+            if (dataSize < totalSize)
+                return false;
 
-            await _stream.WriteAsync(_writeBuffer, 0, packetSize);
+            int channel = _readBuffer[_nonParsedDataOffset + 1];
+            var payloadSegment = new ArraySegment<byte>(_readBuffer, _nonParsedDataOffset + TpktHeader.Size, payloadSize);
+            payload = new TpktPayload(channel, payloadSegment);
+
+            _nonParsedDataOffset += totalSize;
+            return true;
         }
 
-        private async Task<int> FindNextPacketAsync()
+        /// <summary>
+        /// Data is appended after the parsed packets, the incomplete packet is moved to the buffer start only when
+        /// it can't fit into the rest of buffer, i.e. once per buffer length instead of once per packet
+        /// </summary>
+        private async Task FillReadBufferAsync()
         {
-            if (_nonParsedDataSize != 0)
-                Buffer.BlockCopy(_readBuffer, _nonParsedDataOffset, _readBuffer, 0, _nonParsedDataSize);
+            int dataSize = _nonParsedDataEnd - _nonParsedDataOffset;
 
-            int packetPosition;
-            while ((packetPosition = FindTpktSignature(_nonParsedDataSize)) == -1)
+            if (dataSize == 0)
+                _nonParsedDataOffset = _nonParsedDataEnd = 0;
+            else
             {
-                _nonParsedDataSize = await _stream.ReadAsync(_readBuffer, 0, _readBuffer.Length);
+                int packetSize = dataSize < TpktHeader.Size
+                    ? TpktHeader.Size
+                    : TpktHeader.Size + BigEndianConverter.ReadUInt16(_readBuffer, _nonParsedDataOffset + 2);
 
-                if (_nonParsedDataSize == 0)
-                    throw new EndOfStreamException("End of TPKT stream");
-            }
+                if (_nonParsedDataOffset + packetSize > _readBuffer.Length)
+                {
+                    byte[] buffer = _readBuffer;
 
-            return packetPosition;
-        }
+                    if (_readBuffer.Length < packetSize)
+                        buffer = new byte[SystemMemory.RoundToPageAlignmentSize(packetSize)];
 
-        [MethodImpl(MethodImplOptions.AggressiveInlining)]
-        private int FindTpktSignature(int dataSize)
-        {
-            if (dataSize == 0)
-                return -1;
+                    Buffer.BlockCopy(_readBuffer, _nonParsedDataOffset, buffer, 0, dataSize);
+
+                    _readBuffer = buffer;
+                    _nonParsedDataOffset = 0;
+                    _nonParsedDataEnd = dataSize;
+                }
+            }
 
-            if (_readBuffer[0] == TpktHeader.Id)
-                return 0;
+            int read = await _stream.ReadAsync(_readBuffer, _nonParsedDataEnd, _readBuffer.Length - _nonParsedDataEnd);
 
-            if (dataSize == 1)
-                return -1;
+            if (read == 0)
+                throw new EndOfStreamException("End of TPKT stream");
 
-            return ArrayUtils.IndexOfBytes(_readBuffer, TpktHeaderIdArray, 1, --dataSize);
+            _nonParsedDataEnd += read;
         }
     }
 }
\ No newline at end of file